@@ -0,0 +1,881 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../concurrent_map.h"
+#include "../corpus_loader.h"
+#include "../near_duplicates.h"
+#include "../numa_search_server.h"
+#include "../persistent_search_server.h"
+#include "../process_queries.h"
+#include "../remove_duplicates.h"
+#include "../request_queue.h"
+#include "../search_server.h"
+#include "../stop_word_set.h"
+#include "../string_processing.h"
+#include "../tokenizer.h"
+#include "benchmark_report.h"
+#include "corpus_generator.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct BenchmarkOptions {
+    std::vector<size_t> corpus_sizes = { 10000 };
+    size_t query_count = 1000;
+    size_t remove_count = 1000;
+    size_t batch_size = 64;
+    uint64_t seed = 42;
+    bool use_arena = false;
+    std::string label = "local"s;
+    std::string output_path;
+};
+
+std::vector<size_t> ParseSizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    std::istringstream input(text);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        sizes.push_back(std::stoull(item));
+    }
+    return sizes;
+}
+
+void PrintUsage() {
+    std::cerr << "Usage: search_server_benchmark [--sizes 10000,100000,...] [--queries N] [--removes N]"
+        " [--batch N] [--seed N] [--arena 0|1] [--label TEXT] [--output FILE]"s << std::endl;
+    std::cerr << "Each line of output is a JSON object. Peak RSS is cumulative for the process,"
+        " so run one corpus size per process for exact memory figures."s << std::endl;
+}
+
+BenchmarkOptions ParseOptions(int argc, char** argv) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--help"s) {
+            PrintUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for "s + argument);
+        }
+        const std::string value = argv[++i];
+        if (argument == "--sizes"s) {
+            options.corpus_sizes = ParseSizes(value);
+        }
+        else if (argument == "--queries"s) {
+            options.query_count = std::stoull(value);
+        }
+        else if (argument == "--removes"s) {
+            options.remove_count = std::stoull(value);
+        }
+        else if (argument == "--batch"s) {
+            options.batch_size = std::stoull(value);
+        }
+        else if (argument == "--seed"s) {
+            options.seed = std::stoull(value);
+        }
+        else if (argument == "--arena"s) {
+            options.use_arena = value != "0"s;
+        }
+        else if (argument == "--label"s) {
+            options.label = value;
+        }
+        else if (argument == "--output"s) {
+            options.output_path = value;
+        }
+        else {
+            throw std::invalid_argument("Unknown option "s + argument);
+        }
+    }
+    return options;
+}
+
+// Обращения к памяти за серию операций: индекс сервера размещается через index_memory,
+// временная память запросов берётся из пулов текущего потока
+class AllocationProbe {
+public:
+    explicit AllocationProbe(const CountingMemoryResource& index_memory)
+        : index_memory_(index_memory)
+        , index_start_(index_memory.GetCounters())
+        , scratch_start_(QueryScratchScope::GetThreadCounters()) {
+    }
+
+    std::vector<std::pair<std::string, double>> GetPerOperation(size_t operation_count,
+        std::vector<std::pair<std::string, double>> extra = {}) const {
+        const AllocationCounters index = index_memory_.GetCounters();
+        const AllocationCounters scratch = QueryScratchScope::GetThreadCounters();
+        const double count = static_cast<double>(std::max<size_t>(operation_count, 1));
+        extra.emplace_back("index_allocations_per_op"s,
+            static_cast<double>(index.allocations - index_start_.allocations) / count);
+        extra.emplace_back("index_deallocations_per_op"s,
+            static_cast<double>(index.deallocations - index_start_.deallocations) / count);
+        extra.emplace_back("scratch_allocations_per_op"s,
+            static_cast<double>(scratch.allocations - scratch_start_.allocations) / count);
+        extra.emplace_back("index_bytes_in_use"s, static_cast<double>(index.bytes_in_use));
+        return extra;
+    }
+
+private:
+    const CountingMemoryResource& index_memory_;
+    AllocationCounters index_start_;
+    AllocationCounters scratch_start_;
+};
+
+void BenchmarkAddDocument(SearchServer& server, CorpusGenerator& generator, size_t corpus_size,
+    const CountingMemoryResource& index_memory, BenchmarkReporter& reporter) {
+    AllocationProbe allocations(index_memory);
+    LatencyRecorder latencies;
+    for (size_t id = 0; id < corpus_size; ++id) {
+        const std::string document = generator.GenerateDocument();
+        const DocumentStatus status = generator.GenerateStatus();
+        const std::vector<int> ratings = generator.GenerateRatings();
+        latencies.Measure([&]() { server.AddDocument(static_cast<int>(id), document, status, ratings); });
+    }
+    const MemoryUsage memory = server.GetMemoryUsage();
+    reporter.Report(corpus_size, "AddDocument"s, latencies, allocations.GetPerOperation(corpus_size, {
+        { "memory_dictionary"s, static_cast<double>(memory.dictionary) },
+        { "memory_inverted_index"s, static_cast<double>(memory.inverted_index) },
+        { "memory_forward_index"s, static_cast<double>(memory.forward_index) },
+        { "memory_document_metadata"s, static_cast<double>(memory.document_metadata) },
+        { "memory_total"s, static_cast<double>(memory.GetTotal()) } }));
+}
+
+template <typename ExecutionPolicy>
+void BenchmarkFindTopDocuments(const SearchServer& server, const std::vector<std::string>& queries,
+    ExecutionPolicy&& policy, const std::string& name, size_t corpus_size,
+    const CountingMemoryResource& index_memory, BenchmarkReporter& reporter) {
+    AllocationProbe allocations(index_memory);
+    LatencyRecorder latencies;
+    size_t found = 0;
+    for (const std::string& query : queries) {
+        found += latencies.Measure([&]() { return server.FindTopDocuments(policy, query); }).size();
+    }
+    reporter.Report(corpus_size, name, latencies, allocations.GetPerOperation(queries.size(),
+        { { "avg_results"s, static_cast<double>(found) / static_cast<double>(queries.size()) } }));
+}
+
+// Политики ранжирования на одних запросах: разница задержек - цена вычисления вклада на запись индекса
+template <typename Scorer>
+void BenchmarkScoring(const SearchServer& server, const std::vector<std::string>& queries, const Scorer& scorer,
+    const std::string& name, size_t corpus_size, BenchmarkReporter& reporter) {
+    LatencyRecorder latencies;
+    const auto actual = [](int, DocumentStatus status, int) { return status == DocumentStatus::ACTUAL; };
+    for (const std::string& query : queries) {
+        latencies.Measure([&]() { return server.FindTopDocuments(std::execution::seq, query, actual, scorer); });
+    }
+    reporter.Report(corpus_size, name, latencies);
+}
+
+template <typename ExecutionPolicy>
+void BenchmarkMatchDocument(const SearchServer& server, const std::vector<std::string>& queries,
+    const std::vector<int>& document_ids, ExecutionPolicy&& policy, const std::string& name,
+    size_t corpus_size, BenchmarkReporter& reporter) {
+    LatencyRecorder latencies;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const int document_id = document_ids[i % document_ids.size()];
+        latencies.Measure([&]() { return server.MatchDocument(policy, queries[i], document_id); });
+    }
+    reporter.Report(corpus_size, name, latencies);
+}
+
+void BenchmarkMatchDocumentsBatch(const SearchServer& server, const std::vector<std::string>& queries,
+    const std::vector<int>& document_ids, size_t batch_size, size_t corpus_size, BenchmarkReporter& reporter) {
+    LatencyRecorder latencies;
+    std::vector<int> batch(batch_size);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        for (size_t j = 0; j < batch_size; ++j) {
+            batch[j] = document_ids[(i + j) % document_ids.size()];
+        }
+        latencies.Measure([&]() { return server.MatchDocuments(queries[i], batch); });
+    }
+    reporter.Report(corpus_size, "MatchDocuments/batch"s, latencies,
+        { { "documents_per_batch"s, static_cast<double>(batch_size) } });
+}
+
+void BenchmarkProcessQueries(const SearchServer& server, const std::vector<std::string>& queries,
+    size_t batch_size, size_t corpus_size, BenchmarkReporter& reporter) {
+    LatencyRecorder latencies;
+    for (size_t begin = 0; begin < queries.size(); begin += batch_size) {
+        const size_t end = std::min(begin + batch_size, queries.size());
+        const std::vector<std::string> batch(queries.begin() + begin, queries.begin() + end);
+        latencies.Measure([&]() { return ProcessQueries(server, batch); });
+    }
+    reporter.Report(corpus_size, "ProcessQueries"s, latencies,
+        { { "queries_per_batch"s, static_cast<double>(batch_size) } });
+}
+
+// Пачки запросов потоками, закреплёнными за узлами NUMA: общий индекс против копии на каждом узле.
+// На машине с одним узлом оба варианта читают исходный индекс и отличаются от ProcessQueries только закреплением
+void BenchmarkNumaSearch(const SearchServer& server, const std::vector<std::string>& queries, size_t batch_size,
+    size_t corpus_size, BenchmarkReporter& reporter) {
+    for (const bool replicate : { false, true }) {
+        NumaSearchOptions options;
+        options.replicate = replicate;
+        LatencyRecorder build_latencies;
+        const auto numa = build_latencies.Measure([&]() { return std::make_unique<NumaSearchServer>(server, options); });
+        LatencyRecorder latencies;
+        for (size_t begin = 0; begin < queries.size(); begin += batch_size) {
+            const size_t end = std::min(begin + batch_size, queries.size());
+            const std::vector<std::string> batch(queries.begin() + begin, queries.begin() + end);
+            latencies.Measure([&]() { return numa->ProcessQueries(batch); });
+        }
+        reporter.Report(corpus_size, replicate ? "NumaSearchServer/replicated"s : "NumaSearchServer/shared"s, latencies,
+            { { "queries_per_batch"s, static_cast<double>(batch_size) },
+              { "nodes"s, static_cast<double>(numa->GetNodeCount()) },
+              { "replicas"s, static_cast<double>(numa->GetReplicaCount()) },
+              { "build_seconds"s, static_cast<double>(build_latencies.GetTotalNanoseconds()) / 1e9 } });
+    }
+}
+
+void BenchmarkRequestQueue(const SearchServer& server, const std::vector<std::string>& queries,
+    size_t corpus_size, BenchmarkReporter& reporter) {
+    RequestQueue request_queue(server);
+    LatencyRecorder latencies;
+    for (const std::string& query : queries) {
+        latencies.Measure([&]() { return request_queue.AddFindRequest(query); });
+    }
+    reporter.Report(corpus_size, "RequestQueue::AddFindRequest"s, latencies,
+        { { "no_result_requests"s, static_cast<double>(request_queue.GetNoResultRequests()) } });
+}
+
+void BenchmarkRemoveDuplicates(SearchServer& server, size_t corpus_size, BenchmarkReporter& reporter,
+    const std::string& name = "RemoveDuplicates"s) {
+    const int count_before = server.GetDocumentCount();
+    LatencyRecorder latencies;
+    // RemoveDuplicates печатает каждый найденный дубликат - это не должно попадать в отчёт
+    std::ostringstream discarded;
+    auto* const cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    latencies.Measure([&]() { RemoveDuplicates(server); });
+    std::cout.rdbuf(cout_buffer);
+    reporter.Report(corpus_size, name, latencies,
+        { { "removed"s, static_cast<double>(count_before - server.GetDocumentCount()) } });
+}
+
+void BenchmarkRemoveDocument(SearchServer& server, size_t remove_count, size_t corpus_size,
+    const CountingMemoryResource& index_memory, BenchmarkReporter& reporter) {
+    std::vector<int> document_ids(server.begin(), server.end());
+    const size_t count = std::min(remove_count, document_ids.size() / 2);
+    AllocationProbe seq_allocations(index_memory);
+    LatencyRecorder seq_latencies;
+    for (size_t i = 0; i < count; ++i) {
+        seq_latencies.Measure([&]() { server.RemoveDocument(std::execution::seq, document_ids[i]); });
+    }
+    reporter.Report(corpus_size, "RemoveDocument/seq"s, seq_latencies, seq_allocations.GetPerOperation(count));
+    AllocationProbe par_allocations(index_memory);
+    LatencyRecorder par_latencies;
+    for (size_t i = count; i < 2 * count; ++i) {
+        par_latencies.Measure([&]() { server.RemoveDocument(std::execution::par, document_ids[i]); });
+    }
+    reporter.Report(corpus_size, "RemoveDocument/par"s, par_latencies, par_allocations.GetPerOperation(count));
+}
+
+// Проверка токенов документов по стоп-словам: совершенный хеш против прежнего std::set
+void BenchmarkStopWords(CorpusGenerator& generator, size_t corpus_size, BenchmarkReporter& reporter) {
+    const std::string stop_words_text = generator.GetStopWordsText();
+    const std::vector<std::string_view> stop_word_list = SplitIntoWords(stop_words_text);
+    const StopWordSet stop_words(stop_word_list);
+    const std::set<std::string, std::less<>> stop_word_tree(stop_word_list.begin(), stop_word_list.end());
+
+    std::vector<std::string> documents;
+    for (size_t i = 0; i < 1000; ++i) {
+        documents.push_back(generator.GenerateDocument());
+    }
+    std::vector<std::string_view> tokens;
+    for (const std::string& document : documents) {
+        const auto words = SplitIntoWords(document);
+        tokens.insert(tokens.end(), words.begin(), words.end());
+    }
+
+    const auto run = [&](const std::string& name, auto&& is_stop_word) {
+        LatencyRecorder latencies;
+        size_t stop_count = 0;
+        for (int pass = 0; pass < 20; ++pass) {
+            stop_count = latencies.Measure([&]() {
+                return static_cast<size_t>(std::count_if(tokens.begin(), tokens.end(), is_stop_word));
+            });
+        }
+        reporter.Report(corpus_size, name, latencies,
+            { { "lookups_per_op"s, static_cast<double>(tokens.size()) },
+              { "stop_words"s, static_cast<double>(stop_words.GetSize()) },
+              { "stop_tokens"s, static_cast<double>(stop_count) } });
+    };
+    run("StopWords/perfect_hash"s, [&](std::string_view word) { return stop_words.Contains(word); });
+    run("StopWords/std::set"s, [&](std::string_view word) { return stop_word_tree.count(word) > 0; });
+}
+
+// Разбиение текста на слова: SplitIntoWords против токенизатора без нормализации и с нормализацией.
+// mixed - тот же текст с заглавными буквами, пунктуацией и кириллицей, которые нормализация меняет
+void BenchmarkTokenizer(CorpusGenerator& generator, size_t corpus_size, BenchmarkReporter& reporter) {
+    std::string plain;
+    std::string mixed;
+    for (size_t i = 0; i < 1000; ++i) {
+        const std::string document = generator.GenerateDocument();
+        plain += document;
+        plain += ' ';
+        size_t word_index = 0;
+        for (const std::string_view word : SplitIntoWords(document)) {
+            std::string decorated(word);
+            if (word_index % 5 == 0) {
+                decorated[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(decorated[0])));
+            }
+            if (word_index % 7 == 6) {
+                decorated += ',';
+            }
+            if (word_index % 11 == 10) {
+                decorated = "«Слово»"s;
+            }
+            mixed += decorated;
+            mixed += ' ';
+            ++word_index;
+        }
+    }
+
+    const Tokenizer legacy;
+    TokenizerOptions normalizing_options;
+    normalizing_options.fold_case = true;
+    normalizing_options.strip_punctuation = true;
+    const Tokenizer normalizing(normalizing_options);
+    std::string buffer(std::max(plain.size(), mixed.size()), ' ');
+
+    const auto run = [&](const std::string& name, const std::string& text, auto&& tokenize) {
+        LatencyRecorder latencies;
+        size_t token_count = 0;
+        for (int pass = 0; pass < 20; ++pass) {
+            token_count = latencies.Measure([&]() { return tokenize(text); });
+        }
+        const double seconds = latencies.GetTotalNanoseconds() / 1e9;
+        reporter.Report(corpus_size, name, latencies,
+            { { "bytes_per_op"s, static_cast<double>(text.size()) },
+              { "tokens_per_op"s, static_cast<double>(token_count) },
+              { "megabytes_per_second"s, seconds > 0 ? text.size() * latencies.GetCount() / seconds / 1e6 : 0.0 } });
+    };
+    const auto split = [](const std::string& text) {
+        return SplitIntoWords(text).size();
+    };
+    const auto tokenize_with = [&buffer](const Tokenizer& tokenizer) {
+        return [&buffer, &tokenizer](const std::string& text) {
+            size_t token_count = 0;
+            tokenizer.ForEachToken(text, buffer.data(), [&token_count](const Token&) { ++token_count; });
+            return token_count;
+        };
+    };
+    run("Tokenize/SplitIntoWords"s, plain, split);
+    run("Tokenize/legacy"s, plain, tokenize_with(legacy));
+    run("Tokenize/normalizing"s, plain, tokenize_with(normalizing));
+    run("Tokenize/normalizing/mixed"s, mixed, tokenize_with(normalizing));
+}
+
+// Фразы по позиционному индексу: те же пары соседних слов документов как отдельные слова,
+// как фраза и как близость. Разница задержек - цена проверки позиций у кандидатов
+void BenchmarkPhraseQueries(CorpusGenerator& generator, size_t corpus_size, size_t query_count,
+    BenchmarkReporter& reporter) {
+    SearchServerOptions options;
+    options.store_positions = true;
+    SearchServer server(generator.GetStopWordsText(), options);
+    std::vector<std::string> documents;
+    LatencyRecorder add_latencies;
+    for (size_t id = 0; id < corpus_size; ++id) {
+        documents.push_back(generator.GenerateDocument());
+        add_latencies.Measure([&]() {
+            server.AddDocument(static_cast<int>(id), documents.back(), generator.GenerateStatus(),
+                generator.GenerateRatings());
+        });
+    }
+    const MemoryUsage memory = server.GetMemoryUsage();
+    reporter.Report(corpus_size, "AddDocument/positions"s, add_latencies,
+        { { "memory_positions"s, static_cast<double>(memory.positions) },
+          { "memory_total"s, static_cast<double>(memory.GetTotal()) } });
+
+    std::vector<std::string> bigrams;
+    while (bigrams.size() < query_count) {
+        const auto words = SplitIntoWords(documents[generator.NextIndex(documents.size())]);
+        if (words.size() >= 2) {
+            const size_t start = generator.NextIndex(words.size() - 1);
+            bigrams.push_back(std::string(words[start]) + ' ' + std::string(words[start + 1]));
+        }
+    }
+    const auto run = [&](const std::string& name, const std::string& prefix, const std::string& suffix) {
+        LatencyRecorder latencies;
+        size_t found = 0;
+        size_t rejected = 0;
+        QueryStats stats;
+        const auto all = [](int, DocumentStatus, int) { return true; };
+        for (const std::string& bigram : bigrams) {
+            const std::string query = prefix + bigram + suffix;
+            found += latencies.Measure([&]() { return server.FindTopDocuments(query, all, stats); }).size();
+            rejected += stats.rejected_by_phrases;
+        }
+        reporter.Report(corpus_size, name, latencies,
+            { { "avg_results"s, static_cast<double>(found) / static_cast<double>(bigrams.size()) },
+              { "avg_rejected_by_phrases"s, static_cast<double>(rejected) / static_cast<double>(bigrams.size()) } });
+    };
+    run("FindTopDocuments/words"s, ""s, ""s);
+    run("FindTopDocuments/phrase"s, "\""s, "\""s);
+    run("FindTopDocuments/proximity"s, "\""s, "\"~3"s);
+}
+
+// Списки по вкладу: поиск с ранней остановкой против полного обхода на тех же запросах
+// и расхождение выдач из-за квантования
+void BenchmarkImpactIndex(CorpusGenerator& generator, size_t corpus_size, size_t query_count,
+    BenchmarkReporter& reporter) {
+    SearchServer server(generator.GetStopWordsText());
+    for (size_t id = 0; id < corpus_size; ++id) {
+        server.AddDocument(static_cast<int>(id), generator.GenerateDocument(), generator.GenerateStatus(),
+            generator.GenerateRatings());
+    }
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < query_count; ++i) {
+        queries.push_back(generator.GenerateQuery(3, generator.NextIndex(10) < 3 ? 1 : 0));
+    }
+    const auto run = [&](LatencyRecorder& latencies) {
+        std::vector<std::vector<Document>> results;
+        for (const std::string& query : queries) {
+            results.push_back(latencies.Measure([&]() { return server.FindTopDocuments(query); }));
+        }
+        return results;
+    };
+    LatencyRecorder exact_latencies;
+    const auto exact = run(exact_latencies);
+    reporter.Report(corpus_size, "FindTopDocuments/exhaustive"s, exact_latencies);
+
+    for (const int bits : { 16, 8 }) {
+        LatencyRecorder build_latencies;
+        build_latencies.Measure([&]() { server.BuildImpactIndex(bits); });
+        reporter.Report(corpus_size, "BuildImpactIndex/"s + std::to_string(bits), build_latencies,
+            { { "memory_impacts"s, static_cast<double>(server.GetMemoryUsage().impacts) } });
+        LatencyRecorder latencies;
+        const auto results = run(latencies);
+        double max_relevance_error = 0.0;
+        size_t changed_positions = 0;
+        for (size_t i = 0; i < results.size(); ++i) {
+            for (size_t j = 0; j < std::min(results[i].size(), exact[i].size()); ++j) {
+                max_relevance_error = std::max(max_relevance_error,
+                    std::abs(results[i][j].relevance - exact[i][j].relevance));
+                changed_positions += results[i][j].id != exact[i][j].id ? 1 : 0;
+            }
+            changed_positions += std::max(results[i].size(), exact[i].size())
+                - std::min(results[i].size(), exact[i].size());
+        }
+        reporter.Report(corpus_size, "FindTopDocuments/impact"s + std::to_string(bits), latencies,
+            { { "max_relevance_error"s, max_relevance_error },
+              { "changed_positions"s, static_cast<double>(changed_positions) } });
+    }
+}
+
+// Одна std::unordered_map под общим мьютексом - точка отсчёта для ConcurrentMap
+class LockedMap {
+public:
+    explicit LockedMap(size_t) {
+    }
+
+    double FetchAdd(int key, double delta) {
+        std::lock_guard guard(mutex_);
+        const double previous = map_[key];
+        map_[key] += delta;
+        return previous;
+    }
+
+    bool Contains(int key) const {
+        std::lock_guard guard(mutex_);
+        return map_.count(key) > 0;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<int, double> map_;
+};
+
+// Потоки делят operation_count операций над key_count ключами; read_percent процентов операций - чтения
+template <typename Map>
+void RunMapContention(const std::string& name, size_t thread_count, size_t operation_count, size_t key_count,
+    size_t read_percent, size_t corpus_size, BenchmarkReporter& reporter) {
+    Map map(thread_count * 4);
+    LatencyRecorder latencies;
+    latencies.Measure([&]() {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&map, t, thread_count, operation_count, key_count, read_percent]() {
+                std::mt19937 generator(static_cast<uint32_t>(t));
+                for (size_t i = t; i < operation_count; i += thread_count) {
+                    const int key = static_cast<int>(generator() % key_count);
+                    if (generator() % 100 < read_percent) {
+                        map.Contains(key);
+                    }
+                    else {
+                        map.FetchAdd(key, 1.0);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    });
+    reporter.Report(corpus_size, name + "/threads="s + std::to_string(thread_count), latencies,
+        { { "threads"s, static_cast<double>(thread_count) },
+          { "ops_per_second"s, static_cast<double>(operation_count) * 1e9
+              / static_cast<double>(latencies.GetTotalNanoseconds()) } });
+}
+
+// Конкуренция за таблицу при 1-64 потоках: накопление релевантности (только FetchAdd, ключи - документы
+// корпуса) и нагрузка с 90% чтений
+void BenchmarkConcurrentMap(size_t corpus_size, size_t query_count, BenchmarkReporter& reporter) {
+    const size_t operation_count = query_count * 256;
+    for (size_t thread_count = 1; thread_count <= 64; thread_count *= 2) {
+        for (const size_t read_percent : { size_t(0), size_t(90) }) {
+            const std::string workload = read_percent == 0 ? "fetch_add"s : "read_mostly"s;
+            RunMapContention<LockedMap>("LockedMap/"s + workload, thread_count, operation_count,
+                corpus_size, read_percent, corpus_size, reporter);
+            RunMapContention<ConcurrentMap<int, double>>("ConcurrentMap/exclusive/"s + workload, thread_count,
+                operation_count, corpus_size, read_percent, corpus_size, reporter);
+            RunMapContention<ConcurrentMap<int, double, std::hash<int>, SharedLocking>>(
+                "ConcurrentMap/shared/"s + workload, thread_count, operation_count, corpus_size, read_percent,
+                corpus_size, reporter);
+        }
+    }
+}
+
+// Поиск дубликатов при добавлении: каждый десятый документ повторяет один из предыдущих.
+// Цена проверки на документ против полного прохода RemoveDuplicates по тому же корпусу
+void BenchmarkDuplicateDetection(CorpusGenerator& generator, size_t corpus_size, BenchmarkReporter& reporter) {
+    std::vector<std::string> documents;
+    for (size_t id = 0; id < corpus_size; ++id) {
+        documents.push_back(id % 10 == 9 ? documents[generator.NextIndex(documents.size())]
+            : generator.GenerateDocument());
+    }
+    for (const DuplicatePolicy policy : { DuplicatePolicy::KEEP, DuplicatePolicy::REJECT, DuplicatePolicy::FLAG }) {
+        SearchServerOptions options;
+        options.duplicate_policy = policy;
+        SearchServer server(generator.GetStopWordsText(), options);
+        LatencyRecorder latencies;
+        size_t rejected = 0;
+        for (size_t id = 0; id < documents.size(); ++id) {
+            try {
+                latencies.Measure([&]() {
+                    server.AddDocument(static_cast<int>(id), documents[id], DocumentStatus::ACTUAL, { 1 });
+                });
+            }
+            catch (const std::invalid_argument&) {
+                ++rejected;
+            }
+        }
+        const std::string name = policy == DuplicatePolicy::KEEP ? "keep"s
+            : policy == DuplicatePolicy::REJECT ? "reject"s : "flag"s;
+        reporter.Report(corpus_size, "AddDocument/duplicates="s + name, latencies,
+            { { "rejected"s, static_cast<double>(rejected) },
+              { "memory_document_metadata"s, static_cast<double>(server.GetMemoryUsage().document_metadata) } });
+        if (policy == DuplicatePolicy::KEEP) {
+            BenchmarkRemoveDuplicates(server, corpus_size, reporter, "RemoveDuplicates/duplicates=10%"s);
+        }
+    }
+}
+
+// Близкие дубликаты: каждый десятый документ - копия одного из предыдущих с одним заменённым словом.
+// recall - доля найденных подложенных пар среди тех, чьё точное сходство не ниже порога
+void BenchmarkNearDuplicates(CorpusGenerator& generator, size_t corpus_size, BenchmarkReporter& reporter) {
+    SearchServer server(generator.GetStopWordsText());
+    std::vector<std::string> documents;
+    std::vector<std::pair<int, int>> planted;
+    for (size_t id = 0; id < corpus_size; ++id) {
+        if (id % 10 != 9) {
+            documents.push_back(generator.GenerateDocument());
+        }
+        else {
+            const size_t original = generator.NextIndex(documents.size());
+            std::vector<std::string_view> words = SplitIntoWords(documents[original]);
+            const auto& vocabulary = generator.GetVocabulary();
+            words[generator.NextIndex(words.size())] = vocabulary[generator.NextIndex(vocabulary.size())];
+            std::string text;
+            for (const std::string_view word : words) {
+                text += std::string(word) + ' ';
+            }
+            documents.push_back(std::move(text));
+            planted.emplace_back(static_cast<int>(original), static_cast<int>(id));
+        }
+        server.AddDocument(static_cast<int>(id), documents.back(), DocumentStatus::ACTUAL, { 1 });
+    }
+
+    const NearDuplicateOptions options;
+    const auto similarity = [&server](int lhs, int rhs) {
+        std::set<std::string_view> left;
+        std::set<std::string_view> right;
+        for (const auto& [word, _] : server.GetWordFrequencies(lhs)) {
+            left.insert(word);
+        }
+        for (const auto& [word, _] : server.GetWordFrequencies(rhs)) {
+            right.insert(word);
+        }
+        std::vector<std::string_view> common;
+        std::set_intersection(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(common));
+        return left.empty() && right.empty() ? 1.0
+            : static_cast<double>(common.size()) / static_cast<double>(left.size() + right.size() - common.size());
+    };
+    std::set<std::pair<int, int>> expected;
+    for (const auto& pair : planted) {
+        if (similarity(pair.first, pair.second) >= options.threshold) {
+            expected.insert(pair);
+        }
+    }
+
+    const auto run = [&](const auto& policy, const std::string& name) {
+        LatencyRecorder latencies;
+        NearDuplicateStats stats;
+        std::vector<NearDuplicatePair> found;
+        latencies.Measure([&]() { found = FindNearDuplicates(policy, server, options, &stats); });
+        size_t recalled = 0;
+        for (const auto& pair : found) {
+            recalled += expected.count({ pair.first_id, pair.second_id });
+        }
+        reporter.Report(corpus_size, name, latencies,
+            { { "bands"s, static_cast<double>(stats.bands) },
+              { "rows"s, static_cast<double>(stats.rows) },
+              { "candidate_pairs"s, static_cast<double>(stats.candidate_pairs) },
+              { "pairs"s, static_cast<double>(found.size()) },
+              { "recall"s, expected.empty() ? 1.0 : static_cast<double>(recalled) / expected.size() },
+              { "signature_ms"s, std::chrono::duration<double, std::milli>(stats.signature_time).count() },
+              { "banding_ms"s, std::chrono::duration<double, std::milli>(stats.banding_time).count() },
+              { "verification_ms"s, std::chrono::duration<double, std::milli>(stats.verification_time).count() } });
+    };
+    run(std::execution::seq, "FindNearDuplicates/seq"s);
+    run(std::execution::par, "FindNearDuplicates/par"s);
+}
+
+// Загрузка корпуса из файла: построчное чтение getline против отображения файла с параллельным разбором частей
+void BenchmarkCorpusLoading(CorpusGenerator& generator, size_t corpus_size, BenchmarkReporter& reporter) {
+    const auto path = std::filesystem::temp_directory_path() / ("search_server_benchmark_"s
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tsv"s);
+    {
+        std::string corpus;
+        for (size_t id = 0; id < corpus_size; ++id) {
+            AppendCorpusLine(corpus, static_cast<int>(id), generator.GenerateStatus(), generator.GenerateRatings(),
+                generator.GenerateDocument());
+        }
+        std::ofstream(path, std::ios::binary) << corpus;
+    }
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+    const auto report = [&](const std::string& name, LatencyRecorder& latencies, size_t documents,
+        std::vector<std::pair<std::string, double>> extra) {
+        const double seconds = static_cast<double>(latencies.GetTotalNanoseconds()) / 1e9;
+        extra.emplace_back("documents_per_second"s, static_cast<double>(documents) / seconds);
+        extra.emplace_back("megabytes_per_second"s, megabytes / seconds);
+        reporter.Report(corpus_size, name, latencies, extra);
+    };
+
+    {
+        const std::unordered_map<std::string, DocumentStatus> statuses = { { "ACTUAL"s, DocumentStatus::ACTUAL },
+            { "IRRELEVANT"s, DocumentStatus::IRRELEVANT }, { "BANNED"s, DocumentStatus::BANNED },
+            { "REMOVED"s, DocumentStatus::REMOVED } };
+        SearchServer server(generator.GetStopWordsText());
+        LatencyRecorder latencies;
+        latencies.Measure([&]() {
+            std::ifstream input(path);
+            std::string line;
+            while (std::getline(input, line)) {
+                const size_t status_begin = line.find('\t') + 1;
+                const size_t ratings_begin = line.find('\t', status_begin) + 1;
+                const size_t text_begin = line.find('\t', ratings_begin) + 1;
+                const int id = std::stoi(line.substr(0, status_begin - 1));
+                const DocumentStatus status = statuses.at(line.substr(status_begin, ratings_begin - status_begin - 1));
+                std::istringstream ratings_input(line.substr(ratings_begin, text_begin - ratings_begin - 1));
+                std::vector<int> ratings;
+                for (int rating = 0; ratings_input >> rating;) {
+                    ratings.push_back(rating);
+                }
+                server.AddDocument(id, line.substr(text_begin), status, ratings);
+            }
+        });
+        report("LoadCorpus/getline"s, latencies, static_cast<size_t>(server.GetDocumentCount()), {});
+    }
+    for (const size_t parallel_chunks : { size_t(1), size_t(0) }) {
+        SearchServer server(generator.GetStopWordsText());
+        CorpusLoadOptions options;
+        options.parallel_chunks = parallel_chunks;
+        // Части поменьше, чтобы и небольшой корпус разбирался в несколько волн
+        options.chunk_size = 256 << 10;
+        LatencyRecorder latencies;
+        CorpusLoadStats stats;
+        latencies.Measure([&]() { stats = LoadCorpusFile(server, path.string(), options); });
+        report(parallel_chunks == 1 ? "LoadCorpus/mmap_chunks=1"s : "LoadCorpus/mmap_chunks=auto"s, latencies,
+            stats.documents,
+            { { "parse_megabytes_per_second"s, megabytes / std::chrono::duration<double>(stats.parse_time).count() },
+              { "parse_seconds"s, std::chrono::duration<double>(stats.parse_time).count() },
+              { "index_seconds"s, std::chrono::duration<double>(stats.index_time).count() } });
+    }
+    std::filesystem::remove(path);
+}
+
+// Восстановление из снимка корпуса и журнала из recent_count последних добавлений
+void BenchmarkRecovery(CorpusGenerator& generator, size_t corpus_size, size_t recent_count,
+    BenchmarkReporter& reporter) {
+    const auto directory = std::filesystem::temp_directory_path() / ("search_server_benchmark_"s
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    PersistenceOptions options;
+    options.log.sync_to_disk = false;
+    LatencyRecorder checkpoint_latencies;
+    {
+        PersistentSearchServer server(directory, generator.GetStopWordsText(), options);
+        for (size_t id = 0; id < corpus_size + recent_count; ++id) {
+            if (id == corpus_size) {
+                checkpoint_latencies.Measure([&]() { server.Checkpoint(); });
+            }
+            server.AddDocument(static_cast<int>(id), generator.GenerateDocument(), generator.GenerateStatus(),
+                generator.GenerateRatings());
+        }
+    }
+    reporter.Report(corpus_size, "PersistentSearchServer::Checkpoint"s, checkpoint_latencies,
+        { { "snapshot_bytes"s, static_cast<double>(std::filesystem::file_size(directory / "snapshot")) } });
+
+    LatencyRecorder recovery_latencies;
+    RecoveryStats stats;
+    recovery_latencies.Measure([&]() { stats = PersistentSearchServer(directory, ""sv, options).GetRecoveryStats(); });
+    reporter.Report(corpus_size, "PersistentSearchServer::Recovery"s, recovery_latencies,
+        { { "snapshot_documents"s, static_cast<double>(stats.snapshot_documents) },
+          { "replayed_records"s, static_cast<double>(stats.replayed_records) } });
+    std::filesystem::remove_all(directory);
+}
+
+// Кеш частых слов на потоке запросов по закону Ципфа: без кеша (предикат-лямбда), первый проход с наполнением
+// кеша и повторный. Затем добавления и удаления документов, обновляющие срезы
+void BenchmarkHotTermCache(CorpusGenerator& generator, size_t corpus_size, size_t query_count, size_t update_count,
+    BenchmarkReporter& reporter) {
+    SearchServerOptions options;
+    options.hot_terms.capacity = size_t(64) << 20;
+    SearchServer server(generator.GetStopWordsText(), options);
+    for (size_t id = 0; id < corpus_size; ++id) {
+        server.AddDocument(static_cast<int>(id), generator.GenerateDocument(), generator.GenerateStatus(),
+            generator.GenerateRatings());
+    }
+    std::vector<std::string> queries;
+    for (size_t i = 0; i < query_count; ++i) {
+        queries.push_back(generator.GenerateQuery(3, generator.NextIndex(10) < 3 ? 1 : 0));
+    }
+    const auto actual = [](int, DocumentStatus status, int) { return status == DocumentStatus::ACTUAL; };
+    LatencyRecorder uncached_latencies;
+    for (const std::string& query : queries) {
+        uncached_latencies.Measure([&]() { return server.FindTopDocuments(query, actual); });
+    }
+    reporter.Report(corpus_size, "FindTopDocuments/hot_terms=off"s, uncached_latencies);
+
+    const auto run = [&](const std::string& name) {
+        const HotTermCacheStats before = server.GetHotTermCacheStats();
+        LatencyRecorder latencies;
+        for (const std::string& query : queries) {
+            latencies.Measure([&]() { return server.FindTopDocuments(query, StatusPredicate{ DocumentStatus::ACTUAL }); });
+        }
+        const HotTermCacheStats after = server.GetHotTermCacheStats();
+        const size_t lookups = after.hits + after.misses - before.hits - before.misses;
+        reporter.Report(corpus_size, name, latencies,
+            { { "hit_rate"s, lookups > 0 ? static_cast<double>(after.hits - before.hits) / lookups : 0.0 },
+              { "admissions"s, static_cast<double>(after.admissions - before.admissions) },
+              { "evictions"s, static_cast<double>(after.evictions - before.evictions) },
+              { "slices"s, static_cast<double>(after.slices) },
+              { "memory_caches"s, static_cast<double>(server.GetMemoryUsage().caches) } });
+    };
+    run("FindTopDocuments/hot_terms=cold"s);
+    run("FindTopDocuments/hot_terms=warm"s);
+
+    // Цена поддержки срезов: каждое слово нового документа ищется в кеше
+    LatencyRecorder add_latencies;
+    const size_t updates_before = server.GetHotTermCacheStats().updates;
+    for (size_t i = 0; i < update_count; ++i) {
+        const int document_id = static_cast<int>(corpus_size + i);
+        const std::string document = generator.GenerateDocument();
+        const DocumentStatus status = generator.GenerateStatus();
+        const std::vector<int> ratings = generator.GenerateRatings();
+        add_latencies.Measure([&]() { server.AddDocument(document_id, document, status, ratings); });
+        server.RemoveDocument(static_cast<int>(i));
+    }
+    reporter.Report(corpus_size, "AddDocument/hot_terms"s, add_latencies,
+        { { "slice_updates"s, static_cast<double>(server.GetHotTermCacheStats().updates - updates_before) } });
+    run("FindTopDocuments/hot_terms=updated"s);
+}
+
+void BenchmarkCorpus(size_t corpus_size, const BenchmarkOptions& options, BenchmarkReporter& reporter) {
+    CorpusOptions corpus_options;
+    corpus_options.seed = options.seed;
+    CorpusGenerator generator(corpus_options);
+    CountingMemoryResource index_memory;
+    SearchServerOptions server_options;
+    server_options.memory_resource = &index_memory;
+    server_options.use_arena = options.use_arena;
+    SearchServer server(generator.GetStopWordsText(), server_options);
+
+    BenchmarkAddDocument(server, generator, corpus_size, index_memory, reporter);
+
+    std::vector<std::string> queries;
+    std::vector<int> document_ids;
+    for (size_t i = 0; i < options.query_count; ++i) {
+        queries.push_back(generator.GenerateQuery(3, generator.NextIndex(10) < 3 ? 1 : 0));
+        document_ids.push_back(static_cast<int>(generator.NextIndex(corpus_size)));
+    }
+
+    BenchmarkFindTopDocuments(server, queries, std::execution::seq, "FindTopDocuments/seq"s, corpus_size,
+        index_memory, reporter);
+    BenchmarkFindTopDocuments(server, queries, std::execution::par, "FindTopDocuments/par"s, corpus_size,
+        index_memory, reporter);
+    BenchmarkScoring(server, queries, TfIdfScorer(), "FindTopDocuments/tf_idf"s, corpus_size, reporter);
+    BenchmarkScoring(server, queries, Bm25Scorer(), "FindTopDocuments/bm25"s, corpus_size, reporter);
+    BenchmarkMatchDocument(server, queries, document_ids, std::execution::seq, "MatchDocument/seq"s,
+        corpus_size, reporter);
+    BenchmarkMatchDocument(server, queries, document_ids, std::execution::par, "MatchDocument/par"s,
+        corpus_size, reporter);
+    BenchmarkMatchDocumentsBatch(server, queries, document_ids, options.batch_size, corpus_size, reporter);
+    BenchmarkProcessQueries(server, queries, options.batch_size, corpus_size, reporter);
+    BenchmarkNumaSearch(server, queries, options.batch_size, corpus_size, reporter);
+    BenchmarkRequestQueue(server, queries, corpus_size, reporter);
+    BenchmarkRemoveDuplicates(server, corpus_size, reporter);
+    BenchmarkRemoveDocument(server, options.remove_count, corpus_size, index_memory, reporter);
+    BenchmarkRecovery(generator, corpus_size, options.remove_count, reporter);
+    BenchmarkStopWords(generator, corpus_size, reporter);
+    BenchmarkTokenizer(generator, corpus_size, reporter);
+    BenchmarkPhraseQueries(generator, corpus_size, options.query_count, reporter);
+    BenchmarkImpactIndex(generator, corpus_size, options.query_count, reporter);
+    BenchmarkHotTermCache(generator, corpus_size, options.query_count, options.remove_count, reporter);
+    BenchmarkDuplicateDetection(generator, corpus_size, reporter);
+    BenchmarkNearDuplicates(generator, corpus_size, reporter);
+    BenchmarkCorpusLoading(generator, corpus_size, reporter);
+    BenchmarkConcurrentMap(corpus_size, options.query_count, reporter);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const BenchmarkOptions options = ParseOptions(argc, argv);
+        std::ofstream file;
+        if (!options.output_path.empty()) {
+            file.open(options.output_path);
+            if (!file) {
+                throw std::runtime_error("Cannot open "s + options.output_path);
+            }
+        }
+        BenchmarkReporter reporter(options.output_path.empty() ? std::cout : file, options.label);
+        for (const size_t corpus_size : options.corpus_sizes) {
+            BenchmarkCorpus(corpus_size, options, reporter);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        PrintUsage();
+        return 1;
+    }
+    return 0;
+}
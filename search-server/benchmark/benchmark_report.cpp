@@ -0,0 +1,78 @@
+#include "benchmark_report.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+void LatencyRecorder::Record(Clock::duration duration) {
+    const int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    samples_.push_back(nanoseconds);
+    total_ += nanoseconds;
+    sorted_ = false;
+}
+
+size_t LatencyRecorder::GetCount() const {
+    return samples_.size();
+}
+
+int64_t LatencyRecorder::GetTotalNanoseconds() const {
+    return total_;
+}
+
+int64_t LatencyRecorder::GetPercentile(double percentile) {
+    if (samples_.empty()) {
+        return 0;
+    }
+    if (!sorted_) {
+        std::sort(samples_.begin(), samples_.end());
+        sorted_ = true;
+    }
+    const double rank = percentile / 100.0 * static_cast<double>(samples_.size() - 1);
+    return samples_[static_cast<size_t>(std::llround(rank))];
+}
+
+BenchmarkReporter::BenchmarkReporter(std::ostream& output, std::string label)
+    : output_(output)
+    , label_(std::move(label))
+{
+}
+
+void BenchmarkReporter::Report(size_t corpus_size, const std::string& operation, LatencyRecorder& latencies,
+    const std::vector<std::pair<std::string, double>>& extra) {
+    const double total_seconds = static_cast<double>(latencies.GetTotalNanoseconds()) * 1e-9;
+    const double throughput = total_seconds > 0.0 ? static_cast<double>(latencies.GetCount()) / total_seconds : 0.0;
+    output_ << "{\"label\": \"" << label_ << "\""
+        << ", \"corpus_size\": " << corpus_size
+        << ", \"operation\": \"" << operation << "\""
+        << ", \"count\": " << latencies.GetCount()
+        << ", \"total_seconds\": " << total_seconds
+        << ", \"throughput_ops\": " << throughput
+        << ", \"p50_ns\": " << latencies.GetPercentile(50)
+        << ", \"p90_ns\": " << latencies.GetPercentile(90)
+        << ", \"p99_ns\": " << latencies.GetPercentile(99)
+        << ", \"max_ns\": " << latencies.GetPercentile(100)
+        << ", \"peak_rss_kb\": " << GetPeakRssKb();
+    for (const auto& [name, value] : extra) {
+        output_ << ", \"" << name << "\": " << value;
+    }
+    output_ << "}" << std::endl;
+}
+
+long GetPeakRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Накопитель задержек отдельных операций в наносекундах
+class LatencyRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void Record(Clock::duration duration);
+
+    template <typename Function>
+    auto Measure(Function&& function) {
+        const auto start = Clock::now();
+        if constexpr (std::is_void_v<decltype(function())>) {
+            function();
+            Record(Clock::now() - start);
+        }
+        else {
+            auto result = function();
+            Record(Clock::now() - start);
+            return result;
+        }
+    }
+
+    size_t GetCount() const;
+    int64_t GetTotalNanoseconds() const;
+    // percentile из [0, 100]
+    int64_t GetPercentile(double percentile);
+
+private:
+    std::vector<int64_t> samples_;
+    int64_t total_ = 0;
+    bool sorted_ = true;
+};
+
+// Пишет по одной JSON-строке на измерение, чтобы результаты разных коммитов было легко сравнивать
+class BenchmarkReporter {
+public:
+    BenchmarkReporter(std::ostream& output, std::string label);
+
+    // Пропускная способность считается как операции в секунду по суммарному времени операций
+    void Report(size_t corpus_size, const std::string& operation, LatencyRecorder& latencies,
+        const std::vector<std::pair<std::string, double>>& extra = {});
+
+private:
+    std::ostream& output_;
+    const std::string label_;
+};
+
+// Пиковый размер резидентной памяти процесса в килобайтах; 0, если платформа не сообщает его
+long GetPeakRssKb();
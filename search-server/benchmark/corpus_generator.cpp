@@ -0,0 +1,133 @@
+#include "corpus_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const size_t RECENT_DOCUMENT_COUNT = 64;
+
+std::string MakeWord(size_t index) {
+    std::string word;
+    do {
+        word.push_back(static_cast<char>('a' + index % 26));
+        index /= 26;
+    } while (index > 0);
+    // Слова разной длины, как в живом тексте: частым словам достаются короткие
+    return word + std::string("x");
+}
+
+}  // namespace
+
+CorpusGenerator::CorpusGenerator(const CorpusOptions& options)
+    : options_(options)
+    , state_(options.seed)
+{
+    vocabulary_.reserve(options_.vocabulary_size);
+    cumulative_weights_.reserve(options_.vocabulary_size);
+    double total = 0.0;
+    for (size_t rank = 0; rank < options_.vocabulary_size; ++rank) {
+        vocabulary_.push_back(MakeWord(rank));
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), options_.zipf_exponent);
+        cumulative_weights_.push_back(total);
+    }
+    for (double& weight : cumulative_weights_) {
+        weight /= total;
+    }
+}
+
+const std::vector<std::string>& CorpusGenerator::GetVocabulary() const {
+    return vocabulary_;
+}
+
+std::string CorpusGenerator::GetStopWordsText() const {
+    std::string result;
+    for (size_t i = 0; i < std::min(options_.stop_word_count, vocabulary_.size()); ++i) {
+        if (!result.empty()) {
+            result.push_back(' ');
+        }
+        result += vocabulary_[i];
+    }
+    return result;
+}
+
+std::string CorpusGenerator::GenerateDocument() {
+    if (!recent_documents_.empty() && NextUnit() < options_.duplicate_share) {
+        return recent_documents_[NextIndex(recent_documents_.size())];
+    }
+    const size_t span = options_.max_words_per_document - options_.min_words_per_document + 1;
+    const size_t word_count = options_.min_words_per_document + NextIndex(span);
+    std::string document;
+    for (size_t i = 0; i < word_count; ++i) {
+        if (i > 0) {
+            document.push_back(' ');
+        }
+        document += NextZipfWord();
+    }
+    if (recent_documents_.size() < RECENT_DOCUMENT_COUNT) {
+        recent_documents_.push_back(document);
+    }
+    else {
+        recent_documents_[NextIndex(RECENT_DOCUMENT_COUNT)] = document;
+    }
+    return document;
+}
+
+std::string CorpusGenerator::GenerateQuery(size_t plus_word_count, size_t minus_word_count) {
+    std::string query;
+    for (size_t i = 0; i < plus_word_count + minus_word_count; ++i) {
+        if (i > 0) {
+            query.push_back(' ');
+        }
+        if (i >= plus_word_count) {
+            query.push_back('-');
+        }
+        query += NextZipfWord();
+    }
+    return query;
+}
+
+DocumentStatus CorpusGenerator::GenerateStatus() {
+    const size_t value = NextIndex(100);
+    if (value < 85) {
+        return DocumentStatus::ACTUAL;
+    }
+    if (value < 93) {
+        return DocumentStatus::IRRELEVANT;
+    }
+    if (value < 98) {
+        return DocumentStatus::BANNED;
+    }
+    return DocumentStatus::REMOVED;
+}
+
+std::vector<int> CorpusGenerator::GenerateRatings() {
+    std::vector<int> ratings(NextIndex(5));
+    for (int& rating : ratings) {
+        rating = static_cast<int>(NextIndex(21)) - 10;
+    }
+    return ratings;
+}
+
+uint64_t CorpusGenerator::NextRandom() {
+    // splitmix64
+    uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+size_t CorpusGenerator::NextIndex(size_t bound) {
+    return static_cast<size_t>(NextRandom() % bound);
+}
+
+double CorpusGenerator::NextUnit() {
+    return static_cast<double>(NextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+const std::string& CorpusGenerator::NextZipfWord() {
+    const double target = NextUnit();
+    const auto it = std::lower_bound(cumulative_weights_.begin(), cumulative_weights_.end(), target);
+    const size_t rank = std::min(static_cast<size_t>(it - cumulative_weights_.begin()), vocabulary_.size() - 1);
+    return vocabulary_[rank];
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../document.h"
+
+struct CorpusOptions {
+    size_t vocabulary_size = 50000;
+    size_t min_words_per_document = 10;
+    size_t max_words_per_document = 60;
+    double zipf_exponent = 1.0;
+    size_t stop_word_count = 20;
+    // Доля документов, повторяющих набор слов одного из предыдущих
+    double duplicate_share = 0.01;
+    uint64_t seed = 42;
+};
+
+// Детерминированный генератор корпуса и запросов: частоты слов подчиняются закону Ципфа.
+// Результат зависит только от CorpusOptions, а не от стандартной библиотеки
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(const CorpusOptions& options = {});
+
+    const std::vector<std::string>& GetVocabulary() const;
+    // Стоп-слова - самые частые слова словаря
+    std::string GetStopWordsText() const;
+
+    std::string GenerateDocument();
+    std::string GenerateQuery(size_t plus_word_count, size_t minus_word_count);
+    DocumentStatus GenerateStatus();
+    std::vector<int> GenerateRatings();
+
+    uint64_t NextRandom();
+    // Равномерно распределённое число из [0, bound)
+    size_t NextIndex(size_t bound);
+
+private:
+    double NextUnit();
+    const std::string& NextZipfWord();
+
+    CorpusOptions options_;
+    uint64_t state_;
+    std::vector<std::string> vocabulary_;
+    std::vector<double> cumulative_weights_;
+    std::vector<std::string> recent_documents_;
+};
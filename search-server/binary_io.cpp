@@ -0,0 +1,125 @@
+#include "binary_io.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+std::array<uint32_t, 256> MakeCrc32Table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        uint32_t value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+}  // namespace
+
+uint32_t ComputeCrc32(std::string_view data, uint32_t crc) {
+    static const std::array<uint32_t, 256> table = MakeCrc32Table();
+    crc = ~crc;
+    for (const char c : data) {
+        crc = table[(crc ^ static_cast<uint8_t>(c)) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+BinaryWriter::BinaryWriter(std::string& buffer)
+    : buffer_(buffer)
+{
+}
+
+void BinaryWriter::WriteUint8(uint8_t value) {
+    buffer_.push_back(static_cast<char>(value));
+}
+
+void BinaryWriter::WriteUint32(uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        buffer_.push_back(static_cast<char>((value >> shift) & 0xFFu));
+    }
+}
+
+void BinaryWriter::WriteUint64(uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        buffer_.push_back(static_cast<char>((value >> shift) & 0xFFu));
+    }
+}
+
+void BinaryWriter::WriteInt32(int32_t value) {
+    WriteUint32(static_cast<uint32_t>(value));
+}
+
+void BinaryWriter::WriteDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteUint64(bits);
+}
+
+void BinaryWriter::WriteString(std::string_view value) {
+    WriteUint32(static_cast<uint32_t>(value.size()));
+    buffer_.append(value);
+}
+
+BinaryReader::BinaryReader(std::string_view data)
+    : data_(data)
+{
+}
+
+uint8_t BinaryReader::ReadUint8() {
+    return static_cast<uint8_t>(ReadBytes(1)[0]);
+}
+
+uint32_t BinaryReader::ReadUint32() {
+    const std::string_view bytes = ReadBytes(4);
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+}
+
+uint64_t BinaryReader::ReadUint64() {
+    const std::string_view bytes = ReadBytes(8);
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+}
+
+int32_t BinaryReader::ReadInt32() {
+    return static_cast<int32_t>(ReadUint32());
+}
+
+double BinaryReader::ReadDouble() {
+    const uint64_t bits = ReadUint64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string_view BinaryReader::ReadString() {
+    return ReadBytes(ReadUint32());
+}
+
+std::string_view BinaryReader::ReadBytes(size_t size) {
+    if (size > data_.size() - position_) {
+        throw std::runtime_error(std::string("Unexpected end of binary data"));
+    }
+    const std::string_view bytes = data_.substr(position_, size);
+    position_ += size;
+    return bytes;
+}
+
+size_t BinaryReader::GetPosition() const {
+    return position_;
+}
+
+bool BinaryReader::IsEnd() const {
+    return position_ == data_.size();
+}
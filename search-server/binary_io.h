@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// CRC-32 (IEEE 802.3). crc - результат для предыдущей части данных, чтобы считать по частям
+uint32_t ComputeCrc32(std::string_view data, uint32_t crc = 0);
+
+// Запись чисел в буфер в little-endian независимо от платформы
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& buffer);
+
+    void WriteUint8(uint8_t value);
+    void WriteUint32(uint32_t value);
+    void WriteUint64(uint64_t value);
+    void WriteInt32(int32_t value);
+    void WriteDouble(double value);
+    // Длина и байты строки
+    void WriteString(std::string_view value);
+
+private:
+    std::string& buffer_;
+};
+
+// Чтение того, что записал BinaryWriter. При нехватке данных бросает std::runtime_error
+class BinaryReader {
+public:
+    explicit BinaryReader(std::string_view data);
+
+    uint8_t ReadUint8();
+    uint32_t ReadUint32();
+    uint64_t ReadUint64();
+    int32_t ReadInt32();
+    double ReadDouble();
+    // Ссылается на исходные данные
+    std::string_view ReadString();
+    std::string_view ReadBytes(size_t size);
+
+    size_t GetPosition() const;
+    bool IsEnd() const;
+
+private:
+    std::string_view data_;
+    size_t position_ = 0;
+};
@@ -0,0 +1,69 @@
+#include "concurrency_limiter.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+ConcurrencyLimiter::Permit::Permit(std::shared_ptr<ConcurrencyLimiter> limiter)
+    : limiter_(std::move(limiter))
+{
+    if (limiter_) {
+        limiter_->Acquire();
+    }
+}
+
+ConcurrencyLimiter::Permit::~Permit() {
+    if (limiter_) {
+        limiter_->Release();
+    }
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(const ConcurrencyLimit& limit)
+    : limit_(limit)
+{
+    if (limit_.max_concurrent_queries == 0) {
+        throw std::invalid_argument(std::string("Concurrency limit must be positive"));
+    }
+}
+
+void ConcurrencyLimiter::Acquire() {
+    std::unique_lock lock(mutex_);
+    if (active_ < limit_.max_concurrent_queries) {
+        ++active_;
+        return;
+    }
+    if (limit_.policy == OverloadPolicy::REJECT || waiting_ >= limit_.max_waiting_queries) {
+        Reject();
+    }
+    ++waiting_;
+    const bool acquired = slot_released_.wait_for(lock, limit_.max_wait,
+        [this]() { return active_ < limit_.max_concurrent_queries; });
+    --waiting_;
+    if (!acquired) {
+        Reject();
+    }
+    ++active_;
+}
+
+void ConcurrencyLimiter::Release() {
+    {
+        std::lock_guard guard(mutex_);
+        --active_;
+    }
+    slot_released_.notify_one();
+}
+
+size_t ConcurrencyLimiter::GetActiveCount() const {
+    std::lock_guard guard(mutex_);
+    return active_;
+}
+
+size_t ConcurrencyLimiter::GetRejectedCount() const {
+    std::lock_guard guard(mutex_);
+    return rejected_;
+}
+
+void ConcurrencyLimiter::Reject() {
+    ++rejected_;
+    throw std::overflow_error(std::string("Search server is overloaded"));
+}
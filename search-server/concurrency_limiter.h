@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+enum class OverloadPolicy {
+    QUEUE,
+    REJECT,
+};
+
+struct ConcurrencyLimit {
+    size_t max_concurrent_queries = 1;
+    OverloadPolicy policy = OverloadPolicy::QUEUE;
+    // Для QUEUE: сколько запросов может ждать и как долго, прежде чем получить отказ
+    size_t max_waiting_queries = 1024;
+    std::chrono::milliseconds max_wait = std::chrono::milliseconds(100);
+};
+
+class ConcurrencyLimiter {
+public:
+    // Занимает слот на время жизни объекта; при limiter == nullptr ничего не делает.
+    // Держит ограничитель, поэтому слот возвращается, даже если ограничитель уже заменён
+    class Permit {
+    public:
+        explicit Permit(std::shared_ptr<ConcurrencyLimiter> limiter);
+        ~Permit();
+
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+    private:
+        std::shared_ptr<ConcurrencyLimiter> limiter_;
+    };
+
+    explicit ConcurrencyLimiter(const ConcurrencyLimit& limit);
+
+    // Бросает std::overflow_error, если слот получить не удалось
+    void Acquire();
+    void Release();
+
+    size_t GetActiveCount() const;
+    size_t GetRejectedCount() const;
+
+private:
+    void Reject();
+
+    const ConcurrencyLimit limit_;
+    mutable std::mutex mutex_;
+    std::condition_variable slot_released_;
+    size_t active_ = 0;
+    size_t waiting_ = 0;
+    size_t rejected_ = 0;
+};
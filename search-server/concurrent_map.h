@@ -1,62 +1,298 @@
-#pragma once
-
-#include <cstdlib>
-#include <future>
-#include <map>
-#include <string>
-#include <vector>
-
-
-
-using namespace std::string_literals;
-
-template <typename Key, typename Value>
-class ConcurrentMap {
-private:
-    struct Bucket {
-        std::mutex mutex;
-        std::map<Key, Value> map;
-    };
-
-public:
-    static_assert(std::is_integral_v<Key>, "ConcurrentMap supports only integer keys"s);
-
-    struct Access {
-        std::lock_guard<std::mutex> guard;
-        Value& ref_to_value;
-
-        Access(const Key& key, Bucket& bucket)
-            : guard(bucket.mutex)
-            , ref_to_value(bucket.map[key]) {
-        }
-    };
-
-    explicit ConcurrentMap(size_t bucket_count)
-        : buckets_(bucket_count) {
-    }
-
-    Access operator[](const Key& key) {
-        auto& bucket = buckets_[static_cast<uint64_t>(key) % buckets_.size()];
-        return { key, bucket };
-    }
-
-    std::map<Key, Value> BuildOrdinaryMap() {
-        std::map<Key, Value> result;
-        for (auto& [mutex, map] : buckets_) {
-            std::lock_guard g(mutex);
-            result.insert(map.begin(), map.end());
-        }
-        return result;
-    }
-
-    size_t Erase(const Key& key) {
-        size_t mapId = static_cast<uint64_t>(key) % buckets_.size();
-        std::lock_guard g(buckets_[mapId].mutex);
-        size_t result = buckets_[mapId].map.erase(key);
-        return result;
-    }
-
-private:
-    std::vector<Bucket> buckets_;
-    std::mutex mtx_erase;
-};
\ No newline at end of file
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Блокировки шарда ConcurrentMap. Чтения без блокировок не поддерживаются: при росте таблицы
+// старый массив слотов можно освободить, только когда его не читает ни один поток, а для этого
+// нужна отложенная очистка (эпохи, hazard pointers). Вместо этого SharedLocking пускает чтения параллельно
+
+// Любое обращение к шарду - исключительное. Дешевле всего, когда чтений мало
+struct ExclusiveLocking {
+    using Mutex = std::mutex;
+    using ReadLock = std::unique_lock<std::mutex>;
+    using WriteLock = std::unique_lock<std::mutex>;
+};
+
+// Find, Contains и GetSize шарда выполняются параллельно друг с другом
+struct SharedLocking {
+    using Mutex = std::shared_mutex;
+    using ReadLock = std::shared_lock<std::shared_mutex>;
+    using WriteLock = std::unique_lock<std::shared_mutex>;
+};
+
+namespace concurrent_map_detail {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Финализатор splitmix64: std::hash целых чисел - тождественная функция
+constexpr uint64_t MixHash(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+}  // namespace concurrent_map_detail
+
+// Хеш-таблица, разделённая на шарды со своими блокировками. Шард выбирают старшие биты перемешанного
+// хеша, слот внутри шарда - младшие. Шард - открытая адресация с линейным пробированием и удалением
+// сдвигом назад (без надгробий); шарды выровнены по кеш-линии, чтобы блокировки соседних шардов
+// не делили линию. Таблица шарда растёт вдвое при заполнении больше чем на 3/4
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename LockPolicy = ExclusiveLocking>
+class ConcurrentMap {
+public:
+    using Entry = std::pair<Key, Value>;
+
+private:
+    using Slot = std::optional<Entry>;
+
+    struct alignas(concurrent_map_detail::CACHE_LINE_SIZE) Shard {
+        explicit Shard(std::pmr::memory_resource* resource)
+            : slots(resource) {
+        }
+
+        mutable typename LockPolicy::Mutex mutex;
+        std::pmr::vector<Slot> slots;
+        size_t size = 0;
+    };
+
+public:
+    // Блокировка шарда удерживается, пока жив объект
+    struct Access {
+        typename LockPolicy::WriteLock guard;
+        Value& ref_to_value;
+
+        Access(const ConcurrentMap& map, const Key& key, uint64_t hash, Shard& shard)
+            : guard(shard.mutex)
+            , ref_to_value(map.FindOrInsert(shard, key, hash).second) {
+        }
+    };
+
+    explicit ConcurrentMap(size_t shard_count, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        const Hash& hash = Hash())
+        : hash_(hash)
+        , allocator_(resource)
+        , shard_count_(std::max<size_t>(shard_count, 1))
+        , shards_(allocator_.allocate(shard_count_))
+    {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            new (shards_ + i) Shard(resource);
+        }
+    }
+
+    ~ConcurrentMap() {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            shards_[i].~Shard();
+        }
+        allocator_.deallocate(shards_, shard_count_);
+    }
+
+    ConcurrentMap(const ConcurrentMap&) = delete;
+    ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+    // Значение ключа, при отсутствии - Value()
+    Access operator[](const Key& key) {
+        const uint64_t hash = ComputeHash(key);
+        return { *this, key, hash, GetShard(hash) };
+    }
+
+    // Прибавляет delta к значению ключа и возвращает прежнее значение
+    template <typename T = Value, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    Value FetchAdd(const Key& key, Value delta) {
+        const uint64_t hash = ComputeHash(key);
+        Shard& shard = GetShard(hash);
+        typename LockPolicy::WriteLock guard(shard.mutex);
+        Value& value = FindOrInsert(shard, key, hash).second;
+        const Value previous = value;
+        value += delta;
+        return previous;
+    }
+
+    // function(Value&) под блокировкой шарда; значение создаётся, если ключа нет
+    template <typename Function>
+    void Update(const Key& key, Function&& function) {
+        const uint64_t hash = ComputeHash(key);
+        Shard& shard = GetShard(hash);
+        typename LockPolicy::WriteLock guard(shard.mutex);
+        function(FindOrInsert(shard, key, hash).second);
+    }
+
+    // Копия значения
+    std::optional<Value> Find(const Key& key) const {
+        const uint64_t hash = ComputeHash(key);
+        const Shard& shard = GetShard(hash);
+        typename LockPolicy::ReadLock guard(shard.mutex);
+        const size_t index = FindIndex(shard, key, hash);
+        return index == NOT_FOUND ? std::nullopt : std::optional<Value>(shard.slots[index]->second);
+    }
+
+    bool Contains(const Key& key) const {
+        const uint64_t hash = ComputeHash(key);
+        const Shard& shard = GetShard(hash);
+        typename LockPolicy::ReadLock guard(shard.mutex);
+        return FindIndex(shard, key, hash) != NOT_FOUND;
+    }
+
+    size_t Erase(const Key& key) {
+        const uint64_t hash = ComputeHash(key);
+        Shard& shard = GetShard(hash);
+        typename LockPolicy::WriteLock guard(shard.mutex);
+        size_t index = FindIndex(shard, key, hash);
+        if (index == NOT_FOUND) {
+            return 0;
+        }
+        // Сдвиг назад: следующие записи цепочки переезжают в освободившийся слот, если их
+        // начальный слот не лежит между освободившимся и текущим
+        const size_t mask = shard.slots.size() - 1;
+        for (size_t next = (index + 1) & mask; shard.slots[next]; next = (next + 1) & mask) {
+            const size_t home = ComputeHash(shard.slots[next]->first) & mask;
+            if (((next - home) & mask) >= ((next - index) & mask)) {
+                shard.slots[index] = std::move(shard.slots[next]);
+                index = next;
+            }
+        }
+        shard.slots[index].reset();
+        --shard.size;
+        return 1;
+    }
+
+    // Не согласовано с одновременными изменениями: шарды читаются по очереди
+    size_t GetSize() const {
+        size_t size = 0;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            typename LockPolicy::ReadLock guard(shards_[i].mutex);
+            size += shards_[i].size;
+        }
+        return size;
+    }
+
+    // function(const Key&, Value&) для каждой записи. Шарды обходятся алгоритмом policy, каждый под
+    // своей блокировкой, поэтому function может вызываться одновременно для записей разных шардов
+    template <typename ExecutionPolicy, typename Function>
+    void ForEach(ExecutionPolicy&& policy, Function&& function) {
+        std::for_each(policy, shards_, shards_ + shard_count_, [&function](Shard& shard) {
+            typename LockPolicy::WriteLock guard(shard.mutex);
+            for (Slot& slot : shard.slots) {
+                if (slot) {
+                    function(static_cast<const Key&>(slot->first), slot->second);
+                }
+            }
+        });
+    }
+
+    template <typename Function>
+    void ForEach(Function&& function) {
+        ForEach(std::execution::seq, std::forward<Function>(function));
+    }
+
+    // Переносит записи в вектор transform(Key&&, Value&&) без промежуточной копии и очищает таблицу;
+    // результат transform должен конструироваться по умолчанию.
+    // Шарды обрабатываются алгоритмом policy и пишут в свои части вектора, поэтому порядок
+    // результата от числа потоков не зависит. Нельзя вызывать одновременно с изменениями таблицы
+    template <typename ExecutionPolicy, typename Transform>
+    auto Drain(ExecutionPolicy&& policy, Transform&& transform) {
+        using Result = std::decay_t<std::invoke_result_t<Transform&, Key&&, Value&&>>;
+        std::vector<size_t> offsets(shard_count_ + 1, 0);
+        for (size_t i = 0; i < shard_count_; ++i) {
+            offsets[i + 1] = offsets[i] + shards_[i].size;
+        }
+        std::vector<Result> result(offsets.back());
+        std::vector<size_t> indices(shard_count_);
+        std::iota(indices.begin(), indices.end(), size_t(0));
+        std::for_each(policy, indices.begin(), indices.end(), [&](size_t shard_index) {
+            Shard& shard = shards_[shard_index];
+            typename LockPolicy::WriteLock guard(shard.mutex);
+            auto output = result.begin() + offsets[shard_index];
+            for (Slot& slot : shard.slots) {
+                if (slot) {
+                    *output++ = transform(std::move(slot->first), std::move(slot->second));
+                    slot.reset();
+                }
+            }
+            shard.size = 0;
+        });
+        return result;
+    }
+
+    std::map<Key, Value> BuildOrdinaryMap() {
+        std::map<Key, Value> result;
+        ForEach([&result](const Key& key, const Value& value) { result.emplace(key, value); });
+        return result;
+    }
+
+private:
+    static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+    static constexpr size_t INITIAL_CAPACITY = 8;
+
+    uint64_t ComputeHash(const Key& key) const {
+        return concurrent_map_detail::MixHash(static_cast<uint64_t>(hash_(key)));
+    }
+
+    Shard& GetShard(uint64_t hash) const {
+        return shards_[(hash >> 32) % shard_count_];
+    }
+
+    static size_t FindIndex(const Shard& shard, const Key& key, uint64_t hash) {
+        if (shard.slots.empty()) {
+            return NOT_FOUND;
+        }
+        const size_t mask = shard.slots.size() - 1;
+        for (size_t index = hash & mask; shard.slots[index]; index = (index + 1) & mask) {
+            if (shard.slots[index]->first == key) {
+                return index;
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    // Вызывается под блокировкой шарда
+    Entry& FindOrInsert(Shard& shard, const Key& key, uint64_t hash) const {
+        const size_t found = FindIndex(shard, key, hash);
+        if (found != NOT_FOUND) {
+            return *shard.slots[found];
+        }
+        if ((shard.size + 1) * 4 > shard.slots.size() * 3) {
+            Grow(shard);
+        }
+        const size_t mask = shard.slots.size() - 1;
+        size_t index = hash & mask;
+        while (shard.slots[index]) {
+            index = (index + 1) & mask;
+        }
+        ++shard.size;
+        return shard.slots[index].emplace(key, Value());
+    }
+
+    void Grow(Shard& shard) const {
+        std::pmr::vector<Slot> slots(std::max(INITIAL_CAPACITY, shard.slots.size() * 2),
+            shard.slots.get_allocator());
+        const size_t mask = slots.size() - 1;
+        for (Slot& slot : shard.slots) {
+            if (slot) {
+                size_t index = ComputeHash(slot->first) & mask;
+                while (slots[index]) {
+                    index = (index + 1) & mask;
+                }
+                slots[index] = std::move(slot);
+            }
+        }
+        shard.slots = std::move(slots);
+    }
+
+    Hash hash_;
+    std::pmr::polymorphic_allocator<Shard> allocator_;
+    size_t shard_count_;
+    Shard* shards_;
+};
@@ -0,0 +1,270 @@
+#include "corpus_loader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <execution>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::string_view STATUS_NAMES[] = { "ACTUAL", "IRRELEVANT", "BANNED", "REMOVED" };
+
+struct ParsedDocument {
+    int id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::string_view text;
+    // Номер строки внутри части, с нуля
+    size_t line = 0;
+};
+
+struct ParsedChunk {
+    std::vector<ParsedDocument> documents;
+    size_t line_count = 0;
+    // Первая неразобранная строка: документы после неё не разбираются, если строки не пропускаются
+    std::string error;
+    size_t error_line = 0;
+    size_t skipped_lines = 0;
+};
+
+std::string_view NextField(std::string_view& line) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string_view::npos) {
+        throw std::invalid_argument(std::string("expected tab-separated id, status, ratings and text"));
+    }
+    const std::string_view field = line.substr(0, tab);
+    line.remove_prefix(tab + 1);
+    return field;
+}
+
+int ParseInt(std::string_view text, const char* what) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || text.empty()) {
+        throw std::invalid_argument(std::string("invalid ") + what + std::string(" '") + std::string(text)
+            + std::string("'"));
+    }
+    return value;
+}
+
+ParsedDocument ParseLine(std::string_view line) {
+    ParsedDocument document;
+    document.id = ParseInt(NextField(line), "document id");
+    const std::string_view status = NextField(line);
+    const auto status_it = std::find(std::begin(STATUS_NAMES), std::end(STATUS_NAMES), status);
+    if (status_it == std::end(STATUS_NAMES)) {
+        throw std::invalid_argument(std::string("unknown status '") + std::string(status) + std::string("'"));
+    }
+    document.status = static_cast<DocumentStatus>(status_it - std::begin(STATUS_NAMES));
+    std::string_view ratings = NextField(line);
+    while (!ratings.empty()) {
+        const size_t space = std::min(ratings.find(' '), ratings.size());
+        if (space > 0) {
+            document.ratings.push_back(ParseInt(ratings.substr(0, space), "rating"));
+        }
+        ratings.remove_prefix(std::min(space + 1, ratings.size()));
+    }
+    document.text = line;
+    return document;
+}
+
+ParsedChunk ParseChunk(std::string_view chunk, bool skip_invalid) {
+    ParsedChunk result;
+    while (!chunk.empty()) {
+        const size_t newline = std::min(chunk.find('\n'), chunk.size());
+        std::string_view line = chunk.substr(0, newline);
+        chunk.remove_prefix(std::min(newline + 1, chunk.size()));
+        const size_t line_index = result.line_count++;
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        try {
+            result.documents.push_back(ParseLine(line));
+            result.documents.back().line = line_index;
+        }
+        catch (const std::invalid_argument& e) {
+            if (!skip_invalid) {
+                result.error = e.what();
+                result.error_line = line_index;
+                break;
+            }
+            ++result.skipped_lines;
+        }
+    }
+    return result;
+}
+
+// Части заканчиваются переводом строки или концом данных
+std::vector<std::string_view> SplitIntoChunks(std::string_view data, size_t chunk_size) {
+    std::vector<std::string_view> chunks;
+    while (!data.empty()) {
+        size_t end = std::min(std::max<size_t>(chunk_size, 1), data.size());
+        const size_t newline = data.find('\n', end - 1);
+        end = newline == std::string_view::npos ? data.size() : newline + 1;
+        chunks.push_back(data.substr(0, end));
+        data.remove_prefix(end);
+    }
+    return chunks;
+}
+
+std::invalid_argument MakeLineError(size_t line, const std::string& message) {
+    return std::invalid_argument(std::string("Corpus line ") + std::to_string(line + 1) + std::string(": ") + message);
+}
+
+// Отображение файла в память только для чтения
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw MakeSystemError(std::string("Cannot open corpus"), path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            const auto error = MakeSystemError(std::string("Cannot stat corpus"), path);
+            ::close(fd);
+            throw error;
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        // Пустой файл отобразить нельзя
+        if (size_ > 0) {
+            data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (data_ == MAP_FAILED) {
+            throw MakeSystemError(std::string("Cannot map corpus"), path);
+        }
+        if (size_ > 0) {
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (size_ > 0) {
+            ::munmap(data_, size_);
+        }
+    }
+
+    std::string_view GetData() const {
+        return size_ > 0 ? std::string_view(static_cast<const char*>(data_), size_) : std::string_view();
+    }
+
+private:
+    static std::runtime_error MakeSystemError(const std::string& action, const std::string& path) {
+        return std::runtime_error(action + std::string(" ") + path + std::string(": ") + std::strerror(errno));
+    }
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace
+
+double CorpusLoadStats::GetDocumentsPerSecond() const {
+    const double seconds = std::chrono::duration<double>(total_time).count();
+    return seconds > 0.0 ? static_cast<double>(documents) / seconds : 0.0;
+}
+
+double CorpusLoadStats::GetMegabytesPerSecond() const {
+    const double seconds = std::chrono::duration<double>(total_time).count();
+    return seconds > 0.0 ? static_cast<double>(bytes) / (1 << 20) / seconds : 0.0;
+}
+
+CorpusLoadStats LoadCorpus(SearchServer& search_server, std::string_view data, const CorpusLoadOptions& options) {
+    const auto start = Clock::now();
+    CorpusLoadStats stats;
+    stats.bytes = data.size();
+    const std::vector<std::string_view> chunks = SplitIntoChunks(data, options.chunk_size);
+    const size_t wave_size = options.parallel_chunks > 0 ? options.parallel_chunks
+        : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    // Следующая волна частей разбирается в фоне, пока документы текущей добавляются в индекс
+    const auto parse_wave = [&chunks, &options, &stats, wave_size](size_t first) {
+        const auto parse_start = Clock::now();
+        const size_t last = std::min(first + wave_size, chunks.size());
+        std::vector<ParsedChunk> result(last - first);
+        std::transform(std::execution::par, chunks.begin() + first, chunks.begin() + last, result.begin(),
+            [&options](std::string_view chunk) { return ParseChunk(chunk, options.skip_invalid_documents); });
+        stats.parse_time += Clock::now() - parse_start;
+        return result;
+    };
+
+    // Фоновый разбор ссылается на stats и chunks: деструктор future ждёт его и при исключении
+    size_t first_line = 0;
+    std::future<std::vector<ParsedChunk>> next_wave;
+    if (!chunks.empty()) {
+        next_wave = std::async(std::launch::async, parse_wave, size_t(0));
+    }
+    for (size_t first = 0; first < chunks.size(); first += wave_size) {
+        std::vector<ParsedChunk> wave = next_wave.get();
+        if (first + wave_size < chunks.size()) {
+            next_wave = std::async(std::launch::async, parse_wave, first + wave_size);
+        }
+        const auto index_start = Clock::now();
+        for (ParsedChunk& chunk : wave) {
+            for (const ParsedDocument& document : chunk.documents) {
+                try {
+                    search_server.AddDocument(document.id, document.text, document.status, document.ratings);
+                    ++stats.documents;
+                }
+                catch (const std::invalid_argument& e) {
+                    if (!options.skip_invalid_documents) {
+                        throw MakeLineError(first_line + document.line, e.what());
+                    }
+                    ++stats.skipped;
+                }
+            }
+            if (!chunk.error.empty()) {
+                throw MakeLineError(first_line + chunk.error_line, chunk.error);
+            }
+            stats.skipped += chunk.skipped_lines;
+            first_line += chunk.line_count;
+        }
+        stats.index_time += Clock::now() - index_start;
+    }
+    stats.total_time = Clock::now() - start;
+    return stats;
+}
+
+CorpusLoadStats LoadCorpusFile(SearchServer& search_server, const std::string& path,
+    const CorpusLoadOptions& options) {
+    const MappedFile file(path);
+    return LoadCorpus(search_server, file.GetData(), options);
+}
+
+void AppendCorpusLine(std::string& output, int document_id, DocumentStatus status, const std::vector<int>& ratings,
+    std::string_view text) {
+    if (text.find('\n') != std::string_view::npos) {
+        throw std::invalid_argument(std::string("Corpus document text must not contain line breaks"));
+    }
+    output += std::to_string(document_id);
+    output += '\t';
+    output += STATUS_NAMES[static_cast<int>(status)];
+    output += '\t';
+    for (size_t i = 0; i < ratings.size(); ++i) {
+        if (i > 0) {
+            output += ' ';
+        }
+        output += std::to_string(ratings[i]);
+    }
+    output += '\t';
+    output += text;
+    output += '\n';
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search_server.h"
+
+// Формат корпуса: документ на строку, поля через табуляцию -
+// id, статус (ACTUAL, IRRELEVANT, BANNED, REMOVED), рейтинги через пробел (может быть пусто), текст до конца строки.
+// Пустые строки и строки, начинающиеся с '#', пропускаются; "\r" в конце строки отбрасывается
+
+struct CorpusLoadOptions {
+    // Файл режется на части примерно такого размера по границам строк; части разбираются параллельно
+    size_t chunk_size = 4 << 20;
+    // Сколько частей разбирается одновременно, пока предыдущие добавляются в индекс; 0 - по числу ядер
+    size_t parallel_chunks = 0;
+    // Пропускать строки, которые не разбираются или не принимает AddDocument, вместо исключения
+    bool skip_invalid_documents = false;
+};
+
+struct CorpusLoadStats {
+    size_t documents = 0;
+    size_t skipped = 0;
+    size_t bytes = 0;
+    // Разбор идёт одновременно с индексацией, поэтому parse_time и index_time в сумме могут превышать total_time
+    std::chrono::nanoseconds parse_time{ 0 };
+    std::chrono::nanoseconds index_time{ 0 };
+    std::chrono::nanoseconds total_time{ 0 };
+
+    double GetDocumentsPerSecond() const;
+    double GetMegabytesPerSecond() const;
+};
+
+// Добавляет документы корпуса в порядке строк. Текст передаётся в AddDocument ссылкой на data без копирования.
+// Ошибка строки - std::invalid_argument с номером строки; документы до неё остаются в индексе
+CorpusLoadStats LoadCorpus(SearchServer& search_server, std::string_view data,
+    const CorpusLoadOptions& options = CorpusLoadOptions{});
+
+// То же для файла, отображённого в память. Ошибка открытия или отображения - std::runtime_error
+CorpusLoadStats LoadCorpusFile(SearchServer& search_server, const std::string& path,
+    const CorpusLoadOptions& options = CorpusLoadOptions{});
+
+// Дописывает строку корпуса. Текст с переводом строки - std::invalid_argument
+void AppendCorpusLine(std::string& output, int document_id, DocumentStatus status, const std::vector<int>& ratings,
+    std::string_view text);
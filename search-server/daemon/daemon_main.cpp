@@ -0,0 +1,134 @@
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <pthread.h>
+
+#include "../benchmark/corpus_generator.h"
+#include "../snapshot.h"
+#include "query_daemon.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct DaemonOptions {
+    std::string endpoint = "unix:/tmp/search_server.sock"s;
+    // Снимок индекса; без него индекс - синтетический корпус генератора бенчмарка
+    std::string snapshot_path;
+    size_t synthetic_size = 100000;
+    uint64_t seed = 42;
+    QueryDaemonOptions daemon;
+};
+
+void PrintUsage() {
+    std::cerr << "Usage: search_server_daemon [--listen unix:PATH|tcp:HOST:PORT] [--snapshot FILE | --synthetic N]"
+        " [--seed N] [--batch N] [--batch-delay-us N] [--max-pending N]"s << std::endl;
+    std::cerr << "The synthetic corpus matches search_server_benchmark and search_server_load with the same seed."
+        " SIGINT or SIGTERM stops the daemon after answering the requests already read."s << std::endl;
+}
+
+DaemonOptions ParseOptions(int argc, char** argv) {
+    DaemonOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--help"s) {
+            PrintUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for "s + argument);
+        }
+        const std::string value = argv[++i];
+        if (argument == "--listen"s) {
+            options.endpoint = value;
+        }
+        else if (argument == "--snapshot"s) {
+            options.snapshot_path = value;
+        }
+        else if (argument == "--synthetic"s) {
+            options.synthetic_size = std::stoull(value);
+        }
+        else if (argument == "--seed"s) {
+            options.seed = std::stoull(value);
+        }
+        else if (argument == "--batch"s) {
+            options.daemon.max_batch_size = std::stoull(value);
+        }
+        else if (argument == "--batch-delay-us"s) {
+            options.daemon.batch_delay = std::chrono::microseconds(std::stoll(value));
+        }
+        else if (argument == "--max-pending"s) {
+            options.daemon.max_pending_requests = std::stoull(value);
+        }
+        else {
+            throw std::invalid_argument("Unknown option "s + argument);
+        }
+    }
+    return options;
+}
+
+std::unique_ptr<SearchServer> LoadIndex(const DaemonOptions& options) {
+    if (!options.snapshot_path.empty()) {
+        std::ifstream input(options.snapshot_path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("Cannot open "s + options.snapshot_path);
+        }
+        return std::make_unique<SearchServer>(ReadSnapshot(input));
+    }
+    CorpusOptions corpus_options;
+    corpus_options.seed = options.seed;
+    CorpusGenerator generator(corpus_options);
+    auto server = std::make_unique<SearchServer>(generator.GetStopWordsText());
+    for (size_t id = 0; id < options.synthetic_size; ++id) {
+        server->AddDocument(static_cast<int>(id), generator.GenerateDocument(), generator.GenerateStatus(),
+            generator.GenerateRatings());
+    }
+    return server;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const DaemonOptions options = ParseOptions(argc, argv);
+        // Сигналы остановки принимает отдельный поток: маска наследуется всеми потоками демона
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        const auto server = LoadIndex(options);
+        QueryDaemon daemon(*server, options.endpoint, options.daemon);
+        std::thread signal_waiter([&daemon, &signals] {
+            int signal = 0;
+            sigwait(&signals, &signal);
+            daemon.Stop();
+        });
+
+        std::cerr << "Serving "s << server->GetDocumentCount() << " documents on "s << options.endpoint;
+        if (const uint16_t port = daemon.GetPort()) {
+            std::cerr << " (port "s << port << ')';
+        }
+        std::cerr << std::endl;
+        daemon.Run();
+        // Run мог завершиться и без сигнала: поток ожидания будится, чтобы его можно было дождаться
+        pthread_kill(signal_waiter.native_handle(), SIGTERM);
+        signal_waiter.join();
+
+        const QueryDaemonStats stats = daemon.GetStats();
+        std::cerr << "Connections: "s << stats.connections << ", requests: "s << stats.requests
+            << ", batches: "s << stats.batches << ", failed: "s << stats.failed_requests << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        PrintUsage();
+        return 1;
+    }
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../benchmark/benchmark_report.h"
+#include "../benchmark/corpus_generator.h"
+#include "query_client.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct LoadOptions {
+    std::string endpoint = "unix:/tmp/search_server.sock"s;
+    size_t connections = 4;
+    // Запросов соединения, отправленных без ответа
+    size_t pipeline_depth = 16;
+    size_t request_count = 100000;
+    size_t query_count = 10000;
+    uint64_t seed = 42;
+    // Только для отчёта: размер корпуса, загруженного в демон
+    size_t corpus_size = 0;
+    std::string label = "local"s;
+    std::string output_path;
+};
+
+void PrintUsage() {
+    std::cerr << "Usage: search_server_load [--connect unix:PATH|tcp:HOST:PORT] [--connections N] [--pipeline N]"
+        " [--requests N] [--queries N] [--seed N] [--corpus N] [--label TEXT] [--output FILE]"s << std::endl;
+    std::cerr << "Queries come from the synthetic corpus generator; use the daemon's --seed for matching words."
+        " Latency is measured from sending a request to receiving its response."s << std::endl;
+}
+
+LoadOptions ParseOptions(int argc, char** argv) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        if (argument == "--help"s) {
+            PrintUsage();
+            std::exit(0);
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for "s + argument);
+        }
+        const std::string value = argv[++i];
+        if (argument == "--connect"s) {
+            options.endpoint = value;
+        }
+        else if (argument == "--connections"s) {
+            options.connections = std::stoull(value);
+        }
+        else if (argument == "--pipeline"s) {
+            options.pipeline_depth = std::stoull(value);
+        }
+        else if (argument == "--requests"s) {
+            options.request_count = std::stoull(value);
+        }
+        else if (argument == "--queries"s) {
+            options.query_count = std::stoull(value);
+        }
+        else if (argument == "--seed"s) {
+            options.seed = std::stoull(value);
+        }
+        else if (argument == "--corpus"s) {
+            options.corpus_size = std::stoull(value);
+        }
+        else if (argument == "--label"s) {
+            options.label = value;
+        }
+        else if (argument == "--output"s) {
+            options.output_path = value;
+        }
+        else {
+            throw std::invalid_argument("Unknown option "s + argument);
+        }
+    }
+    if (options.connections == 0 || options.pipeline_depth == 0 || options.query_count == 0) {
+        throw std::invalid_argument("Connections, pipeline depth and query count must be positive"s);
+    }
+    return options;
+}
+
+struct ConnectionResult {
+    std::vector<LatencyRecorder::Clock::duration> latencies;
+    size_t failed = 0;
+};
+
+// Держит pipeline_depth запросов в полёте: на каждый ответ отправляется следующий запрос
+ConnectionResult RunConnection(const LoadOptions& options, const std::vector<std::string>& queries,
+    size_t first_request, size_t request_count) {
+    QueryClient client(options.endpoint);
+    std::vector<LatencyRecorder::Clock::time_point> sent(request_count);
+    ConnectionResult result;
+    result.latencies.reserve(request_count);
+    size_t next = 0;
+    const auto send_next = [&]() {
+        DaemonRequest request;
+        request.request_id = static_cast<uint32_t>(next);
+        request.query = queries[(first_request + next) % queries.size()];
+        sent[next++] = LatencyRecorder::Clock::now();
+        client.Send(request);
+    };
+    while (next < std::min(options.pipeline_depth, request_count)) {
+        send_next();
+    }
+    for (size_t received = 0; received < request_count; ++received) {
+        const DaemonResponse response = client.Receive();
+        if (response.request_id >= next) {
+            throw std::runtime_error("Response to a request that was not sent: "s + std::to_string(response.request_id));
+        }
+        result.latencies.push_back(LatencyRecorder::Clock::now() - sent[response.request_id]);
+        if (response.code != DaemonResponseCode::OK) {
+            ++result.failed;
+        }
+        if (next < request_count) {
+            send_next();
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    try {
+        const LoadOptions options = ParseOptions(argc, argv);
+        CorpusOptions corpus_options;
+        corpus_options.seed = options.seed;
+        CorpusGenerator generator(corpus_options);
+        std::vector<std::string> queries;
+        for (size_t i = 0; i < options.query_count; ++i) {
+            queries.push_back(generator.GenerateQuery(3, generator.NextIndex(10) < 3 ? 1 : 0));
+        }
+
+        std::vector<ConnectionResult> results(options.connections);
+        std::vector<std::thread> threads;
+        std::mutex error_mutex;
+        std::string error;
+        const auto start = LatencyRecorder::Clock::now();
+        for (size_t i = 0; i < options.connections; ++i) {
+            const size_t first = options.request_count * i / options.connections;
+            const size_t count = options.request_count * (i + 1) / options.connections - first;
+            threads.emplace_back([&, i, first, count] {
+                try {
+                    results[i] = RunConnection(options, queries, first, count);
+                }
+                catch (const std::exception& e) {
+                    std::lock_guard guard(error_mutex);
+                    error = e.what();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const std::chrono::duration<double> elapsed = LatencyRecorder::Clock::now() - start;
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        LatencyRecorder latencies;
+        size_t failed = 0;
+        for (const ConnectionResult& result : results) {
+            for (const auto latency : result.latencies) {
+                latencies.Record(latency);
+            }
+            failed += result.failed;
+        }
+        std::ofstream file;
+        if (!options.output_path.empty()) {
+            file.open(options.output_path);
+            if (!file) {
+                throw std::runtime_error("Cannot open "s + options.output_path);
+            }
+        }
+        BenchmarkReporter reporter(options.output_path.empty() ? std::cout : file, options.label);
+        // throughput_ops отчёта считается по сумме задержек и при конвейере не равен QPS: qps - по времени прогона
+        reporter.Report(options.corpus_size, "Daemon/FindTopDocuments"s, latencies,
+            { { "connections"s, static_cast<double>(options.connections) },
+              { "pipeline_depth"s, static_cast<double>(options.pipeline_depth) },
+              { "qps"s, static_cast<double>(latencies.GetCount()) / elapsed.count() },
+              { "failed"s, static_cast<double>(failed) } });
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        PrintUsage();
+        return 1;
+    }
+}
@@ -0,0 +1,103 @@
+#include "protocol.h"
+
+#include <stdexcept>
+
+#include "../binary_io.h"
+
+namespace {
+
+// Длина кадра записывается после нагрузки, когда та уже в буфере
+template <typename WritePayload>
+void AppendFrame(std::string& buffer, WritePayload write_payload) {
+    const size_t header = buffer.size();
+    BinaryWriter writer(buffer);
+    writer.WriteUint32(0);
+    write_payload(writer);
+    std::string length;
+    BinaryWriter(length).WriteUint32(static_cast<uint32_t>(buffer.size() - header - sizeof(uint32_t)));
+    buffer.replace(header, sizeof(uint32_t), length);
+}
+
+void CheckEnd(const BinaryReader& reader) {
+    if (!reader.IsEnd()) {
+        throw std::runtime_error(std::string("Unexpected data at the end of frame"));
+    }
+}
+
+}  // namespace
+
+void AppendRequestFrame(std::string& buffer, const DaemonRequest& request) {
+    AppendFrame(buffer, [&request](BinaryWriter& writer) {
+        writer.WriteUint32(request.request_id);
+        writer.WriteUint8(static_cast<uint8_t>(request.type));
+        writer.WriteUint8(static_cast<uint8_t>(request.status));
+        writer.WriteString(request.query);
+    });
+}
+
+void AppendResponseFrame(std::string& buffer, const DaemonResponse& response) {
+    AppendFrame(buffer, [&response](BinaryWriter& writer) {
+        writer.WriteUint32(response.request_id);
+        writer.WriteUint8(static_cast<uint8_t>(response.code));
+        if (response.code == DaemonResponseCode::OK) {
+            writer.WriteUint32(static_cast<uint32_t>(response.documents.size()));
+            for (const Document& document : response.documents) {
+                writer.WriteInt32(document.id);
+                writer.WriteDouble(document.relevance);
+                writer.WriteInt32(document.rating);
+            }
+        }
+        else {
+            writer.WriteString(response.message);
+        }
+    });
+}
+
+DaemonRequest ParseDaemonRequest(std::string_view payload) {
+    BinaryReader reader(payload);
+    DaemonRequest request;
+    request.request_id = reader.ReadUint32();
+    const uint8_t type = reader.ReadUint8();
+    if (type != static_cast<uint8_t>(DaemonRequestType::FIND_TOP_DOCUMENTS)) {
+        throw std::runtime_error(std::string("Unknown request type ") + std::to_string(type));
+    }
+    request.type = static_cast<DaemonRequestType>(type);
+    const uint8_t status = reader.ReadUint8();
+    if (status > static_cast<uint8_t>(DocumentStatus::REMOVED)) {
+        throw std::runtime_error(std::string("Unknown document status ") + std::to_string(status));
+    }
+    request.status = static_cast<DocumentStatus>(status);
+    request.query = std::string(reader.ReadString());
+    CheckEnd(reader);
+    return request;
+}
+
+DaemonResponse ParseDaemonResponse(std::string_view payload) {
+    BinaryReader reader(payload);
+    DaemonResponse response;
+    response.request_id = reader.ReadUint32();
+    const uint8_t code = reader.ReadUint8();
+    if (code > static_cast<uint8_t>(DaemonResponseCode::INTERNAL_ERROR)) {
+        throw std::runtime_error(std::string("Unknown response code ") + std::to_string(code));
+    }
+    response.code = static_cast<DaemonResponseCode>(code);
+    if (response.code == DaemonResponseCode::OK) {
+        const uint32_t count = reader.ReadUint32();
+        // Документ занимает 16 байт: размер проверяется до выделения памяти
+        if (count > payload.size() / 16) {
+            throw std::runtime_error(std::string("Document count exceeds frame size"));
+        }
+        response.documents.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            const int id = reader.ReadInt32();
+            const double relevance = reader.ReadDouble();
+            const int rating = reader.ReadInt32();
+            response.documents.emplace_back(id, relevance, rating);
+        }
+    }
+    else {
+        response.message = std::string(reader.ReadString());
+    }
+    CheckEnd(reader);
+    return response;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../document.h"
+
+// Протокол демона. Кадр - длина полезной нагрузки (uint32) и сама нагрузка; числа в little-endian (binary_io.h).
+// Клиент может отправлять запросы, не дожидаясь ответов: ответы соединения приходят в порядке запросов,
+// и каждый несёт request_id своего запроса.
+// Запрос:  request_id (uint32), тип (uint8), статус документов (uint8), запрос (uint32 длина + байты).
+// Ответ:   request_id (uint32), код (uint8); при OK - число документов (uint32) и для каждого
+//          id (int32), релевантность (double), рейтинг (int32), иначе - сообщение об ошибке (строка)
+
+constexpr uint32_t DEFAULT_MAX_FRAME_SIZE = 1 << 20;
+
+enum class DaemonRequestType : uint8_t {
+    FIND_TOP_DOCUMENTS = 1,
+};
+
+enum class DaemonResponseCode : uint8_t {
+    OK = 0,
+    // FindTopDocuments отклонил запрос (std::invalid_argument)
+    INVALID_QUERY = 1,
+    // Кадр не разбирается как запрос
+    BAD_REQUEST = 2,
+    INTERNAL_ERROR = 3,
+};
+
+struct DaemonRequest {
+    uint32_t request_id = 0;
+    DaemonRequestType type = DaemonRequestType::FIND_TOP_DOCUMENTS;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::string query;
+};
+
+struct DaemonResponse {
+    uint32_t request_id = 0;
+    DaemonResponseCode code = DaemonResponseCode::OK;
+    std::vector<Document> documents;
+    std::string message;
+};
+
+// Дописывают кадр в конец буфера
+void AppendRequestFrame(std::string& buffer, const DaemonRequest& request);
+void AppendResponseFrame(std::string& buffer, const DaemonResponse& response);
+
+// Разбирают полезную нагрузку кадра. Бросают std::runtime_error, если она повреждена
+DaemonRequest ParseDaemonRequest(std::string_view payload);
+DaemonResponse ParseDaemonResponse(std::string_view payload);
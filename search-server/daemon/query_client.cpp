@@ -0,0 +1,28 @@
+#include "query_client.h"
+
+#include <stdexcept>
+
+QueryClient::QueryClient(const std::string& endpoint, uint32_t max_frame_size)
+    : socket_(ConnectTo(endpoint))
+    , reader_(socket_, max_frame_size) {
+}
+
+void QueryClient::Send(const DaemonRequest& request) {
+    AppendRequestFrame(pending_, request);
+}
+
+void QueryClient::Flush() {
+    socket_.SendAll(pending_);
+    pending_.clear();
+}
+
+DaemonResponse QueryClient::Receive() {
+    if (!pending_.empty()) {
+        Flush();
+    }
+    std::string_view payload;
+    if (!reader_.ReadFrame(payload)) {
+        throw std::runtime_error(std::string("Connection closed by the daemon"));
+    }
+    return ParseDaemonResponse(payload);
+}
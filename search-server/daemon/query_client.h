@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "protocol.h"
+#include "socket_io.h"
+
+// Клиент демона запросов. Запросы копятся в буфере и уходят одной записью при Flush или Receive,
+// поэтому можно отправить несколько запросов и только потом читать ответы
+class QueryClient {
+public:
+    explicit QueryClient(const std::string& endpoint, uint32_t max_frame_size = DEFAULT_MAX_FRAME_SIZE);
+
+    void Send(const DaemonRequest& request);
+    void Flush();
+    // Следующий ответ в порядке отправки запросов. Закрытое демоном соединение - std::runtime_error
+    DaemonResponse Receive();
+
+private:
+    Socket socket_;
+    FrameReader reader_;
+    std::string pending_;
+};
@@ -0,0 +1,295 @@
+#include "query_daemon.h"
+
+#include <algorithm>
+#include <execution>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../binary_io.h"
+
+QueryDaemon::Connection::Connection(Socket connection_socket)
+    : socket(std::move(connection_socket)) {
+}
+
+QueryDaemon::QueryDaemon(const SearchServer& search_server, const std::string& endpoint,
+    const QueryDaemonOptions& options)
+    : search_server_(search_server)
+    , endpoint_(endpoint)
+    , options_(options)
+    , listener_(ListenOn(endpoint))
+{
+    if (options_.max_batch_size == 0 || options_.max_pending_requests == 0) {
+        throw std::invalid_argument(std::string("Batch size and queue length must be positive"));
+    }
+}
+
+QueryDaemon::~QueryDaemon() {
+    if (endpoint_.compare(0, 5, "unix:") == 0) {
+        ::unlink(endpoint_.c_str() + 5);
+    }
+}
+
+uint16_t QueryDaemon::GetPort() const {
+    return GetLocalPort(listener_);
+}
+
+void QueryDaemon::Run() {
+    std::thread dispatcher([this] { Dispatch(); });
+    while (!stopping_) {
+        Socket socket = AcceptOn(listener_);
+        if (!socket.IsOpen()) {
+            break;
+        }
+        ++connection_count_;
+        JoinFinishedReaders();
+        socket.SetSendTimeout(options_.send_timeout);
+        auto connection = std::make_shared<Connection>(std::move(socket));
+        std::lock_guard guard(connections_mutex_);
+        // Stop мог пройти по списку соединений до вставки нового
+        if (stopping_) {
+            break;
+        }
+        connections_.emplace_back(connection, std::thread([this, connection] { ServeConnection(connection); }));
+    }
+
+    // Чтение прекращается, но ответы на прочитанные запросы ещё отправляются
+    {
+        std::lock_guard guard(connections_mutex_);
+        for (auto& [connection, reader] : connections_) {
+            connection->socket.Shutdown(SHUT_RD);
+        }
+    }
+    for (auto& [connection, reader] : connections_) {
+        reader.join();
+    }
+    {
+        std::lock_guard guard(queue_mutex_);
+        readers_done_ = true;
+    }
+    queue_not_empty_.notify_all();
+    dispatcher.join();
+    std::lock_guard guard(connections_mutex_);
+    connections_.clear();
+}
+
+void QueryDaemon::Stop() {
+    stopping_ = true;
+    listener_.Shutdown(SHUT_RDWR);
+    {
+        std::lock_guard guard(connections_mutex_);
+        for (auto& [connection, reader] : connections_) {
+            connection->socket.Shutdown(SHUT_RD);
+        }
+    }
+    // Читатели могут ждать места в очереди
+    queue_not_full_.notify_all();
+}
+
+QueryDaemonStats QueryDaemon::GetStats() const {
+    QueryDaemonStats stats;
+    stats.connections = connection_count_;
+    stats.requests = request_count_;
+    stats.batches = batch_count_;
+    stats.failed_requests = failed_count_;
+    stats.dropped_connections = dropped_count_;
+    return stats;
+}
+
+void QueryDaemon::ServeConnection(const std::shared_ptr<Connection>& connection) {
+    std::thread writer([this, connection] { WriteConnection(*connection); });
+    ReadConnection(connection);
+    {
+        std::lock_guard guard(connection->output_mutex);
+        connection->reading_done = true;
+    }
+    connection->output_ready.notify_one();
+    // Поток записи завершается, когда отправит ответы на все прочитанные запросы
+    writer.join();
+    connection->finished = true;
+}
+
+void QueryDaemon::ReadConnection(const std::shared_ptr<Connection>& connection) {
+    try {
+        FrameReader reader(connection->socket, options_.max_frame_size);
+        std::string_view payload;
+        while (!stopping_ && reader.ReadFrame(payload)) {
+            PendingRequest pending;
+            pending.connection = connection;
+            pending.arrival = std::chrono::steady_clock::now();
+            try {
+                pending.request = ParseDaemonRequest(payload);
+            }
+            catch (const std::exception& e) {
+                // Ответ на неразобранный кадр несёт request_id, если его удалось прочитать
+                if (payload.size() >= sizeof(uint32_t)) {
+                    pending.request.request_id = BinaryReader(payload).ReadUint32();
+                }
+                pending.error = e.what();
+            }
+            Enqueue(std::move(pending));
+        }
+    }
+    catch (const std::exception&) {
+        // Слишком длинный или оборванный кадр: соединение закрывается без ответа на него
+        connection->socket.Shutdown(SHUT_RDWR);
+    }
+}
+
+void QueryDaemon::WriteConnection(Connection& connection) {
+    std::string chunk;
+    std::unique_lock lock(connection.output_mutex);
+    while (true) {
+        connection.output_ready.wait(lock, [&connection] {
+            return !connection.output.empty() || connection.broken
+                || (connection.reading_done && connection.unanswered == 0);
+            });
+        if (connection.output.empty() || connection.broken) {
+            return;
+        }
+        // Ответы, пришедшие во время отправки, уйдут следующей записью
+        chunk.swap(connection.output);
+        lock.unlock();
+        bool sent = true;
+        try {
+            connection.socket.SendAll(chunk);
+        }
+        catch (const std::exception&) {
+            // Клиент закрыл соединение или не принимал данные дольше send_timeout
+            sent = false;
+        }
+        chunk.clear();
+        lock.lock();
+        if (!sent) {
+            connection.broken = true;
+            connection.output.clear();
+            connection.socket.Shutdown(SHUT_RDWR);
+            return;
+        }
+    }
+}
+
+void QueryDaemon::PostResponses(Connection& connection, std::string&& frames, size_t count) {
+    {
+        std::lock_guard guard(connection.output_mutex);
+        connection.unanswered -= count;
+        if (connection.broken) {
+            return;
+        }
+        if (connection.output.size() + frames.size() > options_.max_output_bytes) {
+            // Клиент шлёт запросы, но не читает ответы: его соединение закрывается, читатель и
+            // поток записи просыпаются от Shutdown
+            connection.broken = true;
+            connection.output.clear();
+            connection.socket.Shutdown(SHUT_RDWR);
+            ++dropped_count_;
+        }
+        else if (connection.output.empty()) {
+            connection.output = std::move(frames);
+        }
+        else {
+            connection.output += frames;
+        }
+    }
+    connection.output_ready.notify_one();
+}
+
+void QueryDaemon::Enqueue(PendingRequest&& request) {
+    {
+        std::lock_guard guard(request.connection->output_mutex);
+        ++request.connection->unanswered;
+    }
+    std::unique_lock lock(queue_mutex_);
+    queue_not_full_.wait(lock, [this] { return queue_.size() < options_.max_pending_requests || stopping_; });
+    queue_.push_back(std::move(request));
+    const bool was_empty = queue_.size() == 1;
+    const bool batch_ready = queue_.size() == options_.max_batch_size;
+    lock.unlock();
+    if (was_empty || batch_ready) {
+        queue_not_empty_.notify_one();
+    }
+}
+
+void QueryDaemon::Dispatch() {
+    std::vector<PendingRequest> batch;
+    std::vector<std::string> frames;
+    while (true) {
+        {
+            std::unique_lock lock(queue_mutex_);
+            queue_not_empty_.wait(lock, [this] { return !queue_.empty() || readers_done_; });
+            if (queue_.empty()) {
+                return;
+            }
+            // Пачка набирается не дольше batch_delay с прихода её первого запроса
+            queue_not_empty_.wait_until(lock, queue_.front().arrival + options_.batch_delay,
+                [this] { return queue_.size() >= options_.max_batch_size || readers_done_; });
+            const size_t size = std::min(queue_.size(), options_.max_batch_size);
+            batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + size));
+            queue_.erase(queue_.begin(), queue_.begin() + size);
+        }
+        queue_not_full_.notify_all();
+
+        frames.assign(batch.size(), std::string());
+        std::transform(std::execution::par, batch.begin(), batch.end(), frames.begin(),
+            [this](const PendingRequest& pending) {
+                std::string frame;
+                AppendResponseFrame(frame, Execute(pending));
+                return frame;
+            });
+        ++batch_count_;
+        request_count_ += batch.size();
+
+        // Ответы одного соединения, идущие в пачке подряд, передаются потоку записи вместе
+        for (size_t begin = 0; begin < batch.size();) {
+            size_t end = begin + 1;
+            while (end < batch.size() && batch[end].connection == batch[begin].connection) {
+                frames[begin] += frames[end];
+                ++end;
+            }
+            PostResponses(*batch[begin].connection, std::move(frames[begin]), end - begin);
+            begin = end;
+        }
+        batch.clear();
+    }
+}
+
+DaemonResponse QueryDaemon::Execute(const PendingRequest& pending) {
+    DaemonResponse response;
+    response.request_id = pending.request.request_id;
+    if (!pending.error.empty()) {
+        response.code = DaemonResponseCode::BAD_REQUEST;
+        response.message = pending.error;
+        ++failed_count_;
+        return response;
+    }
+    try {
+        response.documents = search_server_.FindTopDocuments(pending.request.query, pending.request.status);
+    }
+    catch (const std::invalid_argument& e) {
+        response.code = DaemonResponseCode::INVALID_QUERY;
+        response.message = e.what();
+    }
+    catch (const std::exception& e) {
+        response.code = DaemonResponseCode::INTERNAL_ERROR;
+        response.message = e.what();
+    }
+    if (response.code != DaemonResponseCode::OK) {
+        ++failed_count_;
+    }
+    return response;
+}
+
+void QueryDaemon::JoinFinishedReaders() {
+    std::lock_guard guard(connections_mutex_);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        if (it->first->finished) {
+            it->second.join();
+            it = connections_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
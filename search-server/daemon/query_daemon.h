@@ -0,0 +1,122 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "../search_server.h"
+#include "protocol.h"
+#include "socket_io.h"
+
+struct QueryDaemonOptions {
+    // Запросы, пришедшие за batch_delay после первого запроса пачки, выполняются вместе параллельно,
+    // как в ProcessQueries, но не больше max_batch_size за раз
+    size_t max_batch_size = 64;
+    std::chrono::microseconds batch_delay{ 200 };
+    // Когда в очереди столько запросов, соединения перестают читаться
+    size_t max_pending_requests = 4096;
+    uint32_t max_frame_size = DEFAULT_MAX_FRAME_SIZE;
+    // Соединение закрывается, если неотправленные ответы занимают больше max_output_bytes
+    // или клиент не принимает данные дольше send_timeout
+    size_t max_output_bytes = 16 * 1024 * 1024;
+    std::chrono::milliseconds send_timeout{ 10000 };
+};
+
+struct QueryDaemonStats {
+    uint64_t connections = 0;
+    uint64_t requests = 0;
+    uint64_t batches = 0;
+    // Ответы с кодом, отличным от OK
+    uint64_t failed_requests = 0;
+    // Соединения, закрытые из-за того, что клиент не читал ответы
+    uint64_t dropped_connections = 0;
+};
+
+// Сервер запросов к загруженному индексу (протокол - protocol.h). Поток на соединение читает кадры
+// в общую очередь, поток диспетчера собирает из неё пачки, выполняет их и кладёт ответы в очередь
+// записи соединения, а её поток записи отправляет их клиенту. Поэтому клиент, который не читает
+// ответы, задерживает только себя. Индекс не должен меняться, пока демон работает
+class QueryDaemon {
+public:
+    // Сокет начинает принимать соединения сразу, ещё до Run
+    QueryDaemon(const SearchServer& search_server, const std::string& endpoint,
+        const QueryDaemonOptions& options = QueryDaemonOptions{});
+    ~QueryDaemon();
+
+    QueryDaemon(const QueryDaemon&) = delete;
+    QueryDaemon& operator=(const QueryDaemon&) = delete;
+
+    // Порт TCP-сокета (для "tcp:УЗЕЛ:0" - выбранный системой), 0 для сокета Unix
+    uint16_t GetPort() const;
+
+    // Обслуживает соединения до Stop. Запросы, прочитанные до Stop, получают ответы
+    void Run();
+    // Можно вызывать из любого потока, в том числе до Run
+    void Stop();
+
+    QueryDaemonStats GetStats() const;
+
+private:
+    struct Connection {
+        explicit Connection(Socket connection_socket);
+
+        Socket socket;
+        std::atomic<bool> finished{ false };
+
+        // Очередь записи; поля ниже защищены output_mutex
+        std::mutex output_mutex;
+        std::condition_variable output_ready;
+        std::string output;
+        // Запросы соединения, ответы на которые ещё не в output
+        size_t unanswered = 0;
+        bool reading_done = false;
+        // Отправка не удалась или клиент не читает ответы: новые ответы отбрасываются
+        bool broken = false;
+    };
+
+    struct PendingRequest {
+        std::shared_ptr<Connection> connection;
+        DaemonRequest request;
+        // Непустое, если кадр не разобран
+        std::string error;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    // Поток соединения: читает запросы, пока поток записи отправляет ответы
+    void ServeConnection(const std::shared_ptr<Connection>& connection);
+    void ReadConnection(const std::shared_ptr<Connection>& connection);
+    void WriteConnection(Connection& connection);
+    // Ответы одного соединения из пачки; не ждёт отправки
+    void PostResponses(Connection& connection, std::string&& frames, size_t count);
+    void Enqueue(PendingRequest&& request);
+    void Dispatch();
+    DaemonResponse Execute(const PendingRequest& pending);
+    void JoinFinishedReaders();
+
+    const SearchServer& search_server_;
+    const std::string endpoint_;
+    const QueryDaemonOptions options_;
+    Socket listener_;
+    std::atomic<bool> stopping_{ false };
+
+    std::mutex connections_mutex_;
+    std::list<std::pair<std::shared_ptr<Connection>, std::thread>> connections_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_not_empty_;
+    std::condition_variable queue_not_full_;
+    std::deque<PendingRequest> queue_;
+    bool readers_done_ = false;
+
+    std::atomic<uint64_t> connection_count_{ 0 };
+    std::atomic<uint64_t> request_count_{ 0 };
+    std::atomic<uint64_t> batch_count_{ 0 };
+    std::atomic<uint64_t> failed_count_{ 0 };
+    std::atomic<uint64_t> dropped_count_{ 0 };
+};
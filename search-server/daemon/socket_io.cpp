@@ -0,0 +1,293 @@
+#include "socket_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../binary_io.h"
+
+namespace {
+
+const std::string UNIX_PREFIX = "unix:";
+const std::string TCP_PREFIX = "tcp:";
+const size_t READ_CHUNK_SIZE = 64 * 1024;
+// Дескрипторы освобождаются по мере закрытия соединений: частые попытки accept их не ускорят
+const std::chrono::milliseconds ACCEPT_RETRY_DELAY{ 10 };
+
+std::runtime_error MakeSystemError(const std::string& action, const std::string& endpoint) {
+    return std::runtime_error(action + std::string(" ") + endpoint + std::string(": ") + std::strerror(errno));
+}
+
+bool StartsWith(const std::string& value, const std::string& prefix) {
+    return value.compare(0, prefix.size(), prefix) == 0;
+}
+
+sockaddr_un MakeUnixAddress(const std::string& endpoint) {
+    const std::string path = endpoint.substr(UNIX_PREFIX.size());
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument(std::string("Invalid socket path in ") + endpoint);
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+// Первый адрес узла; для пустого узла - любой адрес при прослушивании
+addrinfo* ResolveTcpAddress(const std::string& endpoint, bool passive) {
+    const std::string address = endpoint.substr(TCP_PREFIX.size());
+    const size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        throw std::invalid_argument(std::string("Invalid TCP address ") + endpoint);
+    }
+    const std::string host = address.substr(0, colon);
+    const std::string port = address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    const int error = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result);
+    if (error != 0) {
+        throw std::runtime_error(std::string("Cannot resolve ") + endpoint + std::string(": ") + ::gai_strerror(error));
+    }
+    return result;
+}
+
+// Ответы короткие: без TCP_NODELAY алгоритм Нейгла задерживает их до подтверждения предыдущих
+void DisableNagle(const Socket& socket) {
+    const int enabled = 1;
+    ::setsockopt(socket.GetFd(), IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+}
+
+}  // namespace
+
+Socket::Socket(int fd)
+    : fd_(fd) {
+}
+
+Socket::Socket(Socket&& other) noexcept
+    : fd_(other.fd_) {
+    other.fd_ = -1;
+}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = other.fd_;
+        other.fd_ = -1;
+    }
+    return *this;
+}
+
+Socket::~Socket() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+int Socket::GetFd() const {
+    return fd_;
+}
+
+bool Socket::IsOpen() const {
+    return fd_ >= 0;
+}
+
+void Socket::SendAll(std::string_view data) const {
+    while (!data.empty()) {
+        const ssize_t result = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw MakeSystemError(std::string("Cannot send to"), std::string("socket"));
+        }
+        data.remove_prefix(static_cast<size_t>(result));
+    }
+}
+
+size_t Socket::Receive(char* buffer, size_t size) const {
+    while (true) {
+        const ssize_t result = ::recv(fd_, buffer, size, 0);
+        if (result >= 0) {
+            return static_cast<size_t>(result);
+        }
+        if (errno != EINTR) {
+            throw MakeSystemError(std::string("Cannot receive from"), std::string("socket"));
+        }
+    }
+}
+
+void Socket::Shutdown(int how) const {
+    ::shutdown(fd_, how);
+}
+
+void Socket::SetSendTimeout(std::chrono::milliseconds timeout) const {
+    timeval value{};
+    value.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    value.tv_usec = static_cast<suseconds_t>(timeout.count() % 1000 * 1000);
+    if (::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) != 0) {
+        throw MakeSystemError(std::string("Cannot set send timeout of"), std::string("socket"));
+    }
+}
+
+Socket ListenOn(const std::string& endpoint, int backlog) {
+    Socket socket;
+    if (StartsWith(endpoint, UNIX_PREFIX)) {
+        const sockaddr_un address = MakeUnixAddress(endpoint);
+        socket = Socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!socket.IsOpen()) {
+            throw MakeSystemError(std::string("Cannot create socket"), endpoint);
+        }
+        // Файл сокета остаётся после прошлого запуска
+        ::unlink(address.sun_path);
+        if (::bind(socket.GetFd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            throw MakeSystemError(std::string("Cannot bind"), endpoint);
+        }
+    }
+    else if (StartsWith(endpoint, TCP_PREFIX)) {
+        addrinfo* addresses = ResolveTcpAddress(endpoint, true);
+        socket = Socket(::socket(addresses->ai_family, addresses->ai_socktype | SOCK_CLOEXEC, addresses->ai_protocol));
+        const int enabled = 1;
+        const bool bound = socket.IsOpen()
+            && ::setsockopt(socket.GetFd(), SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled)) == 0
+            && ::bind(socket.GetFd(), addresses->ai_addr, addresses->ai_addrlen) == 0;
+        ::freeaddrinfo(addresses);
+        if (!bound) {
+            throw MakeSystemError(std::string("Cannot bind"), endpoint);
+        }
+    }
+    else {
+        throw std::invalid_argument(std::string("Endpoint must start with unix: or tcp: - ") + endpoint);
+    }
+    if (::listen(socket.GetFd(), backlog) != 0) {
+        throw MakeSystemError(std::string("Cannot listen on"), endpoint);
+    }
+    return socket;
+}
+
+Socket ConnectTo(const std::string& endpoint) {
+    Socket socket;
+    if (StartsWith(endpoint, UNIX_PREFIX)) {
+        const sockaddr_un address = MakeUnixAddress(endpoint);
+        socket = Socket(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!socket.IsOpen()
+            || ::connect(socket.GetFd(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            throw MakeSystemError(std::string("Cannot connect to"), endpoint);
+        }
+    }
+    else if (StartsWith(endpoint, TCP_PREFIX)) {
+        addrinfo* addresses = ResolveTcpAddress(endpoint, false);
+        socket = Socket(::socket(addresses->ai_family, addresses->ai_socktype | SOCK_CLOEXEC, addresses->ai_protocol));
+        const bool connected = socket.IsOpen()
+            && ::connect(socket.GetFd(), addresses->ai_addr, addresses->ai_addrlen) == 0;
+        ::freeaddrinfo(addresses);
+        if (!connected) {
+            throw MakeSystemError(std::string("Cannot connect to"), endpoint);
+        }
+        DisableNagle(socket);
+    }
+    else {
+        throw std::invalid_argument(std::string("Endpoint must start with unix: or tcp: - ") + endpoint);
+    }
+    return socket;
+}
+
+Socket AcceptOn(const Socket& listener) {
+    while (true) {
+        Socket socket(::accept4(listener.GetFd(), nullptr, nullptr, SOCK_CLOEXEC));
+        if (socket.IsOpen()) {
+            sockaddr_storage address{};
+            socklen_t length = sizeof(address);
+            if (::getsockname(socket.GetFd(), reinterpret_cast<sockaddr*>(&address), &length) == 0
+                && address.ss_family != AF_UNIX) {
+                DisableNagle(socket);
+            }
+            return socket;
+        }
+        // После shutdown прослушивающего сокета Linux возвращает EINVAL
+        if (errno == EINVAL || errno == EBADF) {
+            return Socket();
+        }
+        // Обрыв соединения до accept и нехватка дескрипторов не останавливают приём
+        if (errno == EMFILE || errno == ENFILE) {
+            std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+        }
+        else if (errno != EINTR && errno != ECONNABORTED) {
+            throw MakeSystemError(std::string("Cannot accept on"), std::string("socket"));
+        }
+    }
+}
+
+uint16_t GetLocalPort(const Socket& socket) {
+    sockaddr_storage address{};
+    socklen_t length = sizeof(address);
+    if (::getsockname(socket.GetFd(), reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        throw MakeSystemError(std::string("Cannot get address of"), std::string("socket"));
+    }
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in&>(address).sin_port);
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6&>(address).sin6_port);
+    }
+    return 0;
+}
+
+FrameReader::FrameReader(const Socket& socket, uint32_t max_frame_size)
+    : socket_(socket)
+    , max_frame_size_(max_frame_size)
+    , buffer_(READ_CHUNK_SIZE, '\0') {
+}
+
+bool FrameReader::ReadFrame(std::string_view& payload) {
+    if (!Fill(sizeof(uint32_t))) {
+        if (begin_ == end_) {
+            return false;
+        }
+        throw std::runtime_error(std::string("Connection closed in the middle of a frame"));
+    }
+    const uint32_t size = BinaryReader(std::string_view(buffer_).substr(begin_, sizeof(uint32_t))).ReadUint32();
+    if (size > max_frame_size_) {
+        throw std::runtime_error(std::string("Frame of ") + std::to_string(size) + std::string(" bytes is too large"));
+    }
+    if (!Fill(sizeof(uint32_t) + size)) {
+        throw std::runtime_error(std::string("Connection closed in the middle of a frame"));
+    }
+    payload = std::string_view(buffer_).substr(begin_ + sizeof(uint32_t), size);
+    begin_ += sizeof(uint32_t) + size;
+    return true;
+}
+
+// Дочитывает, пока в буфере не окажется size байт; false - конец потока раньше
+bool FrameReader::Fill(size_t size) {
+    if (end_ - begin_ >= size) {
+        return true;
+    }
+    // Непрочитанный хвост переносится в начало, чтобы буфер не рос
+    buffer_.erase(0, begin_);
+    end_ -= begin_;
+    begin_ = 0;
+    buffer_.resize(std::max(size, READ_CHUNK_SIZE));
+    while (end_ < size) {
+        const size_t received = socket_.Receive(buffer_.data() + end_, buffer_.size() - end_);
+        if (received == 0) {
+            return false;
+        }
+        end_ += received;
+    }
+    return true;
+}
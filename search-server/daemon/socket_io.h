@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Адрес сокета: "unix:ПУТЬ" или "tcp:УЗЕЛ:ПОРТ". Порт 0 при прослушивании выбирает система.
+// Ошибки системных вызовов - std::runtime_error с текстом errno
+
+// Владеет дескриптором сокета
+class Socket {
+public:
+    Socket() = default;
+    explicit Socket(int fd);
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+    ~Socket();
+
+    int GetFd() const;
+    bool IsOpen() const;
+
+    // Отправляет все байты. Закрытое другой стороной соединение - ошибка, а не SIGPIPE
+    void SendAll(std::string_view data) const;
+    // Сколько байт прочитано; 0 - конец потока
+    size_t Receive(char* buffer, size_t size) const;
+    // Будит потоки, ждущие в accept или recv. how - SHUT_RD, SHUT_WR или SHUT_RDWR
+    void Shutdown(int how) const;
+    // SendAll бросает, если другая сторона не принимает данные дольше timeout
+    void SetSendTimeout(std::chrono::milliseconds timeout) const;
+
+private:
+    int fd_ = -1;
+};
+
+Socket ListenOn(const std::string& endpoint, int backlog = 128);
+Socket ConnectTo(const std::string& endpoint);
+// Пустой Socket, если прослушивающий сокет закрыт через Shutdown. При нехватке дескрипторов
+// ждёт освобождения дескрипторов (10 мс) перед следующей попыткой, а не крутится в accept
+Socket AcceptOn(const Socket& listener);
+// Порт TCP-сокета, 0 для сокета Unix
+uint16_t GetLocalPort(const Socket& socket);
+
+// Буферизованное чтение кадров протокола демона (protocol.h) из сокета
+class FrameReader {
+public:
+    FrameReader(const Socket& socket, uint32_t max_frame_size);
+
+    // false в конце потока между кадрами. Нагрузка действительна до следующего вызова.
+    // Обрыв посреди кадра и кадр длиннее max_frame_size - std::runtime_error
+    bool ReadFrame(std::string_view& payload);
+
+private:
+    bool Fill(size_t size);
+
+    const Socket& socket_;
+    uint32_t max_frame_size_;
+    std::string buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+};
@@ -1,15 +1,26 @@
-#include "document.h"
-
-Document::Document() = default;
-Document::Document(int id, double relevance, int rating)
-    : id(id)
-    , relevance(relevance)
-    , rating(rating) {
-}
-
-std::ostream& operator << (std::ostream& ost, const Document& doc)
-{
-    return ost << std::string("{ document_id = ") << doc.id
-        << std::string(", relevance = ") << doc.relevance
-        << std::string(", rating = ") << doc.rating << std::string(" }");
+#include "document.h"
+
+#include <cmath>
+
+Document::Document() = default;
+Document::Document(int id, double relevance, int rating)
+    : id(id)
+    , relevance(relevance)
+    , rating(rating) {
+}
+
+std::ostream& operator << (std::ostream& ost, const Document& doc)
+{
+    return ost << std::string("{ document_id = ") << doc.id
+        << std::string(", relevance = ") << doc.relevance
+        << std::string(", rating = ") << doc.rating << std::string(" }");
+}
+
+bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        return lhs.rating > rhs.rating;
+    }
+    else {
+        return lhs.relevance > rhs.relevance;
+    }
 }
\ No newline at end of file
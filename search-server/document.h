@@ -1,19 +1,34 @@
-#pragma once
-#include <iostream>
-
-enum class DocumentStatus {
-    ACTUAL,
-    IRRELEVANT,
-    BANNED,
-    REMOVED,
-};
-
-struct Document {
-    Document();
-    Document(int id, double relevance, int rating);
-    int id = 0;
-    double relevance = 0.0;
-    int rating = 0;
-};
-
-std::ostream& operator << (std::ostream& ost, const Document& doc);
\ No newline at end of file
+#pragma once
+#include <iostream>
+
+const double EPSILON = 1e-6;
+
+enum class DocumentStatus {
+    ACTUAL,
+    IRRELEVANT,
+    BANNED,
+    REMOVED,
+};
+
+// Предикат поиска по статусу документа. В отличие от лямбды его тип виден при компиляции,
+// поэтому такие запросы читают срезы частых слов (SearchServerOptions::hot_terms)
+struct StatusPredicate {
+    DocumentStatus status = DocumentStatus::ACTUAL;
+
+    bool operator()(int, DocumentStatus document_status, int) const {
+        return document_status == status;
+    }
+};
+
+struct Document {
+    Document();
+    Document(int id, double relevance, int rating);
+    int id = 0;
+    double relevance = 0.0;
+    int rating = 0;
+};
+
+std::ostream& operator << (std::ostream& ost, const Document& doc);
+
+// Порядок выдачи: по убыванию релевантности, при равной с точностью до EPSILON - по убыванию рейтинга
+bool IsMoreRelevant(const Document& lhs, const Document& rhs);
\ No newline at end of file
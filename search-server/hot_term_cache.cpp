@@ -0,0 +1,238 @@
+#include "hot_term_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+HotTermSlice::HotTermSlice(std::pmr::memory_resource* resource)
+    : document_ids(resource)
+    , term_counts(resource)
+    , document_lengths(resource)
+    , ratings(resource)
+{
+}
+
+void HotTermSlice::Add(int document_id, uint32_t term_count, uint32_t document_length, int rating) {
+    // Новые документы обычно получают наибольший id: вставка идёт в конец
+    const auto position = document_ids.empty() || document_ids.back() < document_id ? document_ids.size()
+        : static_cast<size_t>(std::lower_bound(document_ids.begin(), document_ids.end(), document_id)
+            - document_ids.begin());
+    document_ids.insert(document_ids.begin() + position, document_id);
+    term_counts.insert(term_counts.begin() + position, term_count);
+    document_lengths.insert(document_lengths.begin() + position, document_length);
+    ratings.insert(ratings.begin() + position, rating);
+}
+
+void HotTermSlice::Erase(int document_id) {
+    const auto it = std::lower_bound(document_ids.begin(), document_ids.end(), document_id);
+    if (it == document_ids.end() || *it != document_id) {
+        return;
+    }
+    const auto position = it - document_ids.begin();
+    document_ids.erase(it);
+    term_counts.erase(term_counts.begin() + position);
+    document_lengths.erase(document_lengths.begin() + position);
+    ratings.erase(ratings.begin() + position);
+}
+
+size_t HotTermSlice::GetSize() const {
+    return document_ids.size();
+}
+
+size_t HotTermSlice::GetMemoryUsage() const {
+    return sizeof(HotTermSlice) + document_ids.capacity() * sizeof(int) + term_counts.capacity() * sizeof(uint32_t)
+        + document_lengths.capacity() * sizeof(uint32_t) + ratings.capacity() * sizeof(int);
+}
+
+double HotTermCacheStats::GetHitRate() const {
+    return hits + misses > 0 ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+}
+
+size_t HotTermCache::KeyHash::operator()(const Key& key) const {
+    return std::hash<std::string_view>()(key.first) * 31 + static_cast<size_t>(key.second);
+}
+
+bool HotTermCache::EvictionOrder::operator()(const EvictionKey& lhs, const EvictionKey& rhs) const {
+    if (lhs.first != rhs.first) {
+        return lhs.first < rhs.first;
+    }
+    return std::less<const Entry*>()(lhs.second, rhs.second);
+}
+
+HotTermCache::Shard::Shard(std::pmr::memory_resource* resource)
+    : entries(resource)
+    , eviction_order(resource)
+{
+}
+
+HotTermCache::HotTermCache(const HotTermCacheOptions& options, std::pmr::memory_resource* upstream)
+    : options_(options)
+    , pool_(upstream)
+{
+    shards_.reserve(SHARD_COUNT);
+    for (size_t i = 0; i < SHARD_COUNT; ++i) {
+        shards_.push_back(std::make_unique<Shard>(&pool_));
+    }
+}
+
+size_t HotTermCache::GetMinPostings() const {
+    return options_.min_postings;
+}
+
+HotTermSlice HotTermCache::CreateSlice() {
+    return HotTermSlice(&pool_);
+}
+
+std::shared_ptr<const HotTermSlice> HotTermCache::Find(std::string_view word, DocumentStatus status, bool& admit) {
+    const Key key{ word, status };
+    Shard& shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    Entry& entry = shard.entries[key];
+    CountQuery(shard, entry);
+    if (entry.slice) {
+        ++shard.hits;
+        admit = false;
+        return entry.slice;
+    }
+    ++shard.misses;
+    admit = !entry.building && entry.queries >= options_.admission_count;
+    entry.building = entry.building || admit;
+    return nullptr;
+}
+
+std::shared_ptr<const HotTermSlice> HotTermCache::Insert(std::string_view word, DocumentStatus status,
+    HotTermSlice slice) {
+    const Key key{ word, status };
+    std::shared_ptr<HotTermSlice> inserted;
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard guard(shard.mutex);
+        Entry& entry = shard.entries[key];
+        entry.building = false;
+        if (entry.slice) {
+            return entry.slice;
+        }
+        if (slice.GetMemoryUsage() > options_.capacity) {
+            // Срез не поместится никогда: слово снова наберёт запросы, прежде чем его попробуют построить
+            entry.queries = 0;
+            return nullptr;
+        }
+        inserted = std::allocate_shared<HotTermSlice>(std::pmr::polymorphic_allocator<HotTermSlice>(&pool_),
+            std::move(slice));
+        entry.slice = inserted;
+        shard.eviction_order.emplace(entry.queries, &entry);
+        ++shard.admissions;
+        ++slices_;
+        UpdateMemory(entry);
+    }
+    Evict();
+    return inserted;
+}
+
+bool HotTermCache::HasSlices() const {
+    return slices_.load(std::memory_order_relaxed) > 0;
+}
+
+void HotTermCache::AddPosting(std::string_view word, DocumentStatus status, int document_id, uint32_t term_count,
+    uint32_t document_length, int rating) {
+    const Key key{ word, status };
+    {
+        Shard& shard = GetShard(key);
+        std::lock_guard guard(shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it == shard.entries.end() || !it->second.slice) {
+            return;
+        }
+        it->second.slice->Add(document_id, term_count, document_length, rating);
+        ++shard.updates;
+        UpdateMemory(it->second);
+    }
+    Evict();
+}
+
+void HotTermCache::ErasePosting(std::string_view word, DocumentStatus status, int document_id) {
+    const Key key{ word, status };
+    Shard& shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    const auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || !it->second.slice) {
+        return;
+    }
+    it->second.slice->Erase(document_id);
+    ++shard.updates;
+}
+
+HotTermCacheStats HotTermCache::GetStats() const {
+    HotTermCacheStats stats;
+    for (const auto& shard : shards_) {
+        std::lock_guard guard(shard->mutex);
+        stats.hits += shard->hits;
+        stats.misses += shard->misses;
+        stats.admissions += shard->admissions;
+        stats.updates += shard->updates;
+    }
+    stats.evictions = evictions_;
+    stats.slices = slices_;
+    stats.memory = memory_;
+    return stats;
+}
+
+HotTermCache::Shard& HotTermCache::GetShard(const Key& key) {
+    return *shards_[KeyHash()(key) % SHARD_COUNT];
+}
+
+void HotTermCache::UpdateMemory(Entry& entry) {
+    const size_t memory = entry.slice ? entry.slice->GetMemoryUsage() : 0;
+    memory_ += memory;
+    memory_ -= entry.memory;
+    entry.memory = memory;
+}
+
+void HotTermCache::CountQuery(Shard& shard, Entry& entry) {
+    if (!entry.slice) {
+        ++entry.queries;
+        return;
+    }
+    // Узел переставляется без выделения памяти
+    auto node = shard.eviction_order.extract({ entry.queries, &entry });
+    ++entry.queries;
+    node.value().first = entry.queries;
+    shard.eviction_order.insert(std::move(node));
+}
+
+void HotTermCache::EvictEntry(Shard& shard, Entry& entry) {
+    shard.eviction_order.erase({ entry.queries, &entry });
+    entry.slice.reset();
+    // Вытесненное слово снова проходит первый уровень
+    entry.queries = 0;
+    UpdateMemory(entry);
+    --slices_;
+    ++evictions_;
+}
+
+void HotTermCache::Evict() {
+    if (memory_ <= options_.capacity) {
+        return;
+    }
+    std::lock_guard eviction_guard(eviction_mutex_);
+    while (memory_ > options_.capacity) {
+        // Жертва - срез с наименьшим числом запросов среди первых срезов шардов
+        Shard* victim = nullptr;
+        size_t victim_queries = 0;
+        for (const auto& shard : shards_) {
+            std::lock_guard guard(shard->mutex);
+            if (!shard->eviction_order.empty()
+                && (!victim || shard->eviction_order.begin()->first < victim_queries)) {
+                victim = shard.get();
+                victim_queries = shard->eviction_order.begin()->first;
+            }
+        }
+        if (!victim) {
+            return;
+        }
+        std::lock_guard guard(victim->mutex);
+        // Пока блокировка шарда была отпущена, его первый срез мог смениться - вытесняется текущий первый
+        if (!victim->eviction_order.empty()) {
+            EvictEntry(*victim, *victim->eviction_order.begin()->second);
+        }
+    }
+}
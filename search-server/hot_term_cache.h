@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+
+struct HotTermCacheOptions {
+    // Предел памяти срезов в байтах; 0 - кеш выключен
+    size_t capacity = 0;
+    // Слова с более коротким списком документов не кешируются: их список дешевле обойти заново
+    size_t min_postings = 256;
+    // Срез строится, когда слово встретилось со статусом в стольких запросах
+    size_t admission_count = 2;
+};
+
+// Записи списка документов слова для документов одного статуса, по возрастанию id. Длина и рейтинг
+// документа лежат рядом с числом вхождений, поэтому поиск по срезу не читает метаданные документов
+struct HotTermSlice {
+    explicit HotTermSlice(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    std::pmr::vector<int> document_ids;
+    std::pmr::vector<uint32_t> term_counts;
+    std::pmr::vector<uint32_t> document_lengths;
+    std::pmr::vector<int> ratings;
+
+    void Add(int document_id, uint32_t term_count, uint32_t document_length, int rating);
+    void Erase(int document_id);
+    size_t GetSize() const;
+    size_t GetMemoryUsage() const;
+};
+
+struct HotTermCacheStats {
+    // Обращения к кешу за словами с длинными списками
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t admissions = 0;
+    size_t evictions = 0;
+    // Записи срезов, добавленные и удалённые AddDocument и RemoveDocument
+    size_t updates = 0;
+    size_t slices = 0;
+    size_t memory = 0;
+
+    double GetHitRate() const;
+};
+
+// Кеш срезов частых слов запросов по статусу документа. Первый уровень считает запросы слова со статусом,
+// второй хранит срезы слов, встретившихся не меньше admission_count раз. При превышении capacity
+// вытесняются срезы слов с наименьшим числом запросов.
+// Записи разбиты на шарды по хешу слова, у каждого своя блокировка, поэтому запросы из разных потоков
+// редко ждут друг друга. Срезы и записи берут память из upstream через потокобезопасный пул.
+// Find и Insert можно вызывать из нескольких потоков; изменения срезов (AddPosting, ErasePosting)
+// не должны идти одновременно с поиском - как и изменения индекса сервера
+class HotTermCache {
+public:
+    // upstream должен пережить кеш
+    explicit HotTermCache(const HotTermCacheOptions& options,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    size_t GetMinPostings() const;
+
+    // Пустой срез, память которого берётся из пула кеша
+    HotTermSlice CreateSlice();
+
+    // Срез слова или nullptr. admit равен true, если слово стало частым и срез нужно построить и
+    // передать в Insert. word должен жить дольше кеша
+    std::shared_ptr<const HotTermSlice> Find(std::string_view word, DocumentStatus status, bool& admit);
+
+    // Возвращает сохранённый срез или nullptr, если срез больше всего кеша
+    std::shared_ptr<const HotTermSlice> Insert(std::string_view word, DocumentStatus status, HotTermSlice slice);
+
+    bool HasSlices() const;
+
+    void AddPosting(std::string_view word, DocumentStatus status, int document_id, uint32_t term_count,
+        uint32_t document_length, int rating);
+    void ErasePosting(std::string_view word, DocumentStatus status, int document_id);
+
+    HotTermCacheStats GetStats() const;
+
+private:
+    using Key = std::pair<std::string_view, DocumentStatus>;
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        std::shared_ptr<HotTermSlice> slice;
+        size_t queries = 0;
+        size_t memory = 0;
+        // Срез строит один из запросов, остальные тем временем обходят список документов
+        bool building = false;
+    };
+    // Срезы шарда по возрастанию числа запросов: первый вытесняется раньше остальных
+    using EvictionKey = std::pair<size_t, Entry*>;
+    struct EvictionOrder {
+        bool operator()(const EvictionKey& lhs, const EvictionKey& rhs) const;
+    };
+    struct Shard {
+        explicit Shard(std::pmr::memory_resource* resource);
+
+        std::mutex mutex;
+        std::pmr::unordered_map<Key, Entry, KeyHash> entries;
+        std::pmr::set<EvictionKey, EvictionOrder> eviction_order;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t admissions = 0;
+        size_t updates = 0;
+    };
+
+    static constexpr size_t SHARD_COUNT = 16;
+
+    Shard& GetShard(const Key& key);
+
+    // Вызываются под блокировкой шарда
+    void UpdateMemory(Entry& entry);
+    void CountQuery(Shard& shard, Entry& entry);
+    void EvictEntry(Shard& shard, Entry& entry);
+
+    // Вызывается без блокировок шардов
+    void Evict();
+
+    const HotTermCacheOptions options_;
+    // Объявлен раньше шардов, чтобы пережить их срезы
+    std::pmr::synchronized_pool_resource pool_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // Вытеснение выбирает жертву среди всех шардов, поэтому идёт в одном потоке за раз
+    std::mutex eviction_mutex_;
+    std::atomic<size_t> memory_{ 0 };
+    std::atomic<size_t> slices_{ 0 };
+    std::atomic<size_t> evictions_{ 0 };
+};
@@ -0,0 +1,39 @@
+#include "impact_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+ImpactList::ImpactList(std::pmr::memory_resource* resource)
+    : entries_(resource)
+{
+}
+
+void ImpactList::Build(const std::vector<std::pair<int, double>>& impacts, int bits) {
+    if (bits < 1 || bits > MAX_BITS) {
+        throw std::invalid_argument(std::string("Impact quantization bits must be from 1 to ")
+            + std::to_string(MAX_BITS));
+    }
+    const double max_level = static_cast<double>((1u << bits) - 1);
+    double max_impact = 0.0;
+    for (const auto& [document_id, impact] : impacts) {
+        max_impact = std::max(max_impact, impact);
+    }
+    scale_ = max_impact / max_level;
+
+    entries_.clear();
+    entries_.reserve(impacts.size());
+    for (const auto& [document_id, impact] : impacts) {
+        const double level = scale_ > 0.0 ? std::min(std::ceil(impact / scale_), max_level) : 0.0;
+        entries_.push_back({ document_id, static_cast<uint16_t>(level) });
+    }
+    // При равных вкладах - по возрастанию id, чтобы порядок не зависел от входа
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.impact != rhs.impact ? lhs.impact > rhs.impact : lhs.document_id < rhs.document_id;
+    });
+}
+
+const ImpactList::Entries& ImpactList::GetEntries() const {
+    return entries_;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Список документов слова по убыванию вклада слова в релевантность. Вклад хранится квантованным
+// в bits бит относительно наибольшего вклада слова и округлённым вверх, поэтому GetBound не меньше
+// точного вклада любого документа с данной позиции списка
+class ImpactList {
+public:
+    struct Entry {
+        int document_id;
+        uint16_t impact;
+    };
+    using Entries = std::pmr::vector<Entry>;
+
+    static constexpr int MAX_BITS = 16;
+
+    explicit ImpactList(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Точные вклады документов в любом порядке. Бросает std::invalid_argument, если bits не из [1, MAX_BITS]
+    void Build(const std::vector<std::pair<int, double>>& impacts, int bits);
+
+    const Entries& GetEntries() const;
+
+    // Верхняя граница вклада документов, начиная с позиции position; 0 за концом списка
+    double GetBound(size_t position) const {
+        return position < entries_.size() ? entries_[position].impact * scale_ : 0.0;
+    }
+
+private:
+    Entries entries_;
+    double scale_ = 0.0;
+};
@@ -1,36 +1,36 @@
-#pragma once
-
-#include <chrono>
-#include <iostream>
-
-#define PROFILE_CONCAT_INTERNAL(X, Y) X##Y
-#define PROFILE_CONCAT(X, Y) PROFILE_CONCAT_INTERNAL(X, Y)
-#define UNIQUE_VAR_NAME_PROFILE PROFILE_CONCAT(profileGuard, __LINE__)
-#define LOG_DURATION(x) LogDuration UNIQUE_VAR_NAME_PROFILE(x)
-#define LOG_DURATION_STREAM(x, y) LogDuration UNIQUE_VAR_NAME_PROFILE(x,y)
-
-class LogDuration {
-public:
-    //    std::chrono::steady_clock
-    //   using  
-    using Clock = std::chrono::steady_clock;
-
-    LogDuration(const std::string& name, std::ostream& ostream_need = std::cerr)
-        : name_(name), ostream_(ostream_need)
-    {
-    }
-
-    ~LogDuration() {
-        using namespace std::chrono;
-        using namespace std::literals;
-
-        const auto end_time = Clock::now();
-        const auto dur = end_time - start_time_;
-        ostream_ << name_ << ": "s << duration_cast<milliseconds>(dur).count() << " ms"s << std::endl;
-    }
-
-private:
-    const std::string name_;
-    std::ostream& ostream_;
-    const Clock::time_point start_time_ = Clock::now();
+#pragma once
+
+#include <chrono>
+#include <iostream>
+
+#define PROFILE_CONCAT_INTERNAL(X, Y) X##Y
+#define PROFILE_CONCAT(X, Y) PROFILE_CONCAT_INTERNAL(X, Y)
+#define UNIQUE_VAR_NAME_PROFILE PROFILE_CONCAT(profileGuard, __LINE__)
+#define LOG_DURATION(x) LogDuration UNIQUE_VAR_NAME_PROFILE(x)
+#define LOG_DURATION_STREAM(x, y) LogDuration UNIQUE_VAR_NAME_PROFILE(x,y)
+
+class LogDuration {
+public:
+    //    std::chrono::steady_clock
+    //   using  
+    using Clock = std::chrono::steady_clock;
+
+    LogDuration(const std::string& name, std::ostream& ostream_need = std::cerr)
+        : name_(name), ostream_(ostream_need)
+    {
+    }
+
+    ~LogDuration() {
+        using namespace std::chrono;
+        using namespace std::literals;
+
+        const auto end_time = Clock::now();
+        const auto dur = end_time - start_time_;
+        ostream_ << name_ << ": "s << duration_cast<milliseconds>(dur).count() << " ms"s << std::endl;
+    }
+
+private:
+    const std::string name_;
+    std::ostream& ostream_;
+    const Clock::time_point start_time_ = Clock::now();
 };
\ No newline at end of file
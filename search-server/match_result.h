@@ -0,0 +1,26 @@
+#pragma once
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+#include "paginator.h"
+
+// Результат сопоставления одного запроса со многими документами.
+// Совпавшие слова всех документов лежат в одном буфере words: слова документа document_ids[i]
+// занимают диапазон [offsets[i], offsets[i + 1]) и отсортированы.
+// string_view указывают на слова словаря сервера и действительны, пока документы не удалены
+struct BatchMatchResult {
+    std::vector<int> document_ids;
+    std::vector<DocumentStatus> statuses;
+    std::vector<size_t> offsets;
+    std::vector<std::string_view> words;
+
+    size_t GetDocumentCount() const {
+        return document_ids.size();
+    }
+
+    IteratorRange<std::vector<std::string_view>::const_iterator> GetMatchedWords(size_t index) const {
+        return IteratorRange(words.begin() + offsets[index], words.begin() + offsets[index + 1],
+            offsets[index + 1] - offsets[index]);
+    }
+};
@@ -0,0 +1,111 @@
+#include "memory_resources.h"
+
+#include <optional>
+
+CountingMemoryResource::CountingMemoryResource(std::pmr::memory_resource* upstream)
+    : upstream_(upstream)
+{
+}
+
+AllocationCounters CountingMemoryResource::GetCounters() const {
+    AllocationCounters counters;
+    counters.allocations = allocations_.load(std::memory_order_relaxed);
+    counters.deallocations = deallocations_.load(std::memory_order_relaxed);
+    counters.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+    counters.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+    counters.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+    return counters;
+}
+
+void* CountingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+    void* pointer = upstream_->allocate(bytes, alignment);
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    const size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_in_use_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    return pointer;
+}
+
+void CountingMemoryResource::do_deallocate(void* pointer, size_t bytes, size_t alignment) {
+    upstream_->deallocate(pointer, bytes, alignment);
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool CountingMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+struct QueryScratchScope::Pool {
+    explicit Pool(bool concurrent)
+        : upstream(std::pmr::new_delete_resource())
+    {
+        if (concurrent) {
+            resource = &synchronized.emplace(&upstream);
+        }
+        else {
+            resource = &unsynchronized.emplace(&upstream);
+        }
+    }
+
+    void Release() {
+        if (synchronized) {
+            synchronized->release();
+        }
+        if (unsynchronized) {
+            unsynchronized->release();
+        }
+    }
+
+    CountingMemoryResource upstream;
+    std::optional<std::pmr::synchronized_pool_resource> synchronized;
+    std::optional<std::pmr::unsynchronized_pool_resource> unsynchronized;
+    std::pmr::memory_resource* resource = nullptr;
+    // Вложенные запросы (например, украденные задачи параллельного алгоритма) используют тот же пул
+    int depth = 0;
+};
+
+QueryScratchScope::QueryScratchScope(bool concurrent)
+    : pool_(GetThreadPool(concurrent))
+{
+    ++pool_.depth;
+}
+
+QueryScratchScope::~QueryScratchScope() {
+    if (--pool_.depth == 0 && pool_.upstream.GetCounters().bytes_in_use > QUERY_SCRATCH_RETAIN_LIMIT) {
+        pool_.Release();
+    }
+}
+
+std::pmr::memory_resource* QueryScratchScope::GetResource() const {
+    return pool_.resource;
+}
+
+QueryScratchScope::Pool& QueryScratchScope::GetThreadPool(bool concurrent) {
+    thread_local Pool sequential_pool(false);
+    thread_local Pool concurrent_pool(true);
+    return concurrent ? concurrent_pool : sequential_pool;
+}
+
+AllocationCounters QueryScratchScope::GetThreadCounters() {
+    const AllocationCounters sequential = GetThreadPool(false).upstream.GetCounters();
+    const AllocationCounters concurrent = GetThreadPool(true).upstream.GetCounters();
+    AllocationCounters counters;
+    counters.allocations = sequential.allocations + concurrent.allocations;
+    counters.deallocations = sequential.deallocations + concurrent.deallocations;
+    counters.bytes_allocated = sequential.bytes_allocated + concurrent.bytes_allocated;
+    counters.bytes_in_use = sequential.bytes_in_use + concurrent.bytes_in_use;
+    counters.peak_bytes_in_use = sequential.peak_bytes_in_use + concurrent.peak_bytes_in_use;
+    return counters;
+}
+
+void QueryScratchScope::ReleaseThreadPools() {
+    for (const bool concurrent : { false, true }) {
+        auto& pool = GetThreadPool(concurrent);
+        if (pool.depth == 0) {
+            pool.Release();
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+struct AllocationCounters {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_in_use = 0;
+    size_t peak_bytes_in_use = 0;
+};
+
+// Передаёт запросы вышестоящему ресурсу и считает их.
+// Счётчики атомарные, поэтому ресурс потокобезопасен, если потокобезопасен upstream
+class CountingMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit CountingMemoryResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    AllocationCounters GetCounters() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* upstream_;
+    std::atomic<size_t> allocations_ = 0;
+    std::atomic<size_t> deallocations_ = 0;
+    std::atomic<size_t> bytes_allocated_ = 0;
+    std::atomic<size_t> bytes_in_use_ = 0;
+    std::atomic<size_t> peak_bytes_in_use_ = 0;
+};
+
+// Временная память одного запроса берётся из пула текущего потока. Пул переживает запрос,
+// поэтому повторные запросы почти не обращаются к куче. Когда внешний запрос потока завершается,
+// а пул удерживает больше QUERY_SCRATCH_RETAIN_LIMIT байт, пул сбрасывается.
+// concurrent = true даёт пул, которым могут пользоваться потоки параллельного алгоритма
+class QueryScratchScope {
+public:
+    static constexpr size_t QUERY_SCRATCH_RETAIN_LIMIT = size_t(64) << 20;
+
+    explicit QueryScratchScope(bool concurrent);
+    ~QueryScratchScope();
+
+    QueryScratchScope(const QueryScratchScope&) = delete;
+    QueryScratchScope& operator=(const QueryScratchScope&) = delete;
+
+    std::pmr::memory_resource* GetResource() const;
+
+    // Обращения пулов текущего потока к куче
+    static AllocationCounters GetThreadCounters();
+
+    // Возвращает в кучу память пулов текущего потока, если ими сейчас не пользуется запрос
+    static void ReleaseThreadPools();
+
+private:
+    struct Pool;
+    static Pool& GetThreadPool(bool concurrent);
+
+    Pool& pool_;
+};
@@ -0,0 +1,18 @@
+#include "memory_usage.h"
+
+size_t MemoryUsage::GetTotal() const {
+    return stop_words + dictionary + inverted_index + forward_index + document_metadata + positions + impacts + caches;
+}
+
+std::ostream& operator<<(std::ostream& output, const MemoryUsage& usage) {
+    output << "stop words: " << usage.stop_words << std::endl
+        << "dictionary: " << usage.dictionary << std::endl
+        << "inverted index: " << usage.inverted_index << std::endl
+        << "forward index: " << usage.forward_index << std::endl
+        << "document metadata: " << usage.document_metadata << std::endl
+        << "positions: " << usage.positions << std::endl
+        << "impacts: " << usage.impacts << std::endl
+        << "caches: " << usage.caches << std::endl
+        << "total: " << usage.GetTotal() << std::endl;
+    return output;
+}
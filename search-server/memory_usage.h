@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <iostream>
+
+// Память сервера по частям индекса, в байтах. Части индекса считаются точно по запросам к ресурсу
+// памяти сервера (без накладных расходов самого распределителя), стоп-слова - по размеру их таблиц
+struct MemoryUsage {
+    size_t stop_words = 0;
+    // Узлы словаря и строки слов
+    size_t dictionary = 0;
+    // Списки документов слов (word_to_document_freqs_ без самих слов)
+    size_t inverted_index = 0;
+    // Слова каждого документа (document_to_word_freqs_)
+    size_t forward_index = 0;
+    // Рейтинг, статус и множество id документов
+    size_t document_metadata = 0;
+    // Позиции слов документов (SearchServerOptions::store_positions)
+    size_t positions = 0;
+    // Списки документов по вкладу (SearchServer::BuildImpactIndex)
+    size_t impacts = 0;
+    // Кеш частых слов (SearchServerOptions::hot_terms) вместе с памятью, которую удерживает его пул
+    size_t caches = 0;
+
+    size_t GetTotal() const;
+};
+
+std::ostream& operator<<(std::ostream& output, const MemoryUsage& usage);
@@ -0,0 +1,271 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+const size_t COUNTER_COUNT = static_cast<size_t>(MetricCounter::COUNT);
+const size_t PHASE_COUNT = static_cast<size_t>(MetricPhase::COUNT);
+
+}  // namespace
+
+const char* GetMetricName(MetricPhase phase) {
+    switch (phase) {
+    case MetricPhase::QUERY_PARSE:
+        return "query_parse";
+    case MetricPhase::POSTING_TRAVERSAL:
+        return "posting_traversal";
+    case MetricPhase::MINUS_WORD_FILTER:
+        return "minus_word_filter";
+    case MetricPhase::PHRASE_FILTER:
+        return "phrase_filter";
+    case MetricPhase::TOP_K_SELECTION:
+        return "top_k_selection";
+    case MetricPhase::FIND_TOP_DOCUMENTS:
+        return "find_top_documents";
+    case MetricPhase::MATCH_DOCUMENT:
+        return "match_document";
+    case MetricPhase::ADD_DOCUMENT:
+        return "add_document";
+    case MetricPhase::REMOVE_DOCUMENT:
+        return "remove_document";
+    case MetricPhase::COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+const char* GetMetricName(MetricCounter counter) {
+    switch (counter) {
+    case MetricCounter::QUERIES:
+        return "queries";
+    case MetricCounter::POSTINGS_SCANNED:
+        return "postings_scanned";
+    case MetricCounter::DOCUMENTS_MATCHED:
+        return "documents_matched";
+    case MetricCounter::DOCUMENTS_ADDED:
+        return "documents_added";
+    case MetricCounter::DOCUMENTS_REMOVED:
+        return "documents_removed";
+    case MetricCounter::DUPLICATES_DETECTED:
+        return "duplicates_detected";
+    case MetricCounter::COUNT:
+        break;
+    }
+    return "unknown";
+}
+
+int LatencyHistogram::GetBucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < static_cast<uint64_t>(SUB_BUCKET_COUNT)) {
+        return static_cast<int>(nanoseconds);
+    }
+    int exponent = 63;
+    while ((nanoseconds >> exponent) == 0) {
+        --exponent;
+    }
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    const int sub_bucket = static_cast<int>((nanoseconds >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket;
+}
+
+uint64_t LatencyHistogram::GetBucketValue(int bucket_index) {
+    if (bucket_index < SUB_BUCKET_COUNT) {
+        return static_cast<uint64_t>(bucket_index);
+    }
+    const int exponent = bucket_index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+    const uint64_t sub_bucket = static_cast<uint64_t>(bucket_index % SUB_BUCKET_COUNT);
+    return (static_cast<uint64_t>(SUB_BUCKET_COUNT) + sub_bucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t HistogramSnapshot::GetPercentile(double percentile) const {
+    if (count == 0) {
+        return 0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)));
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return LatencyHistogram::GetBucketValue(i);
+        }
+    }
+    return LatencyHistogram::GetBucketValue(LatencyHistogram::BUCKET_COUNT - 1);
+}
+
+uint64_t MetricsSnapshot::Get(MetricCounter counter) const {
+    return counters[static_cast<size_t>(counter)];
+}
+
+const HistogramSnapshot& MetricsSnapshot::Get(MetricPhase phase) const {
+    return phases[static_cast<size_t>(phase)];
+}
+
+void WriteMetricsJson(std::ostream& output, const MetricsSnapshot& snapshot) {
+    output << "{\"counters\": {";
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        output << (i > 0 ? ", " : "") << '"' << GetMetricName(static_cast<MetricCounter>(i)) << "\": "
+            << snapshot.counters[i];
+    }
+    output << "}, \"phases\": {";
+    for (size_t i = 0; i < PHASE_COUNT; ++i) {
+        const HistogramSnapshot& histogram = snapshot.phases[i];
+        const uint64_t mean = histogram.count > 0 ? histogram.total_nanoseconds / histogram.count : 0;
+        output << (i > 0 ? ", " : "") << '"' << GetMetricName(static_cast<MetricPhase>(i)) << "\": {"
+            << "\"count\": " << histogram.count
+            << ", \"mean_ns\": " << mean
+            << ", \"p50_ns\": " << histogram.GetPercentile(50)
+            << ", \"p90_ns\": " << histogram.GetPercentile(90)
+            << ", \"p99_ns\": " << histogram.GetPercentile(99)
+            << ", \"max_ns\": " << histogram.GetPercentile(100) << "}";
+    }
+    output << "}}" << std::endl;
+}
+
+#ifdef SEARCH_SERVER_METRICS
+
+namespace {
+
+// Каждый поток пишет только в свои счётчики, поэтому достаточно relaxed load/store без lock-префикса;
+// атомики нужны лишь для того, чтобы снимок мог читать их из другого потока
+struct ThreadMetrics {
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKET_COUNT>, PHASE_COUNT> buckets{};
+    std::array<std::atomic<uint64_t>, PHASE_COUNT> totals{};
+};
+
+void AddRelaxed(std::atomic<uint64_t>& target, uint64_t value) {
+    target.store(target.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void MergeInto(MetricsSnapshot& snapshot, const ThreadMetrics& metrics) {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        snapshot.counters[i] += metrics.counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        HistogramSnapshot& histogram = snapshot.phases[phase];
+        for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            const uint64_t value = metrics.buckets[phase][i].load(std::memory_order_relaxed);
+            histogram.buckets[i] += value;
+            histogram.count += value;
+        }
+        histogram.total_nanoseconds += metrics.totals[phase].load(std::memory_order_relaxed);
+    }
+}
+
+void Subtract(MetricsSnapshot& snapshot, const MetricsSnapshot& baseline) {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        snapshot.counters[i] -= std::min(snapshot.counters[i], baseline.counters[i]);
+    }
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        HistogramSnapshot& histogram = snapshot.phases[phase];
+        const HistogramSnapshot& base = baseline.phases[phase];
+        histogram.count = 0;
+        for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+            histogram.buckets[i] -= std::min(histogram.buckets[i], base.buckets[i]);
+            histogram.count += histogram.buckets[i];
+        }
+        histogram.total_nanoseconds -= std::min(histogram.total_nanoseconds, base.total_nanoseconds);
+    }
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<const ThreadMetrics*> active;
+    // Данные завершившихся потоков
+    MetricsSnapshot retired;
+    // Состояние на момент последнего ResetMetrics; вычитается из снимков,
+    // чтобы сброс не гонялся с потоками-писателями
+    MetricsSnapshot baseline;
+};
+
+Registry& GetRegistry() {
+    // Не разрушается: thread_local-данные потоков могут пережить статические объекты
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+class ThreadMetricsHolder {
+public:
+    ThreadMetricsHolder()
+        : metrics_(std::make_unique<ThreadMetrics>())
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard guard(registry.mutex);
+        registry.active.push_back(metrics_.get());
+    }
+
+    ~ThreadMetricsHolder() {
+        Registry& registry = GetRegistry();
+        std::lock_guard guard(registry.mutex);
+        MergeInto(registry.retired, *metrics_);
+        registry.active.erase(std::find(registry.active.begin(), registry.active.end(), metrics_.get()));
+    }
+
+    ThreadMetrics& Get() {
+        return *metrics_;
+    }
+
+private:
+    std::unique_ptr<ThreadMetrics> metrics_;
+};
+
+ThreadMetrics& GetThreadMetrics() {
+    thread_local ThreadMetricsHolder holder;
+    return holder.Get();
+}
+
+MetricsSnapshot CollectLocked(Registry& registry) {
+    MetricsSnapshot snapshot = registry.retired;
+    for (const ThreadMetrics* metrics : registry.active) {
+        MergeInto(snapshot, *metrics);
+    }
+    return snapshot;
+}
+
+}  // namespace
+
+namespace metrics_detail {
+
+void AddToCounter(MetricCounter counter, uint64_t value) {
+    AddRelaxed(GetThreadMetrics().counters[static_cast<size_t>(counter)], value);
+}
+
+void RecordLatency(MetricPhase phase, uint64_t nanoseconds) {
+    ThreadMetrics& metrics = GetThreadMetrics();
+    const size_t index = static_cast<size_t>(phase);
+    AddRelaxed(metrics.buckets[index][LatencyHistogram::GetBucketIndex(nanoseconds)], 1);
+    AddRelaxed(metrics.totals[index], nanoseconds);
+}
+
+}  // namespace metrics_detail
+
+MetricsSnapshot TakeMetricsSnapshot() {
+    Registry& registry = GetRegistry();
+    std::lock_guard guard(registry.mutex);
+    MetricsSnapshot snapshot = CollectLocked(registry);
+    Subtract(snapshot, registry.baseline);
+    return snapshot;
+}
+
+void ResetMetrics() {
+    Registry& registry = GetRegistry();
+    std::lock_guard guard(registry.mutex);
+    registry.baseline = CollectLocked(registry);
+}
+
+#else
+
+MetricsSnapshot TakeMetricsSnapshot() {
+    return {};
+}
+
+void ResetMetrics() {
+}
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Метрики собираются, только если проект собран с SEARCH_SERVER_METRICS.
+// Без него макросы ниже раскрываются в пустоту, а снимок метрик всегда пуст
+
+enum class MetricPhase {
+    QUERY_PARSE,
+    POSTING_TRAVERSAL,
+    MINUS_WORD_FILTER,
+    PHRASE_FILTER,
+    TOP_K_SELECTION,
+    FIND_TOP_DOCUMENTS,
+    MATCH_DOCUMENT,
+    ADD_DOCUMENT,
+    REMOVE_DOCUMENT,
+    COUNT,
+};
+
+enum class MetricCounter {
+    QUERIES,
+    POSTINGS_SCANNED,
+    DOCUMENTS_MATCHED,
+    DOCUMENTS_ADDED,
+    DOCUMENTS_REMOVED,
+    DUPLICATES_DETECTED,
+    COUNT,
+};
+
+const char* GetMetricName(MetricPhase phase);
+const char* GetMetricName(MetricCounter counter);
+
+// Логарифмически-линейная гистограмма в духе HdrHistogram: 2^SUB_BUCKET_BITS поддиапазонов
+// на каждую степень двойки, относительная погрешность не больше 1 / 2^SUB_BUCKET_BITS
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    // Значения от 2^41 нс (~37 минут) попадают в последний диапазон
+    static const int MAX_EXPONENT = 40;
+    static const int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT;
+
+    static int GetBucketIndex(uint64_t nanoseconds);
+    // Нижняя граница значений, попадающих в диапазон
+    static uint64_t GetBucketValue(int bucket_index);
+};
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(LatencyHistogram::BUCKET_COUNT);
+    uint64_t count = 0;
+    uint64_t total_nanoseconds = 0;
+
+    // percentile из [0, 100]
+    uint64_t GetPercentile(double percentile) const;
+};
+
+struct MetricsSnapshot {
+    std::array<uint64_t, static_cast<size_t>(MetricCounter::COUNT)> counters{};
+    std::array<HistogramSnapshot, static_cast<size_t>(MetricPhase::COUNT)> phases;
+
+    uint64_t Get(MetricCounter counter) const;
+    const HistogramSnapshot& Get(MetricPhase phase) const;
+};
+
+// Сводит данные всех потоков, включая уже завершившиеся
+MetricsSnapshot TakeMetricsSnapshot();
+void ResetMetrics();
+// Одна JSON-строка: счётчики и для каждой фазы число замеров, среднее и перцентили в наносекундах
+void WriteMetricsJson(std::ostream& output, const MetricsSnapshot& snapshot);
+
+#ifdef SEARCH_SERVER_METRICS
+
+namespace metrics_detail {
+
+void AddToCounter(MetricCounter counter, uint64_t value);
+void RecordLatency(MetricPhase phase, uint64_t nanoseconds);
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(MetricPhase phase)
+        : phase_(phase) {
+    }
+
+    ~ScopedTimer() {
+        const auto duration = std::chrono::steady_clock::now() - start_;
+        RecordLatency(phase_, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const MetricPhase phase_;
+    const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+};
+
+}  // namespace metrics_detail
+
+#define METRICS_CONCAT_INTERNAL(X, Y) X##Y
+#define METRICS_CONCAT(X, Y) METRICS_CONCAT_INTERNAL(X, Y)
+#define SEARCH_METRICS_SCOPE(phase) metrics_detail::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(phase)
+#define SEARCH_METRICS_ADD(counter, value) metrics_detail::AddToCounter((counter), (value))
+
+#else
+
+#define SEARCH_METRICS_SCOPE(phase) static_cast<void>(0)
+#define SEARCH_METRICS_ADD(counter, value) static_cast<void>(sizeof(value))
+
+#endif
@@ -0,0 +1,195 @@
+#include "near_duplicates.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Полосы и строки: наибольшее rows, при котором пара со сходством threshold совпадает хотя бы
+// в одной полосе с вероятностью 1 - (1 - threshold^rows)^bands не меньше min_recall
+std::pair<size_t, size_t> ChooseBanding(const NearDuplicateOptions& options) {
+    size_t best_rows = 1;
+    for (size_t rows = 1; rows <= options.hash_count; ++rows) {
+        const size_t bands = options.hash_count / rows;
+        const double recall = 1.0 - std::pow(1.0 - std::pow(options.threshold, static_cast<double>(rows)),
+            static_cast<double>(bands));
+        if (recall >= options.min_recall) {
+            best_rows = rows;
+        }
+    }
+    return { options.hash_count / best_rows, best_rows };
+}
+
+// Коэффициенты хеш-функций h_i(x) = (a_i * x + b_i) >> 32, a_i нечётные
+std::vector<std::pair<uint64_t, uint64_t>> MakeHashFunctions(size_t count, uint64_t seed) {
+    std::vector<std::pair<uint64_t, uint64_t>> functions(count);
+    uint64_t state = seed;
+    for (auto& [a, b] : functions) {
+        a = perfect_hash::Mix(state += 0x9E3779B97F4A7C15ull) | 1;
+        b = perfect_hash::Mix(state += 0x9E3779B97F4A7C15ull);
+    }
+    return functions;
+}
+
+double ComputeJaccard(const SearchServer::WordFrequencies& lhs, const SearchServer::WordFrequencies& rhs) {
+    if (lhs.empty() && rhs.empty()) {
+        return 1.0;
+    }
+    size_t common = 0;
+    auto left = lhs.begin();
+    auto right = rhs.begin();
+    while (left != lhs.end() && right != rhs.end()) {
+        if (left->first < right->first) {
+            ++left;
+        }
+        else if (right->first < left->first) {
+            ++right;
+        }
+        else {
+            ++common;
+            ++left;
+            ++right;
+        }
+    }
+    return static_cast<double>(common) / static_cast<double>(lhs.size() + rhs.size() - common);
+}
+
+template <typename ExecutionPolicy>
+std::vector<NearDuplicatePair> FindNearDuplicatesImpl(const ExecutionPolicy& policy,
+    const SearchServer& search_server, const NearDuplicateOptions& options, NearDuplicateStats* stats) {
+    if (!(options.threshold > 0.0 && options.threshold <= 1.0) || options.hash_count == 0) {
+        throw std::invalid_argument(std::string("Near duplicate threshold must be in (0, 1] and hash count positive"));
+    }
+    auto start = Clock::now();
+    const auto [bands, rows] = ChooseBanding(options);
+    std::vector<int> ids;
+    std::vector<const SearchServer::WordFrequencies*> documents;
+    for (const int id : search_server) {
+        ids.push_back(id);
+        documents.push_back(&search_server.GetWordFrequencies(id));
+    }
+    const size_t document_count = ids.size();
+    std::vector<size_t> indices(document_count);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+
+    // Хранятся только хеши полос: bands значений на документ вместо hash_count
+    const auto functions = MakeHashFunctions(bands * rows, options.seed);
+    std::vector<uint64_t> band_hashes(bands * document_count);
+    std::for_each(policy, indices.begin(), indices.end(), [&](size_t index) {
+        thread_local std::vector<uint32_t> signature;
+        signature.assign(functions.size(), std::numeric_limits<uint32_t>::max());
+        for (const auto& [word, _] : *documents[index]) {
+            const uint64_t word_hash = perfect_hash::HashWord(word);
+            for (size_t i = 0; i < functions.size(); ++i) {
+                const auto value = static_cast<uint32_t>((functions[i].first * word_hash + functions[i].second) >> 32);
+                signature[i] = std::min(signature[i], value);
+            }
+        }
+        for (size_t band = 0; band < bands; ++band) {
+            uint64_t hash = band;
+            for (size_t row = 0; row < rows; ++row) {
+                hash = perfect_hash::Mix(hash ^ signature[band * rows + row]);
+            }
+            band_hashes[band * document_count + index] = hash;
+        }
+    });
+    if (stats) {
+        stats->signature_time = Clock::now() - start;
+        start = Clock::now();
+    }
+
+    // Кандидаты - пары номеров документов (меньший в старших 32 битах)
+    std::vector<std::vector<uint64_t>> band_candidates(bands);
+    std::vector<size_t> band_indices(bands);
+    std::iota(band_indices.begin(), band_indices.end(), size_t(0));
+    std::for_each(policy, band_indices.begin(), band_indices.end(), [&](size_t band) {
+        std::vector<std::pair<uint64_t, uint32_t>> buckets(document_count);
+        for (size_t index = 0; index < document_count; ++index) {
+            buckets[index] = { band_hashes[band * document_count + index], static_cast<uint32_t>(index) };
+        }
+        std::sort(buckets.begin(), buckets.end());
+        auto& candidates = band_candidates[band];
+        for (size_t begin = 0; begin < buckets.size();) {
+            size_t end = begin + 1;
+            while (end < buckets.size() && buckets[end].first == buckets[begin].first) {
+                ++end;
+            }
+            const size_t first_end = end - begin > options.max_bucket_size ? begin + 1 : end;
+            for (size_t i = begin; i < first_end; ++i) {
+                for (size_t j = i + 1; j < end; ++j) {
+                    candidates.push_back(static_cast<uint64_t>(buckets[i].second) << 32 | buckets[j].second);
+                }
+            }
+            begin = end;
+        }
+    });
+    std::vector<uint64_t> candidates;
+    for (auto& band : band_candidates) {
+        candidates.insert(candidates.end(), band.begin(), band.end());
+        std::vector<uint64_t>().swap(band);
+    }
+    std::sort(policy, candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    if (stats) {
+        stats->bands = bands;
+        stats->rows = rows;
+        stats->candidate_pairs = candidates.size();
+        stats->banding_time = Clock::now() - start;
+        start = Clock::now();
+    }
+
+    std::vector<double> similarities(candidates.size());
+    std::transform(policy, candidates.begin(), candidates.end(), similarities.begin(), [&](uint64_t pair) {
+        return ComputeJaccard(*documents[pair >> 32], *documents[pair & 0xFFFFFFFFu]);
+    });
+    std::vector<NearDuplicatePair> result;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        // Сравнение с запасом: 4/5 в double может оказаться чуть меньше порога 0.8
+        if (similarities[i] >= options.threshold - 1e-12) {
+            result.push_back({ ids[candidates[i] >> 32], ids[candidates[i] & 0xFFFFFFFFu], similarities[i] });
+        }
+    }
+    if (stats) {
+        stats->verification_time = Clock::now() - start;
+    }
+    return result;
+}
+
+}  // namespace
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const std::execution::sequenced_policy& policy,
+    const SearchServer& search_server, const NearDuplicateOptions& options, NearDuplicateStats* stats) {
+    return FindNearDuplicatesImpl(policy, search_server, options, stats);
+}
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const std::execution::parallel_policy& policy,
+    const SearchServer& search_server, const NearDuplicateOptions& options, NearDuplicateStats* stats) {
+    return FindNearDuplicatesImpl(policy, search_server, options, stats);
+}
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const SearchServer& search_server,
+    const NearDuplicateOptions& options) {
+    return FindNearDuplicates(std::execution::seq, search_server, options);
+}
+
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options) {
+    // Пары идут по возрастанию первого id: к моменту его пар уже известно, остаётся ли он сам
+    std::set<int> ids_to_remove;
+    for (const auto& pair : FindNearDuplicates(std::execution::par, search_server, options)) {
+        if (ids_to_remove.count(pair.first_id) == 0) {
+            ids_to_remove.insert(pair.second_id);
+        }
+    }
+    for (const int id : ids_to_remove) {
+        std::cout << std::string("Found near duplicate document id ") << id << std::endl;
+        search_server.RemoveDocument(id);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <execution>
+#include <vector>
+
+#include "search_server.h"
+
+struct NearDuplicateOptions {
+    // Наименьшее сходство Жаккара наборов слов документов (без стоп-слов), от 0 до 1
+    double threshold = 0.8;
+    // Число хеш-функций MinHash. Подписи делятся на полосы по rows значений так, чтобы пара
+    // со сходством threshold стала кандидатом с вероятностью не меньше min_recall, а rows было наибольшим
+    size_t hash_count = 128;
+    double min_recall = 0.95;
+    // Документы с одинаковой полосой сравниваются попарно, если их не больше max_bucket_size,
+    // иначе - только с первым документом полосы: так число кандидатов не растёт квадратично
+    size_t max_bucket_size = 256;
+    uint64_t seed = 42;
+};
+
+struct NearDuplicatePair {
+    // first_id < second_id
+    int first_id;
+    int second_id;
+    // Точное сходство Жаккара
+    double similarity;
+};
+
+struct NearDuplicateStats {
+    size_t bands = 0;
+    size_t rows = 0;
+    size_t candidate_pairs = 0;
+    std::chrono::nanoseconds signature_time{ 0 };
+    std::chrono::nanoseconds banding_time{ 0 };
+    std::chrono::nanoseconds verification_time{ 0 };
+};
+
+// Пары документов со сходством не меньше options.threshold по возрастанию id. Подписи MinHash строятся
+// по словам GetWordFrequencies, кандидаты находятся по совпадающим полосам подписей (LSH) и проверяются
+// точным сходством, поэтому ложных пар нет, а пропуск пары со сходством threshold маловероятен.
+// Время - O(n log n) от числа документов плюс число кандидатов. Бросает std::invalid_argument
+// при threshold вне (0, 1] или hash_count == 0
+std::vector<NearDuplicatePair> FindNearDuplicates(const std::execution::sequenced_policy& policy,
+    const SearchServer& search_server, const NearDuplicateOptions& options = {}, NearDuplicateStats* stats = nullptr);
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const std::execution::parallel_policy& policy,
+    const SearchServer& search_server, const NearDuplicateOptions& options = {}, NearDuplicateStats* stats = nullptr);
+
+std::vector<NearDuplicatePair> FindNearDuplicates(const SearchServer& search_server,
+    const NearDuplicateOptions& options = {});
+
+// Удаляет документы, у которых есть оставшийся в индексе близкий дубликат с меньшим id
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options = {});
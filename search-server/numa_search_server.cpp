@@ -0,0 +1,102 @@
+#include "numa_search_server.h"
+
+#include <sstream>
+
+#include "snapshot.h"
+
+NumaSearchServer::NumaSearchServer(const SearchServer& search_server, NumaSearchOptions options)
+    : search_server_(search_server)
+    , topology_(options.topology.empty() ? ReadNumaTopology() : std::move(options.topology))
+{
+    if (options.max_nodes > 0 && topology_.size() > options.max_nodes) {
+        topology_.resize(options.max_nodes);
+    }
+    for (const NumaNode& node : topology_) {
+        SearchExecutorConfig config;
+        config.thread_count = options.threads_per_node > 0 ? options.threads_per_node
+            : std::max<size_t>(node.cpus.size(), 1);
+        // Очередь не ограничена: ProcessQueries ставит задачи сразу для всех потоков
+        config.max_queue_depth = 0;
+        config.cpu_affinity = node.cpus;
+        executors_.push_back(std::make_unique<SearchExecutor>(config));
+    }
+    if (!options.replicate || topology_.size() < 2) {
+        return;
+    }
+
+    // Снимок пишется один раз, копии читают его одновременно на своих узлах
+    std::ostringstream output;
+    WriteSnapshot(search_server_, output);
+    const std::string snapshot = output.str();
+    SearchServerOptions replica_options = search_server_.GetOptions();
+    // Ресурс исходного сервера не привязан к узлу и может быть непотокобезопасным, а копии строятся
+    // одновременно: их память берётся из ресурса по умолчанию потоком узла
+    replica_options.memory_resource = nullptr;
+    const int impact_bits = search_server_.GetImpactIndexBits();
+    std::vector<std::future<std::unique_ptr<SearchServer>>> replicas;
+    for (const auto& executor : executors_) {
+        replicas.push_back(executor->Submit([&snapshot, &replica_options, impact_bits]() {
+            std::istringstream input(snapshot);
+            auto replica = std::make_unique<SearchServer>(ReadSnapshot(input, replica_options));
+            if (impact_bits > 0) {
+                replica->BuildImpactIndex(impact_bits);
+            }
+            return replica;
+        }));
+    }
+    for (auto& replica : replicas) {
+        replicas_.push_back(replica.get());
+    }
+}
+
+size_t NumaSearchServer::GetNodeCount() const {
+    return topology_.size();
+}
+
+size_t NumaSearchServer::GetReplicaCount() const {
+    return replicas_.size();
+}
+
+const std::vector<NumaNode>& NumaSearchServer::GetTopology() const {
+    return topology_;
+}
+
+std::future<std::vector<Document>> NumaSearchServer::FindTopDocuments(std::string raw_query,
+    DocumentStatus status) const {
+    const size_t node = next_node_++ % executors_.size();
+    const SearchServer& index = GetIndex(node);
+    return executors_[node]->Submit([&index, raw_query = std::move(raw_query), status]() {
+        return index.FindTopDocuments(raw_query, status);
+    });
+}
+
+std::vector<std::vector<Document>> NumaSearchServer::ProcessQueries(const std::vector<std::string>& queries) const {
+    std::vector<std::vector<Document>> result(queries.size());
+    std::vector<std::atomic<size_t>> next_queries(executors_.size());
+    std::vector<std::future<void>> workers;
+    for (size_t node = 0; node < executors_.size(); ++node) {
+        const size_t first = queries.size() * node / executors_.size();
+        const size_t last = queries.size() * (node + 1) / executors_.size();
+        next_queries[node] = first;
+        for (size_t i = 0; i < executors_[node]->GetThreadCount(); ++i) {
+            workers.push_back(executors_[node]->Submit([&, node, last]() {
+                const SearchServer& index = GetIndex(node);
+                for (size_t query = next_queries[node]++; query < last; query = next_queries[node]++) {
+                    result[query] = index.FindTopDocuments(queries[query]);
+                }
+            }));
+        }
+    }
+    // Все задачи дожидаются завершения до выхода, даже если одна из них бросила исключение
+    for (auto& worker : workers) {
+        worker.wait();
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+    return result;
+}
+
+const SearchServer& NumaSearchServer::GetIndex(size_t node) const {
+    return replicas_.empty() ? search_server_ : *replicas_[node];
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "numa_topology.h"
+#include "search_executor.h"
+#include "search_server.h"
+
+struct NumaSearchOptions {
+    // Копия индекса на каждом узле: память копии выделяется потоком, закреплённым за узлом, и по политике
+    // первого касания ядро размещает её в памяти этого узла. Без копий все узлы читают исходный индекс
+    bool replicate = true;
+    // Не больше стольких узлов; 0 - все
+    size_t max_nodes = 0;
+    // Потоков на узел; 0 - по числу процессоров узла
+    size_t threads_per_node = 0;
+    // Пустая - ReadNumaTopology()
+    std::vector<NumaNode> topology;
+};
+
+// Выполнение запросов потоками, закреплёнными за узлами NUMA, каждый узел - по своей копии индекса.
+// На машине с одним узлом копий нет: запросы выполняются по исходному индексу потоками,
+// закреплёнными за процессорами. Копии создаются с настройками исходного сервера (GetOptions) и
+// повторяют его списки по вкладу. Исходный сервер не должен меняться, пока объект жив
+class NumaSearchServer {
+public:
+    explicit NumaSearchServer(const SearchServer& search_server, NumaSearchOptions options = NumaSearchOptions{});
+
+    size_t GetNodeCount() const;
+    // 0, если копий нет
+    size_t GetReplicaCount() const;
+    const std::vector<NumaNode>& GetTopology() const;
+
+    // Узлы выбираются по очереди
+    std::future<std::vector<Document>> FindTopDocuments(std::string raw_query,
+        DocumentStatus status = DocumentStatus::ACTUAL) const;
+
+    // Запросы делятся между узлами поровну, внутри узла потоки берут их по одному. Результат - в порядке запросов
+    std::vector<std::vector<Document>> ProcessQueries(const std::vector<std::string>& queries) const;
+
+private:
+    const SearchServer& GetIndex(size_t node) const;
+
+    const SearchServer& search_server_;
+    std::vector<NumaNode> topology_;
+    std::vector<std::unique_ptr<SearchExecutor>> executors_;
+    std::vector<std::unique_ptr<SearchServer>> replicas_;
+    mutable std::atomic<size_t> next_node_{ 0 };
+};
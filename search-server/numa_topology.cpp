@@ -0,0 +1,108 @@
+#include "numa_topology.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+int ParseCpu(std::string_view text) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || error != std::errc() || end != text.data() + text.size() || value < 0) {
+        throw std::invalid_argument(std::string("Invalid CPU number '") + std::string(text) + std::string("'"));
+    }
+    return value;
+}
+
+// Процессоры, на которых процессу разрешено работать
+std::vector<int> GetAllowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &cpu_set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+}  // namespace
+
+std::vector<int> ParseCpuList(std::string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.remove_suffix(1);
+    }
+    std::vector<int> cpus;
+    while (!text.empty()) {
+        const size_t comma = std::min(text.find(','), text.size());
+        const std::string_view range = text.substr(0, comma);
+        text.remove_prefix(std::min(comma + 1, text.size()));
+        const size_t dash = range.find('-');
+        const int first = ParseCpu(range.substr(0, dash));
+        const int last = dash == std::string_view::npos ? first : ParseCpu(range.substr(dash + 1));
+        if (last < first) {
+            throw std::invalid_argument(std::string("Invalid CPU range '") + std::string(range) + std::string("'"));
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+std::vector<NumaNode> ReadNumaTopology(const std::string& sysfs_root) {
+    const std::vector<int> allowed = GetAllowedCpus();
+    std::vector<NumaNode> nodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(sysfs_root, error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0
+            || !std::all_of(name.begin() + 4, name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        std::ifstream input(entry.path() / "cpulist");
+        std::string cpulist;
+        std::getline(input, cpulist);
+        NumaNode node;
+        node.id = std::stoi(name.substr(4));
+        try {
+            for (const int cpu : ParseCpuList(cpulist)) {
+                if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+                    node.cpus.push_back(cpu);
+                }
+            }
+        }
+        catch (const std::invalid_argument&) {
+            continue;
+        }
+        // Узлы только с памятью и узлы вне маски процесса не нужны для выполнения запросов
+        if (!node.cpus.empty()) {
+            nodes.push_back(std::move(node));
+        }
+    }
+    if (nodes.empty()) {
+        return { NumaNode{ 0, allowed } };
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const NumaNode& lhs, const NumaNode& rhs) { return lhs.id < rhs.id; });
+    return nodes;
+}
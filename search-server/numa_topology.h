@@ -0,0 +1,17 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct NumaNode {
+    int id = 0;
+    // Логические процессоры узла, доступные процессу
+    std::vector<int> cpus;
+};
+
+// Узлы из sysfs_root/nodeN/cpulist, только с доступными процессу (sched_getaffinity) процессорами.
+// Без NUMA (нет каталога, не Linux, один узел без процессоров) - один узел 0 со всеми доступными процессорами
+std::vector<NumaNode> ReadNumaTopology(const std::string& sysfs_root = std::string("/sys/devices/system/node"));
+
+// Разбирает список процессоров ядра Linux: "0-3,8,10-11". Бросает std::invalid_argument при ошибке
+std::vector<int> ParseCpuList(std::string_view text);
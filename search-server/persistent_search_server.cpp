@@ -0,0 +1,161 @@
+#include "persistent_search_server.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const SNAPSHOT_FILE_NAME = "snapshot";
+const char* const SNAPSHOT_TEMP_FILE_NAME = "snapshot.tmp";
+const char* const LOG_FILE_NAME = "wal";
+
+// Сбрасывает на диск файл или каталог (для каталога - записи о переименованных файлах)
+void SyncPath(const std::filesystem::path& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("Cannot open ") + path.string() + std::string(": ")
+            + std::strerror(errno));
+    }
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        throw std::runtime_error(std::string("Cannot sync ") + path.string());
+    }
+}
+
+void SaveSnapshot(const SearchServer& server, const std::filesystem::path& directory, uint64_t last_sequence) {
+    const auto temp_path = directory / SNAPSHOT_TEMP_FILE_NAME;
+    {
+        std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+        if (!output) {
+            throw std::runtime_error(std::string("Cannot create ") + temp_path.string());
+        }
+        WriteSnapshot(server, output, last_sequence);
+        output.close();
+        if (!output) {
+            throw std::runtime_error(std::string("Cannot write ") + temp_path.string());
+        }
+    }
+    SyncPath(temp_path);
+    std::filesystem::rename(temp_path, directory / SNAPSHOT_FILE_NAME);
+    SyncPath(directory);
+}
+
+}  // namespace
+
+PersistentSearchServer::PersistentSearchServer(const std::filesystem::path& directory,
+    std::string_view stop_words_text, const PersistenceOptions& options)
+    : directory_(directory)
+    , server_(LoadSnapshot(directory, stop_words_text, options.server, recovery_stats_))
+{
+    const auto start = std::chrono::steady_clock::now();
+    ReplayLog(options);
+    recovery_stats_.duration += std::chrono::steady_clock::now() - start;
+}
+
+SearchServer PersistentSearchServer::LoadSnapshot(const std::filesystem::path& directory,
+    std::string_view stop_words_text, const SearchServerOptions& options, RecoveryStats& stats) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto snapshot_path = directory / SNAPSHOT_FILE_NAME;
+    if (!std::filesystem::exists(snapshot_path)) {
+        // Новый каталог: пустой снимок сохраняет стоп-слова
+        std::filesystem::create_directories(directory);
+        SearchServer server(stop_words_text, options);
+        SaveSnapshot(server, directory, 0);
+        stats.duration = std::chrono::steady_clock::now() - start;
+        return server;
+    }
+    std::ifstream input(snapshot_path, std::ios::binary);
+    if (!input) {
+        throw std::runtime_error(std::string("Cannot open ") + snapshot_path.string());
+    }
+    SearchServer server = ReadSnapshot(input, options, &stats.snapshot_sequence);
+    stats.snapshot_documents = static_cast<size_t>(server.GetDocumentCount());
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return server;
+}
+
+void PersistentSearchServer::ReplayLog(const PersistenceOptions& options) {
+    const std::string log_path = (directory_ / LOG_FILE_NAME).string();
+    const uint64_t snapshot_sequence = recovery_stats_.snapshot_sequence;
+    const LogReadResult result = ReadLog(log_path, [this, snapshot_sequence](const LogRecord& record) {
+        if (record.sequence <= snapshot_sequence) {
+            return;
+        }
+        // Журнал содержит только принятые индексом операции. Если запись не применяется, журнал не
+        // соответствует снимку или настройкам сервера, и пропуск записи молча потерял бы данные
+        try {
+            if (record.type == LogRecordType::ADD_DOCUMENT) {
+                server_.AddDocument(record.document_id, record.text, record.status, record.ratings);
+            }
+            else {
+                server_.RemoveDocument(record.document_id);
+            }
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error(std::string("Cannot replay log record ") + std::to_string(record.sequence)
+                + std::string(": ") + e.what());
+        }
+        ++recovery_stats_.replayed_records;
+    });
+    recovery_stats_.discarded_log_bytes = result.discarded_bytes;
+    if (result.discarded_bytes > 0) {
+        TruncateFile(log_path, result.valid_bytes);
+    }
+    log_ = std::make_unique<WriteAheadLog>(log_path, std::max(snapshot_sequence, result.last_sequence) + 1,
+        options.log);
+}
+
+int PersistentSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
+    const std::vector<int>& ratings) {
+    // В журнал идёт исходный id: при проигрывании замена дубликата повторится так же
+    const int stored_id = server_.AddDocument(document_id, document, status, ratings);
+    const uint64_t last_sequence = log_->GetLastSequence();
+    try {
+        log_->AppendAddDocument(document_id, document, status, ratings);
+    }
+    catch (...) {
+        // Если запись уже в буфере журнала, ошибка произошла при фиксации: запись уйдёт на диск
+        // со следующим Sync, и документ должен остаться в индексе. Заменённый при SUPERSEDE дубликат
+        // откат не возвращает - он останется в журнале и появится после переоткрытия
+        if (log_->GetLastSequence() == last_sequence) {
+            server_.RemoveDocument(stored_id);
+        }
+        throw;
+    }
+    return stored_id;
+}
+
+void PersistentSearchServer::RemoveDocument(int document_id) {
+    // Удаление не может завершиться ошибкой, поэтому запись в журнале идёт первой;
+    // удаление отсутствующего документа при проигрывании ничего не меняет
+    log_->AppendRemoveDocument(document_id);
+    server_.RemoveDocument(document_id);
+}
+
+void PersistentSearchServer::Sync() {
+    log_->Sync();
+}
+
+void PersistentSearchServer::Checkpoint() {
+    log_->Sync();
+    SaveSnapshot(server_, directory_, log_->GetLastSequence());
+    log_->Reset();
+}
+
+const SearchServer& PersistentSearchServer::GetServer() const {
+    return server_;
+}
+
+const WriteAheadLog& PersistentSearchServer::GetLog() const {
+    return *log_;
+}
+
+const RecoveryStats& PersistentSearchServer::GetRecoveryStats() const {
+    return recovery_stats_;
+}
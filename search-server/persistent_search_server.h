@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "search_server.h"
+#include "snapshot.h"
+#include "write_ahead_log.h"
+
+struct PersistenceOptions {
+    SearchServerOptions server;
+    WriteAheadLogOptions log;
+};
+
+struct RecoveryStats {
+    size_t snapshot_documents = 0;
+    uint64_t snapshot_sequence = 0;
+    size_t replayed_records = 0;
+    // Оборванный хвост журнала, отброшенный при восстановлении
+    size_t discarded_log_bytes = 0;
+    std::chrono::nanoseconds duration{};
+};
+
+// Сервер, изменения которого сохраняются в каталоге: снимок (файл snapshot) и журнал операций
+// после него (файл wal). При открытии загружается снимок и проигрываются только операции журнала,
+// поэтому время восстановления определяется числом изменений после последней контрольной точки.
+// AddDocument сначала применяется к индексу (и проверяется им), затем пишется в журнал.
+// Запись журнала, которую не удаётся применить при открытии, - ошибка: конструктор бросает
+// std::runtime_error с её номером
+class PersistentSearchServer {
+public:
+    // stop_words_text используется только при создании нового каталога, дальше стоп-слова берутся из снимка
+    PersistentSearchServer(const std::filesystem::path& directory, std::string_view stop_words_text,
+        const PersistenceOptions& options = PersistenceOptions{});
+
+    // Возвращает id, под которым документ сохранён в индексе (см. SearchServer::AddDocument)
+    int AddDocument(int document_id, std::string_view document, DocumentStatus status,
+        const std::vector<int>& ratings);
+    void RemoveDocument(int document_id);
+
+    // Фиксирует на диске все записанные операции
+    void Sync();
+
+    // Сохраняет индекс в новый снимок и очищает журнал. Снимок пишется во временный файл
+    // и подменяет старый атомарно; если процесс упадёт до очистки журнала, его записи, уже
+    // вошедшие в снимок, будут пропущены по номерам
+    void Checkpoint();
+
+    const SearchServer& GetServer() const;
+    const WriteAheadLog& GetLog() const;
+    const RecoveryStats& GetRecoveryStats() const;
+
+private:
+    static SearchServer LoadSnapshot(const std::filesystem::path& directory, std::string_view stop_words_text,
+        const SearchServerOptions& options, RecoveryStats& stats);
+
+    void ReplayLog(const PersistenceOptions& options);
+
+    std::filesystem::path directory_;
+    RecoveryStats recovery_stats_;
+    SearchServer server_;
+    std::unique_ptr<WriteAheadLog> log_;
+};
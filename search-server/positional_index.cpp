@@ -0,0 +1,157 @@
+#include "positional_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+void AppendVarint(uint32_t value, std::pmr::string& output) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<char>(value));
+}
+
+// Слова подряд: позиция первого слова p, i-го - p + i
+bool ContainsSequence(const std::vector<std::vector<uint32_t>>& positions, size_t word_count) {
+    std::vector<size_t> cursors(word_count, 0);
+    for (const uint32_t start : positions[0]) {
+        bool found = true;
+        for (size_t i = 1; i < word_count && found; ++i) {
+            const auto& list = positions[i];
+            size_t& cursor = cursors[i];
+            while (cursor < list.size() && list[cursor] < start + i) {
+                ++cursor;
+            }
+            if (cursor == list.size()) {
+                return false;
+            }
+            found = list[cursor] == start + i;
+        }
+        if (found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Наименьшее окно, в котором есть позиция каждого слова: двигается указатель списка с наименьшей позицией
+bool ContainsWithinWindow(const std::vector<std::vector<uint32_t>>& positions, size_t word_count, size_t window) {
+    std::vector<size_t> cursors(word_count, 0);
+    while (true) {
+        size_t min_list = 0;
+        uint32_t max_position = 0;
+        for (size_t i = 0; i < word_count; ++i) {
+            const uint32_t position = positions[i][cursors[i]];
+            if (position < positions[min_list][cursors[min_list]]) {
+                min_list = i;
+            }
+            max_position = std::max(max_position, position);
+        }
+        if (max_position - positions[min_list][cursors[min_list]] < window) {
+            return true;
+        }
+        if (++cursors[min_list] == positions[min_list].size()) {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+DocumentPositions::DocumentPositions(std::pmr::memory_resource* resource)
+    : offsets_(resource)
+    , data_(resource)
+{
+}
+
+void DocumentPositions::Build(const std::vector<std::string_view>& words) {
+    std::vector<std::pair<std::string_view, uint32_t>> occurrences;
+    occurrences.reserve(words.size());
+    for (size_t position = 0; position < words.size(); ++position) {
+        occurrences.emplace_back(words[position], static_cast<uint32_t>(position));
+    }
+    std::sort(occurrences.begin(), occurrences.end());
+
+    offsets_.clear();
+    data_.clear();
+    uint32_t previous = 0;
+    for (size_t i = 0; i < occurrences.size(); ++i) {
+        const auto [word, position] = occurrences[i];
+        if (i == 0 || occurrences[i - 1].first != word) {
+            offsets_.emplace_back(word, static_cast<uint32_t>(data_.size()));
+            previous = 0;
+        }
+        AppendVarint(position - previous, data_);
+        previous = position;
+    }
+    offsets_.shrink_to_fit();
+    data_.shrink_to_fit();
+}
+
+void DocumentPositions::Assign(const std::vector<std::pair<std::string_view, uint32_t>>& offsets,
+    std::string_view data) {
+    offsets_.assign(offsets.begin(), offsets.end());
+    data_.assign(data);
+}
+
+std::string_view DocumentPositions::Find(std::string_view word) const {
+    const auto it = std::lower_bound(offsets_.begin(), offsets_.end(), word,
+        [](const auto& entry, std::string_view value) { return entry.first < value; });
+    if (it == offsets_.end() || it->first != word) {
+        return {};
+    }
+    const size_t end = std::next(it) == offsets_.end() ? data_.size() : std::next(it)->second;
+    return std::string_view(data_).substr(it->second, end - it->second);
+}
+
+const DocumentPositions::Offsets& DocumentPositions::GetOffsets() const {
+    return offsets_;
+}
+
+std::string_view DocumentPositions::GetData() const {
+    return data_;
+}
+
+void DecodePositions(std::string_view encoded, std::vector<uint32_t>& positions) {
+    positions.clear();
+    uint32_t position = 0;
+    uint32_t delta = 0;
+    int shift = 0;
+    for (const char c : encoded) {
+        const auto byte = static_cast<uint8_t>(c);
+        delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        position += delta;
+        positions.push_back(position);
+        delta = 0;
+        shift = 0;
+    }
+}
+
+bool ContainsPhrase(const DocumentPositions& document, const std::vector<std::string_view>& words, size_t window) {
+    if (words.empty()) {
+        return false;
+    }
+    thread_local std::vector<std::string_view> encoded;
+    encoded.clear();
+    for (const std::string_view word : words) {
+        encoded.push_back(document.Find(word));
+        if (encoded.back().empty()) {
+            return false;
+        }
+    }
+    thread_local std::vector<std::vector<uint32_t>> positions;
+    if (positions.size() < words.size()) {
+        positions.resize(words.size());
+    }
+    for (size_t i = 0; i < words.size(); ++i) {
+        DecodePositions(encoded[i], positions[i]);
+    }
+    return window == 0 ? ContainsSequence(positions, words.size())
+        : ContainsWithinWindow(positions, words.size(), window);
+}
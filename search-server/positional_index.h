@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Позиции слов одного документа. Позиция - номер слова среди слов документа без стоп-слов.
+// Списки позиций слов лежат подряд в одной строке: разности соседних позиций в varint (LEB128)
+class DocumentPositions {
+public:
+    // Слово и смещение начала его списка; по возрастанию слов
+    using Offsets = std::pmr::vector<std::pair<std::string_view, uint32_t>>;
+
+    explicit DocumentPositions(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // words - слова документа по порядку. Должны жить дольше объекта: сервер передаёт слова словаря
+    void Build(const std::vector<std::string_view>& words);
+
+    // Готовые списки из снимка; offsets по возрастанию слов и смещений, смещения не больше data.size()
+    void Assign(const std::vector<std::pair<std::string_view, uint32_t>>& offsets, std::string_view data);
+
+    // Закодированный список позиций слова; пустой, если слова в документе нет
+    std::string_view Find(std::string_view word) const;
+
+    const Offsets& GetOffsets() const;
+    std::string_view GetData() const;
+
+private:
+    Offsets offsets_;
+    std::pmr::string data_;
+};
+
+void DecodePositions(std::string_view encoded, std::vector<uint32_t>& positions);
+
+// Есть ли в документе слова words: при window == 0 - подряд и в заданном порядке (фраза),
+// иначе - в любом порядке в пределах window соседних позиций. Позиции читаются, только если
+// в документе есть все слова
+bool ContainsPhrase(const DocumentPositions& document, const std::vector<std::string_view>& words, size_t window);
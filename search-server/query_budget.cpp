@@ -0,0 +1,39 @@
+#include "query_budget.h"
+
+namespace {
+
+std::chrono::steady_clock::time_point ComputeDeadline(std::chrono::steady_clock::duration max_time) {
+    const auto now = std::chrono::steady_clock::now();
+    if (max_time >= std::chrono::steady_clock::time_point::max() - now) {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return now + max_time;
+}
+
+}  // namespace
+
+QueryBudgetTracker::QueryBudgetTracker(const QueryBudget& budget)
+    : deadline_(ComputeDeadline(budget.max_time))
+    , max_postings_(budget.max_postings)
+{
+}
+
+bool QueryBudgetTracker::Consume(size_t postings) {
+    if (exhausted_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    const size_t scanned_before = scanned_postings_.fetch_add(postings, std::memory_order_relaxed);
+    if (scanned_before >= max_postings_ || Clock::now() >= deadline_) {
+        exhausted_.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool QueryBudgetTracker::IsExhausted() const {
+    return exhausted_.load(std::memory_order_relaxed);
+}
+
+size_t QueryBudgetTracker::GetScannedPostings() const {
+    return scanned_postings_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "document.h"
+
+// Ограничения на выполнение одного запроса; по умолчанию ограничений нет
+struct QueryBudget {
+    std::chrono::steady_clock::duration max_time = std::chrono::steady_clock::duration::max();
+    size_t max_postings = std::numeric_limits<size_t>::max();
+};
+
+struct SearchResult {
+    std::vector<Document> documents;
+    // true, если бюджет исчерпан и documents - лучшие из просмотренных
+    bool truncated = false;
+};
+
+class QueryBudgetTracker {
+public:
+    // Обход индекса резервирует записи пачками, чтобы не трогать часы и атомики на каждом документе,
+    // поэтому max_postings может быть превышен меньше чем на CHECK_INTERVAL на каждое слово запроса
+    static const size_t CHECK_INTERVAL = 64;
+
+    explicit QueryBudgetTracker(const QueryBudget& budget);
+
+    // Резервирует очередную пачку записей; false означает, что бюджет исчерпан и обход надо прекратить
+    bool Consume(size_t postings);
+    bool IsExhausted() const;
+    size_t GetScannedPostings() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const Clock::time_point deadline_;
+    const size_t max_postings_;
+    std::atomic<size_t> scanned_postings_ = 0;
+    std::atomic<bool> exhausted_ = false;
+};
@@ -0,0 +1,26 @@
+#include "query_stats.h"
+
+std::ostream& operator<<(std::ostream& output, const QueryStats& stats) {
+    output << "policy: " << stats.execution_policy << std::endl;
+    for (const QueryTermStats& term : stats.terms) {
+        output << "  term " << (term.is_minus ? "-" : "+") << term.word
+            << " df = " << term.document_freq
+            << " idf = " << term.inverse_document_freq << std::endl;
+    }
+    if (stats.truncated_expansions > 0) {
+        output << "truncated expansions: " << stats.truncated_expansions << std::endl;
+    }
+    output << "postings scanned: " << stats.postings_scanned << std::endl
+        << "candidates created: " << stats.candidates_created << std::endl
+        << "rejected by predicate: " << stats.rejected_by_predicate << std::endl
+        << "rejected by minus words: " << stats.rejected_by_minus_words << std::endl
+        << "rejected by phrases: " << stats.rejected_by_phrases << std::endl
+        << "documents returned: " << stats.documents_returned << std::endl
+        << "cached terms: " << stats.cached_terms << std::endl
+        << "time, ns: parse " << stats.parse_time.count()
+        << ", traversal " << stats.traversal_time.count()
+        << ", minus filter " << stats.minus_filter_time.count()
+        << ", phrase filter " << stats.phrase_filter_time.count()
+        << ", top-k " << stats.top_k_time.count() << std::endl;
+    return output;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <execution>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct QueryTermStats {
+    std::string word;
+    bool is_minus = false;
+    // Число документов со словом и его IDF; для отсутствующих в индексе слов оба равны нулю
+    size_t document_freq = 0;
+    double inverse_document_freq = 0.0;
+};
+
+// Статистика выполнения одного запроса (аналог EXPLAIN). Заполняется FindTopDocuments и MatchDocument,
+// если им передан объект статистики; без него накладных расходов нет
+struct QueryStats {
+    std::string execution_policy;
+    // Слова запроса после отбрасывания стоп-слов, без повторов; шаблоны (cat*) раскрыты в слова словаря
+    std::vector<QueryTermStats> terms;
+    // Плюс-шаблоны, раскрытие которых обрезано пределом SearchServerOptions::max_term_expansion
+    size_t truncated_expansions = 0;
+    // Прочитанные записи индекса. Для MatchDocument - число списков документов слов, в которых искался документ
+    size_t postings_scanned = 0;
+    // Документы, прошедшие предикат хотя бы по одному плюс-слову
+    size_t candidates_created = 0;
+    // Записи индекса, отброшенные предикатом: документ считается по разу на каждое своё слово запроса
+    size_t rejected_by_predicate = 0;
+    // Кандидаты, исключённые минус-словами
+    size_t rejected_by_minus_words = 0;
+    // Кандидаты без фразы запроса или с минус-фразой
+    size_t rejected_by_phrases = 0;
+    size_t documents_returned = 0;
+    // Слова запроса, прочитанные из срезов кеша частых слов (SearchServerOptions::hot_terms): записи
+    // других статусов в срезах отброшены заранее, поэтому не входят в postings_scanned и rejected_by_predicate
+    size_t cached_terms = 0;
+    std::chrono::nanoseconds parse_time{};
+    std::chrono::nanoseconds traversal_time{};
+    // Последовательный поиск проверяет минус-слова в том же обходе по окнам: их время входит в traversal_time
+    std::chrono::nanoseconds minus_filter_time{};
+    std::chrono::nanoseconds phrase_filter_time{};
+    std::chrono::nanoseconds top_k_time{};
+};
+
+std::ostream& operator<<(std::ostream& output, const QueryStats& stats);
+
+template <typename ExecutionPolicy>
+const char* GetExecutionPolicyName() {
+    using Policy = std::decay_t<ExecutionPolicy>;
+    if constexpr (std::is_same_v<Policy, std::execution::sequenced_policy>) {
+        return "seq";
+    }
+    else if constexpr (std::is_same_v<Policy, std::execution::parallel_policy>) {
+        return "par";
+    }
+    else if constexpr (std::is_same_v<Policy, std::execution::parallel_unsequenced_policy>) {
+        return "par_unseq";
+    }
+    else {
+        return "unknown";
+    }
+}
@@ -1,6 +1,6 @@
-#pragma once
-#include<string>
-
-std::string ReadLine();
-
+#pragma once
+#include<string>
+
+std::string ReadLine();
+
 int ReadLineWithNumber();
\ No newline at end of file
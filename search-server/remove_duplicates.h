@@ -1,4 +1,4 @@
-#pragma once
-#include "search_server.h"
-
+#pragma once
+#include "search_server.h"
+
 void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
@@ -1,41 +1,41 @@
-#pragma once
-
-#include <deque>
-#include "search_server.h"
-#include "document.h"
-
-
-class RequestQueue {
-public:
-    explicit RequestQueue(const SearchServer& search_server);
-
-    template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate);
-
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
-
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
-
-    int GetNoResultRequests() const;
-
-private:
-    struct QueryResult {
-        std::vector<Document> documents;
-    };
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
-    const SearchServer& search_server_;
-    int current_requests_count = 0;
-};
-
-template <typename DocumentPredicate>
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
-    current_requests_count++;
-    if (current_requests_count > min_in_day_) {
-        requests_.pop_front();
-        current_requests_count--;
-    }
-    requests_.push_back({ search_server_.FindTopDocuments(raw_query, document_predicate) });
-
-    return search_server_.FindTopDocuments(raw_query, document_predicate);
+#pragma once
+
+#include <deque>
+#include "search_server.h"
+#include "document.h"
+
+
+class RequestQueue {
+public:
+    explicit RequestQueue(const SearchServer& search_server);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate);
+
+    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
+
+    std::vector<Document> AddFindRequest(const std::string& raw_query);
+
+    int GetNoResultRequests() const;
+
+private:
+    struct QueryResult {
+        std::vector<Document> documents;
+    };
+    std::deque<QueryResult> requests_;
+    const static int min_in_day_ = 1440;
+    const SearchServer& search_server_;
+    int current_requests_count = 0;
+};
+
+template <typename DocumentPredicate>
+std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
+    current_requests_count++;
+    if (current_requests_count > min_in_day_) {
+        requests_.pop_front();
+        current_requests_count--;
+    }
+    requests_.push_back({ search_server_.FindTopDocuments(raw_query, document_predicate) });
+
+    return search_server_.FindTopDocuments(raw_query, document_predicate);
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Данные слова запроса, общие для всех его документов
+struct TermScoringContext {
+    size_t document_count = 0;
+    // Число документов со словом
+    size_t document_freq = 0;
+    // log(document_count / document_freq)
+    double inverse_document_freq = 0.0;
+    // Среднее число слов документа без стоп-слов
+    double average_document_length = 0.0;
+};
+
+// Политика ранжирования - параметр шаблона FindTopDocuments, поэтому на каждую запись индекса
+// нет виртуального вызова. Вклад слова в релевантность документа считается по числу вхождений
+// слова term_count и длине документа document_length (слова без стоп-слов); вклады слов складываются.
+// Политика - это либо класс с методом
+//     double Score(const Term& term, uint32_t term_count, uint32_t document_length) const,
+// где Term - результат необязательного метода Prepare(const TermScoringContext&) const, вызываемого
+// один раз на слово запроса (без Prepare Term - сам TermScoringContext), либо функция
+//     double(const TermScoringContext&, uint32_t term_count, uint32_t document_length).
+// Политика вызывается из нескольких потоков при параллельном поиске
+
+// TF-IDF: доля слова в документе, умноженная на IDF
+struct TfIdfScorer {
+    double Prepare(const TermScoringContext& context) const {
+        return context.inverse_document_freq;
+    }
+
+    double Score(double inverse_document_freq, uint32_t term_count, uint32_t document_length) const {
+        return static_cast<double>(term_count) / document_length * inverse_document_freq;
+    }
+};
+
+// Okapi BM25
+struct Bm25Scorer {
+    double k1 = 1.2;
+    double b = 0.75;
+
+    struct Term {
+        double inverse_document_freq;
+        double k1_plus_one;
+        // Знаменатель насыщения: term_count + length_base + length_factor * document_length
+        double length_base;
+        double length_factor;
+    };
+
+    Term Prepare(const TermScoringContext& context) const {
+        const double document_freq = static_cast<double>(context.document_freq);
+        const double average_length = context.average_document_length > 0 ? context.average_document_length : 1.0;
+        return { std::log(1.0 + (context.document_count - document_freq + 0.5) / (document_freq + 0.5)),
+            k1 + 1.0, k1 * (1.0 - b), k1 * b / average_length };
+    }
+
+    double Score(const Term& term, uint32_t term_count, uint32_t document_length) const {
+        return term.inverse_document_freq * term_count * term.k1_plus_one
+            / (term_count + term.length_base + term.length_factor * document_length);
+    }
+};
+
+namespace scoring_detail {
+
+template <typename Scorer, typename = void>
+struct HasPrepare : std::false_type {};
+
+template <typename Scorer>
+struct HasPrepare<Scorer, std::void_t<decltype(
+    std::declval<const Scorer&>().Prepare(std::declval<const TermScoringContext&>()))>> : std::true_type {};
+
+template <typename Scorer, typename Term, typename = void>
+struct HasScore : std::false_type {};
+
+template <typename Scorer, typename Term>
+struct HasScore<Scorer, Term, std::void_t<decltype(std::declval<const Scorer&>().Score(
+    std::declval<const Term&>(), uint32_t(), uint32_t()))>> : std::true_type {};
+
+template <typename Scorer, bool = HasPrepare<Scorer>::value>
+struct PreparedTerm {
+    using Type = TermScoringContext;
+};
+
+template <typename Scorer>
+struct PreparedTerm<Scorer, true> {
+    using Type = std::decay_t<decltype(std::declval<const Scorer&>().Prepare(std::declval<const TermScoringContext&>()))>;
+};
+
+}  // namespace scoring_detail
+
+template <typename Scorer>
+using PreparedTerm = typename scoring_detail::PreparedTerm<Scorer>::Type;
+
+template <typename Scorer>
+inline constexpr bool IS_SCORER = scoring_detail::HasScore<Scorer, PreparedTerm<Scorer>>::value
+    || std::is_invocable_r_v<double, const Scorer&, const TermScoringContext&, uint32_t, uint32_t>;
+
+template <typename Scorer>
+PreparedTerm<Scorer> PrepareTerm(const Scorer& scorer, const TermScoringContext& context) {
+    if constexpr (scoring_detail::HasPrepare<Scorer>::value) {
+        return scorer.Prepare(context);
+    }
+    else {
+        return context;
+    }
+}
+
+template <typename Scorer>
+double ScoreTerm(const Scorer& scorer, const PreparedTerm<Scorer>& term, uint32_t term_count,
+    uint32_t document_length) {
+    if constexpr (scoring_detail::HasScore<Scorer, PreparedTerm<Scorer>>::value) {
+        return scorer.Score(term, term_count, document_length);
+    }
+    else {
+        return scorer(term, term_count, document_length);
+    }
+}
+
+// Встроенные политики дают нулевой вклад при term_count == 0, поэтому плотное окно документов
+// можно считать без ветвлений: такой цикл компилятор векторизует
+template <typename Scorer>
+inline constexpr bool IS_ZERO_FOR_ABSENT_TERM = std::is_same_v<Scorer, TfIdfScorer> || std::is_same_v<Scorer, Bm25Scorer>;
+
+// scores[i] += вклад слова в документ i длины document_lengths[i]; term_counts[i] == 0 - слова в документе нет
+template <typename Scorer>
+void AccumulateTermScores(const Scorer& scorer, const PreparedTerm<Scorer>& term, const uint32_t* term_counts,
+    const uint32_t* document_lengths, double* scores, size_t count) {
+    if constexpr (IS_ZERO_FOR_ABSENT_TERM<Scorer>) {
+        for (size_t i = 0; i < count; ++i) {
+            scores[i] += ScoreTerm(scorer, term, term_counts[i], document_lengths[i]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < count; ++i) {
+            if (term_counts[i] > 0) {
+                scores[i] += ScoreTerm(scorer, term, term_counts[i], document_lengths[i]);
+            }
+        }
+    }
+}
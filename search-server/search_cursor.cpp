@@ -0,0 +1,40 @@
+#include "search_cursor.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+SearchCursor::SearchCursor(std::vector<Document> documents, size_t page_size)
+    : documents_(std::move(documents))
+    , page_size_(page_size)
+{
+    if (page_size_ == 0) {
+        throw std::invalid_argument(std::string("Page size must be positive"));
+    }
+}
+
+SearchCursor::Page SearchCursor::GetPage(size_t page_index) {
+    const size_t page_begin = std::min(page_index * page_size_, documents_.size());
+    const size_t page_end = std::min(page_begin + page_size_, documents_.size());
+    if (page_end > sorted_count_) {
+        // Расширяем упорядоченный префикс хотя бы вдвое, чтобы листание вглубь
+        // стоило O(n log n) суммарно, а не O(n) на каждую страницу
+        const size_t target = std::min(std::max(page_end, 2 * sorted_count_), documents_.size());
+        std::partial_sort(documents_.begin() + sorted_count_, documents_.begin() + target, documents_.end(),
+            IsMoreRelevant);
+        sorted_count_ = target;
+    }
+    return Page(documents_.cbegin() + page_begin, documents_.cbegin() + page_end, page_end - page_begin);
+}
+
+size_t SearchCursor::GetPageSize() const {
+    return page_size_;
+}
+
+size_t SearchCursor::GetPageCount() const {
+    return (documents_.size() + page_size_ - 1) / page_size_;
+}
+
+size_t SearchCursor::GetResultCount() const {
+    return documents_.size();
+}
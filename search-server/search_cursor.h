@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+
+#include "document.h"
+#include "paginator.h"
+
+// Курсор постраничной выдачи. Релевантность всех подходящих документов считается один раз
+// при открытии курсора, а страницы упорядочиваются лениво: для страницы N сортируется
+// только недостающая часть первых (N + 1) * page_size документов.
+// Курсор не зависит от сервера и не видит документов, добавленных после его открытия
+class SearchCursor {
+public:
+    using Page = IteratorRange<std::vector<Document>::const_iterator>;
+
+    SearchCursor(std::vector<Document> documents, size_t page_size);
+
+    // Страница ссылается на буфер курсора и остаётся действительной, пока жив курсор.
+    // Номер за пределами выдачи даёт пустую страницу
+    Page GetPage(size_t page_index);
+
+    size_t GetPageSize() const;
+    size_t GetPageCount() const;
+    size_t GetResultCount() const;
+
+private:
+    std::vector<Document> documents_;
+    // Префикс documents_ такой длины уже окончательно упорядочен
+    size_t sorted_count_ = 0;
+    size_t page_size_;
+};
@@ -0,0 +1,98 @@
+#include "search_executor.h"
+
+#include <algorithm>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+void PinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+    (void)cpu;
+#endif
+}
+
+}  // namespace
+
+SearchExecutor::SearchExecutor(const SearchExecutorConfig& config)
+    : max_queue_depth_(config.max_queue_depth)
+    , cpu_affinity_(config.cpu_affinity)
+{
+    size_t thread_count = config.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+SearchExecutor::~SearchExecutor() {
+    {
+        std::lock_guard guard(mutex_);
+        stopping_ = true;
+    }
+    has_tasks_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t SearchExecutor::GetThreadCount() const {
+    return workers_.size();
+}
+
+size_t SearchExecutor::GetQueueDepth() const {
+    std::lock_guard guard(mutex_);
+    return tasks_.size();
+}
+
+size_t SearchExecutor::GetRejectedCount() const {
+    std::lock_guard guard(mutex_);
+    return rejected_count_;
+}
+
+void SearchExecutor::Enqueue(std::function<void()> task) {
+    {
+        std::lock_guard guard(mutex_);
+        if (stopping_) {
+            throw std::logic_error(std::string("Search executor is stopping"));
+        }
+        if (max_queue_depth_ != 0 && tasks_.size() >= max_queue_depth_) {
+            ++rejected_count_;
+            throw std::overflow_error(std::string("Search executor queue is full"));
+        }
+        tasks_.push_back(std::move(task));
+    }
+    has_tasks_.notify_one();
+}
+
+void SearchExecutor::WorkerLoop(size_t worker_index) {
+    if (!cpu_affinity_.empty()) {
+        PinCurrentThread(cpu_affinity_[worker_index % cpu_affinity_.size()]);
+    }
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            has_tasks_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            // Перед остановкой дорабатываем уже принятые задачи, чтобы не оставлять future без результата
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
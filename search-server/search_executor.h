@@ -0,0 +1,60 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct SearchExecutorConfig {
+    // 0 - по числу аппаратных потоков
+    size_t thread_count = 0;
+    // 0 - очередь не ограничена
+    size_t max_queue_depth = 1024;
+    // Поток i закрепляется за ядром cpu_affinity[i % cpu_affinity.size()]; пустой вектор - без закрепления
+    std::vector<int> cpu_affinity;
+};
+
+class SearchExecutor {
+public:
+    explicit SearchExecutor(const SearchExecutorConfig& config = {});
+    ~SearchExecutor();
+
+    SearchExecutor(const SearchExecutor&) = delete;
+    SearchExecutor& operator=(const SearchExecutor&) = delete;
+
+    // Бросает std::overflow_error, если очередь заполнена
+    template <typename Function>
+    std::future<std::invoke_result_t<Function>> Submit(Function&& function);
+
+    size_t GetThreadCount() const;
+    size_t GetQueueDepth() const;
+    size_t GetRejectedCount() const;
+
+private:
+    void Enqueue(std::function<void()> task);
+    void WorkerLoop(size_t worker_index);
+
+    const size_t max_queue_depth_;
+    const std::vector<int> cpu_affinity_;
+    mutable std::mutex mutex_;
+    std::condition_variable has_tasks_;
+    std::deque<std::function<void()>> tasks_;
+    size_t rejected_count_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+template <typename Function>
+std::future<std::invoke_result_t<Function>> SearchExecutor::Submit(Function&& function) {
+    using Result = std::invoke_result_t<Function>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+    std::future<Result> result = task->get_future();
+    Enqueue([task]() { (*task)(); });
+    return result;
+}
@@ -1,198 +1,856 @@
-#include <cmath>
-#include <execution>
-
-#include "search_server.h"
-#include "log_duration.h"
-
-SearchServer::SearchServer(const std::string& stop_words_text)
-    : SearchServer(
-        SplitIntoWords(stop_words_text)) 
-{
-}
-
-SearchServer::SearchServer(std::string_view stop_words_text) : 
-    SearchServer(
-    SplitIntoWords(stop_words_text)) 
-{
- }
-SearchServer::SearchServer() = default;
-
-void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
-    const std::vector<int>& ratings) {
-    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
-        throw std::invalid_argument(std::string("Invalid document_id"));
-    }
-    const auto words = SplitIntoWordsNoStop(document);
-
-    const double inv_word_count = 1.0 / words.size();
-    for (std::string_view word : words) {
-        std::string strword(word);
-        word_to_document_freqs_[strword][document_id] += inv_word_count;
-        document_to_word_freqs_[document_id][strword] += inv_word_count;
-    }
-    documents_.emplace(document_id, DocumentData{ ComputeAverageRating(ratings), status });
-    document_ids_.insert(document_id);
-}
-
-std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status)const {
-    return FindTopDocuments(
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
-}
-
-std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query)const {
-    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
-}
-
-int SearchServer::GetDocumentCount()const {
-    return documents_.size();
-}
-
-std::set<int>::iterator SearchServer::begin() {
-    return document_ids_.begin();
-}
-std::set<int>::iterator SearchServer::end() {
-    return document_ids_.end();
-}
-
-std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query,
-    int document_id) const {
-    const auto query = ParseQuery(raw_query);
-
-    std::vector<std::string_view> matched_words;
-    std::vector<std::string_view> plus_words = query.plus_words;
-    std::sort(plus_words.begin(), plus_words.end());
-    auto words_end = std::unique(plus_words.begin(), plus_words.end());
-    plus_words.erase(words_end, plus_words.end());
-    
-    
-    for (std::string_view word : query.minus_words) {
-        if (word_to_document_freqs_.count(std::string(word)) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(std::string(word)).count(document_id)) {
-            return { matched_words, documents_.at(document_id).status };
-        }
-    }
-    
-    for (std::string_view word : plus_words) {
-        if (word_to_document_freqs_.count(std::string(word)) == 0) {
-            continue;
-        }
-        if (word_to_document_freqs_.at(std::string(word)).count(document_id)) {
-            matched_words.push_back(word);
-        }
-    }
-    return { matched_words, documents_.at(document_id).status };
-}
-
-bool SearchServer::IsStopWord(std::string_view word)const {
-    return stop_words_.count(word) > 0;
-}
-
-bool SearchServer::IsValidWord(std::string_view word) {
-    return std::none_of(word.begin(), word.end(), [](char c) {
-        return c >= '\0' && c < ' ';
-        });
-}
-
-std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text)const {
-    std::vector<std::string_view> words;
-    for (std::string_view word : SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
-            throw std::invalid_argument(std::string("Word ") + std::string(word) + std::string(" is invalid"));
-        }
-        if (!IsStopWord(word)) {
-            words.push_back(word);
-        }
-    }
-    return words;
-}
-
-int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
-    if (ratings.empty()) {
-        return 0;
-    }
-    int rating_sum = 0;
-    for (const int rating : ratings) {
-        rating_sum += rating;
-    }
-    return rating_sum / static_cast<int> (ratings.size());
-}
-
-SearchServer::QueryWord SearchServer::ParseQueryWord(std::string_view& text) const {
-    if (text.empty()) {
-        throw std::invalid_argument(std::string("Query word is empty"));
-    }
-    std::string word = std::string(text);
-    bool is_minus = false;
-    if (word[0] == '-') {
-        is_minus = true;
-        word = word.substr(1);
-        text.remove_prefix(1);
-    }
-    if (word.empty() || word[0] == '-' || !IsValidWord(word)) {
-        throw std::invalid_argument(std::string("Query word ") + word + std::string(" is invalid"));
-    }
-
-    return { text, is_minus, IsStopWord(word) };
-}
-
-SearchServer::Query SearchServer::ParseQuery(const std::string_view& text)const {
-    Query result;
-    for (std::string_view& word : SplitIntoWords(text)) {
-        const auto query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                result.minus_words.push_back(query_word.data);
-            }
-            else {
-                result.plus_words.push_back(query_word.data);
-            }
-        }
-    }
-    
-    return result;
-}
-
-const std::map<std::string, double>& SearchServer::GetWordFrequencies(int document_id) const {
-    static std::map<std::string, double> empty_map;
-    if (document_ids_.find(document_id) == document_ids_.end()) {
-        return empty_map;
-    } else {
-        return document_to_word_freqs_.at(document_id);
-    }
-   
-}
-
-
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string& word)const {
-    return std::log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
-}
-
-void SearchServer::RemoveDocument(int document_id) {
-    if (document_ids_.find(document_id) != document_ids_.end()) {
-        documents_.erase(document_id);
-        document_ids_.erase(document_id);
-        for (const auto& [word, _] : document_to_word_freqs_.at(document_id)) {
-            word_to_document_freqs_.at(word).erase(document_id);
-        }
-        document_to_word_freqs_.erase(document_id);
-    }
-
-}
-
-std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocuments(const SearchServer& search_server, std::string_view raw_query,int document_id) {
-    LOG_DURATION_STREAM("Operation time", std::cout);
-    return search_server.MatchDocument(raw_query, document_id);
-}
-
-std::vector<Document> FindTopDocuments(const SearchServer& search_server, std::string_view raw_query) {
-
-    LOG_DURATION_STREAM("Operation time", std::cout);
-    return search_server.FindTopDocuments(raw_query);
-}
-void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
-    search_server.AddDocument(document_id, document, status, ratings);
+#include <charconv>
+#include <cmath>
+#include <execution>
+#include <numeric>
+
+#include "search_server.h"
+
+namespace {
+
+// Цвет и три указателя узла красно-чёрного дерева (std::map, std::set) сверх хранимого значения
+constexpr size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+
+// '*' - любая, в том числе пустая, последовательность символов
+bool MatchesPattern(std::string_view word, std::string_view pattern) {
+    size_t word_pos = 0;
+    size_t pattern_pos = 0;
+    size_t star_pos = std::string_view::npos;
+    size_t star_word_pos = 0;
+    while (word_pos < word.size()) {
+        if (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+            star_pos = pattern_pos++;
+            star_word_pos = word_pos;
+        }
+        else if (pattern_pos < pattern.size() && pattern[pattern_pos] == word[word_pos]) {
+            ++pattern_pos;
+            ++word_pos;
+        }
+        else if (star_pos != std::string_view::npos) {
+            // '*' поглощает ещё один символ
+            pattern_pos = star_pos + 1;
+            word_pos = ++star_word_pos;
+        }
+        else {
+            return false;
+        }
+    }
+    while (pattern_pos < pattern.size() && pattern[pattern_pos] == '*') {
+        ++pattern_pos;
+    }
+    return pattern_pos == pattern.size();
+}
+
+}  // namespace
+
+SearchServer::IndexMemory::IndexMemory(std::pmr::memory_resource* upstream)
+    : dictionary(upstream)
+    , forward_index(upstream)
+    , metadata(upstream)
+    , positions(upstream)
+    , impacts(upstream)
+    , caches(upstream)
+{
+}
+
+SearchServer::SearchServer(const std::string& stop_words_text)
+    : SearchServer(
+        SplitIntoWords(stop_words_text)) 
+{
+}
+
+SearchServer::SearchServer(const std::string& stop_words_text, const SearchServerOptions& options)
+    : SearchServer(SplitIntoWords(stop_words_text), options)
+{
+}
+
+SearchServer::SearchServer(std::string_view stop_words_text) : 
+    SearchServer(
+    SplitIntoWords(stop_words_text)) 
+{
+ }
+
+SearchServer::SearchServer(std::string_view stop_words_text, const SearchServerOptions& options)
+    : SearchServer(SplitIntoWords(stop_words_text), options)
+{
+}
+
+SearchServer::SearchServer(const SearchServerOptions& options)
+    : SearchServer(std::vector<std::string_view>(), options)
+{
+}
+
+SearchServer::SearchServer() = default;
+
+int SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
+    const std::vector<int>& ratings) {
+    SEARCH_METRICS_SCOPE(MetricPhase::ADD_DOCUMENT);
+    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+        throw std::invalid_argument(std::string("Invalid document_id"));
+    }
+    if (!tokenizer_.IsIdentity() && document_buffer_.size() < document.size()) {
+        document_buffer_.resize(document.size());
+    }
+    const auto words = SplitIntoWordsNoStop(document, document_buffer_.data());
+    if (memory_limit_ > 0) {
+        CheckMemoryLimit(words);
+    }
+
+    uint64_t fingerprint = 0;
+    if (duplicate_policy_ != DuplicatePolicy::KEEP) {
+        std::vector<std::string_view> term_set = words;
+        std::sort(term_set.begin(), term_set.end());
+        term_set.erase(std::unique(term_set.begin(), term_set.end()), term_set.end());
+        for (const std::string_view word : term_set) {
+            fingerprint += HashTerm(word);
+        }
+        if (const auto original = FindDuplicate(fingerprint, term_set)) {
+            SEARCH_METRICS_ADD(MetricCounter::DUPLICATES_DETECTED, 1);
+            if (duplicate_policy_ == DuplicatePolicy::REJECT && *original < document_id) {
+                throw std::invalid_argument(std::string("Document ") + std::to_string(document_id)
+                    + std::string(" duplicates document ") + std::to_string(*original));
+            }
+            if (duplicate_policy_ != DuplicatePolicy::FLAG) {
+                RemoveDocument(*original);
+                document_id = std::min(document_id, *original);
+            }
+        }
+    }
+
+    const auto word_count = static_cast<uint32_t>(words.size());
+    auto& word_freqs = document_to_word_freqs_[document_id];
+    std::vector<std::string_view> dictionary_words;
+    if (store_positions_) {
+        dictionary_words.reserve(words.size());
+    }
+    for (std::string_view word : words) {
+        const auto it = FindOrAddWord(word);
+        ++it->second[document_id];
+        word_freqs[it->first] += 1.0;
+        if (store_positions_) {
+            dictionary_words.push_back(it->first);
+        }
+    }
+    // Доля слова считается так же, как при загрузке снимка
+    for (auto& [word, term_freq] : word_freqs) {
+        term_freq /= word_count;
+    }
+    if (store_positions_) {
+        document_positions_.emplace(document_id, DocumentPositions(&memory_->positions))
+            .first->second.Build(dictionary_words);
+    }
+    documents_.emplace(document_id, DocumentData{ ComputeAverageRating(ratings), status, word_count });
+    if (duplicate_policy_ != DuplicatePolicy::KEEP) {
+        fingerprints_.emplace(fingerprint, document_id);
+    }
+    document_ids_.insert(document_id);
+    total_word_count_ += word_count;
+    DropImpactIndex();
+    UpdateHotTerms(document_id, true);
+    SEARCH_METRICS_ADD(MetricCounter::DOCUMENTS_ADDED, 1);
+    return document_id;
+}
+
+SearchServer::Dictionary::iterator SearchServer::FindOrAddWord(std::string_view word) {
+    auto it = word_to_document_freqs_.find(word);
+    if (it == word_to_document_freqs_.end()) {
+        const size_t bytes_before = memory_->dictionary.GetCounters().bytes_in_use;
+        it = word_to_document_freqs_.emplace(std::piecewise_construct, std::forward_as_tuple(word),
+            std::forward_as_tuple()).first;
+        memory_->word_bytes += memory_->dictionary.GetCounters().bytes_in_use - bytes_before;
+    }
+    return it;
+}
+
+void SearchServer::RestoreDocument(int document_id, DocumentStatus status, int rating, uint32_t word_count,
+    const std::vector<std::pair<Dictionary::iterator, uint32_t>>& word_counts) {
+    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+        throw std::invalid_argument(std::string("Invalid document_id"));
+    }
+    auto& document_words = document_to_word_freqs_.emplace_hint(document_to_word_freqs_.end(),
+        document_id, WordFrequencies())->second;
+    for (const auto& [it, term_count] : word_counts) {
+        it->second.emplace_hint(it->second.end(), document_id, term_count);
+        document_words.emplace_hint(document_words.end(), it->first, static_cast<double>(term_count) / word_count);
+    }
+    if (duplicate_policy_ != DuplicatePolicy::KEEP) {
+        fingerprints_.emplace(ComputeFingerprint(document_id), document_id);
+    }
+    documents_.emplace_hint(documents_.end(), document_id, DocumentData{ rating, status, word_count });
+    document_ids_.emplace_hint(document_ids_.end(), document_id);
+    total_word_count_ += word_count;
+    DropImpactIndex();
+    UpdateHotTerms(document_id, true);
+}
+
+void SearchServer::BuildImpactIndex(int bits) {
+    DropImpactIndex();
+    const TfIdfScorer scorer;
+    std::vector<std::pair<int, double>> impacts;
+    for (const auto& [word, postings] : word_to_document_freqs_) {
+        if (postings.empty()) {
+            continue;
+        }
+        const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+        impacts.clear();
+        for (const auto [document_id, term_count] : postings) {
+            impacts.emplace_back(document_id,
+                scorer.Score(inverse_document_freq, term_count, documents_.at(document_id).word_count));
+        }
+        impact_lists_.emplace_hint(impact_lists_.end(), word, ImpactList(&memory_->impacts))
+            ->second.Build(impacts, bits);
+    }
+    has_impact_index_ = true;
+    impact_bits_ = bits;
+}
+
+uint64_t SearchServer::HashTerm(std::string_view word) {
+    return perfect_hash::Mix(perfect_hash::HashWord(word));
+}
+
+std::optional<int> SearchServer::FindDuplicate(uint64_t fingerprint, const std::vector<std::string_view>& words,
+    int excluded_id)const {
+    std::optional<int> original;
+    const auto [begin, end] = fingerprints_.equal_range(fingerprint);
+    for (auto it = begin; it != end; ++it) {
+        const int document_id = it->second;
+        if (document_id == excluded_id || (original && *original < document_id)) {
+            continue;
+        }
+        // Отпечатки могут совпасть случайно, поэтому наборы слов сравниваются
+        const auto& document_words = document_to_word_freqs_.at(document_id);
+        if (std::equal(words.begin(), words.end(), document_words.begin(), document_words.end(),
+            [](std::string_view word, const auto& item) { return word == item.first; })) {
+            original = document_id;
+        }
+    }
+    return original;
+}
+
+uint64_t SearchServer::ComputeFingerprint(int document_id)const {
+    uint64_t fingerprint = 0;
+    for (const auto& [word, _] : document_to_word_freqs_.at(document_id)) {
+        fingerprint += HashTerm(word);
+    }
+    return fingerprint;
+}
+
+void SearchServer::EraseFingerprint(int document_id) {
+    if (duplicate_policy_ == DuplicatePolicy::KEEP) {
+        return;
+    }
+    auto [begin, end] = fingerprints_.equal_range(ComputeFingerprint(document_id));
+    for (auto it = begin; it != end; ++it) {
+        if (it->second == document_id) {
+            fingerprints_.erase(it);
+            return;
+        }
+    }
+}
+
+std::optional<int> SearchServer::GetDuplicateOf(int document_id)const {
+    const auto document = documents_.find(document_id);
+    if (duplicate_policy_ == DuplicatePolicy::KEEP || document == documents_.end()) {
+        return std::nullopt;
+    }
+    std::vector<std::string_view> words;
+    for (const auto& [word, _] : document_to_word_freqs_.at(document_id)) {
+        words.push_back(word);
+    }
+    const auto original = FindDuplicate(ComputeFingerprint(document_id), words, document_id);
+    return original && *original < document_id ? original : std::nullopt;
+}
+
+bool SearchServer::HasImpactIndex()const {
+    return has_impact_index_;
+}
+
+int SearchServer::GetImpactIndexBits()const {
+    return impact_bits_;
+}
+
+const SearchServerOptions& SearchServer::GetOptions()const {
+    return options_;
+}
+
+void SearchServer::DropImpactIndex() {
+    if (has_impact_index_) {
+        impact_lists_.clear();
+        has_impact_index_ = false;
+        impact_bits_ = 0;
+    }
+}
+
+std::shared_ptr<const HotTermSlice> SearchServer::FindHotTermSlice(const Dictionary::value_type& entry,
+    DocumentStatus status)const {
+    if (!hot_terms_ || entry.second.size() < hot_terms_->GetMinPostings()) {
+        return nullptr;
+    }
+    bool admit = false;
+    auto slice = hot_terms_->Find(entry.first, status, admit);
+    if (!admit) {
+        return slice;
+    }
+    HotTermSlice built = hot_terms_->CreateSlice();
+    for (const auto [document_id, term_count] : entry.second) {
+        const DocumentData& document_data = documents_.at(document_id);
+        if (document_data.status == status) {
+            built.Add(document_id, term_count, document_data.word_count, document_data.rating);
+        }
+    }
+    return hot_terms_->Insert(entry.first, status, std::move(built));
+}
+
+void SearchServer::UpdateHotTerms(int document_id, bool is_added) {
+    if (!hot_terms_ || !hot_terms_->HasSlices()) {
+        return;
+    }
+    const DocumentData& document_data = documents_.at(document_id);
+    for (const auto& [word, _] : document_to_word_freqs_.at(document_id)) {
+        if (is_added) {
+            hot_terms_->AddPosting(word, document_data.status, document_id,
+                word_to_document_freqs_.find(word)->second.at(document_id), document_data.word_count,
+                document_data.rating);
+        }
+        else {
+            hot_terms_->ErasePosting(word, document_data.status, document_id);
+        }
+    }
+}
+
+bool SearchServer::CanUseImpactIndex(const Query& query)const {
+    // Фразы отсеивают документы уже после выбора лучших, поэтому останавливаться раньше нельзя
+    return has_impact_index_ && query.phrases.empty();
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status)const {
+    return FindTopDocuments(raw_query, StatusPredicate{ status });
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query)const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+void SearchServer::ConfigureExecutor(const SearchExecutorConfig& config) {
+    auto previous = std::atomic_exchange(&executor_, std::make_shared<SearchExecutor>(config));
+    // Если пул не используется в Submit другого потока, он дорабатывает принятые задачи здесь
+    previous.reset();
+}
+
+std::future<std::vector<Document>> SearchServer::FindTopDocumentsAsync(std::string raw_query, DocumentStatus status)const {
+    return FindTopDocumentsAsync(std::move(raw_query), StatusPredicate{ status });
+}
+
+std::future<std::vector<Document>> SearchServer::FindTopDocumentsAsync(std::string raw_query)const {
+    return FindTopDocumentsAsync(std::move(raw_query), DocumentStatus::ACTUAL);
+}
+
+SearchCursor SearchServer::OpenCursor(std::string_view raw_query, DocumentStatus status, size_t page_size)const {
+    return OpenCursor(raw_query, StatusPredicate{ status }, page_size);
+}
+
+SearchCursor SearchServer::OpenCursor(std::string_view raw_query, size_t page_size)const {
+    return OpenCursor(raw_query, DocumentStatus::ACTUAL, page_size);
+}
+
+void SearchServer::SetConcurrencyLimit(const ConcurrencyLimit& limit) {
+    std::atomic_store(&limiter_, std::make_shared<ConcurrencyLimiter>(limit));
+}
+
+int SearchServer::GetDocumentCount()const {
+    return documents_.size();
+}
+
+std::pmr::set<int>::iterator SearchServer::begin() {
+    return document_ids_.begin();
+}
+std::pmr::set<int>::iterator SearchServer::end() {
+    return document_ids_.end();
+}
+std::pmr::set<int>::const_iterator SearchServer::begin()const {
+    return document_ids_.begin();
+}
+std::pmr::set<int>::const_iterator SearchServer::end()const {
+    return document_ids_.end();
+}
+
+std::pmr::memory_resource* SearchServer::GetMemoryResource()const {
+    return resource_;
+}
+
+MemoryUsage SearchServer::GetMemoryUsage()const {
+    MemoryUsage usage;
+    usage.stop_words = stop_words_.GetMemoryUsage();
+    usage.dictionary = memory_->word_bytes;
+    usage.inverted_index = memory_->dictionary.GetCounters().bytes_in_use - memory_->word_bytes;
+    usage.forward_index = memory_->forward_index.GetCounters().bytes_in_use;
+    usage.document_metadata = memory_->metadata.GetCounters().bytes_in_use;
+    usage.positions = memory_->positions.GetCounters().bytes_in_use;
+    usage.impacts = memory_->impacts.GetCounters().bytes_in_use;
+    usage.caches = memory_->caches.GetCounters().bytes_in_use;
+    return usage;
+}
+
+HotTermCacheStats SearchServer::GetHotTermCacheStats()const {
+    return hot_terms_ ? hot_terms_->GetStats() : HotTermCacheStats{};
+}
+
+void SearchServer::CheckMemoryLimit(const std::vector<std::string_view>& words)const {
+    // Оценка сверху: каждое вхождение слова считается новым для документа,
+    // а отсутствующее в словаре - ещё и новым словом
+    constexpr size_t posting_bytes = TREE_NODE_OVERHEAD + sizeof(Postings::value_type);
+    constexpr size_t forward_bytes = TREE_NODE_OVERHEAD + sizeof(WordFrequencies::value_type);
+    constexpr size_t word_node_bytes = TREE_NODE_OVERHEAD + sizeof(Dictionary::value_type);
+    size_t required = TREE_NODE_OVERHEAD + sizeof(decltype(documents_)::value_type)
+        + TREE_NODE_OVERHEAD + sizeof(int)
+        + TREE_NODE_OVERHEAD + sizeof(decltype(document_to_word_freqs_)::value_type);
+    if (store_positions_) {
+        // Слово и смещение списка плюс до пяти байт varint на позицию
+        required += TREE_NODE_OVERHEAD + sizeof(decltype(document_positions_)::value_type)
+            + words.size() * (sizeof(DocumentPositions::Offsets::value_type) + 5);
+    }
+    for (std::string_view word : words) {
+        required += posting_bytes + forward_bytes;
+        if (word_to_document_freqs_.count(word) == 0) {
+            required += word_node_bytes + word.size() + 1;
+        }
+    }
+    const size_t total = GetMemoryUsage().GetTotal();
+    if (total + required > memory_limit_) {
+        throw std::length_error(std::string("Search server memory limit exceeded: ") + std::to_string(total)
+            + std::string(" bytes used, ") + std::to_string(required) + std::string(" more may be required, limit is ")
+            + std::to_string(memory_limit_));
+    }
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query,
+    int document_id) const {
+    SEARCH_METRICS_SCOPE(MetricPhase::MATCH_DOCUMENT);
+    return MatchParsedQuery(ParseQuery(raw_query), document_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchParsedQuery(const Query& query,
+    int document_id, size_t* postings_scanned) const {
+    std::vector<std::string_view> matched_words;
+    std::vector<std::string_view> plus_words = query.plus_words;
+    std::sort(plus_words.begin(), plus_words.end());
+    auto words_end = std::unique(plus_words.begin(), plus_words.end());
+    plus_words.erase(words_end, plus_words.end());
+    
+    
+    for (std::string_view word : query.minus_words) {
+        const auto* postings = FindWordPostings(word);
+        if (!postings) {
+            continue;
+        }
+        if (postings_scanned) {
+            ++*postings_scanned;
+        }
+        if (postings->count(document_id)) {
+            return { matched_words, documents_.at(document_id).status };
+        }
+    }
+    
+    if (!query.phrases.empty() && !MatchesPhrases(query, document_id)) {
+        return { matched_words, documents_.at(document_id).status };
+    }
+
+    for (std::string_view word : plus_words) {
+        const auto* entry = FindWord(word);
+        if (!entry) {
+            continue;
+        }
+        if (postings_scanned) {
+            ++*postings_scanned;
+        }
+        if (entry->second.count(document_id)) {
+            matched_words.push_back(entry->first);
+        }
+    }
+    return { matched_words, documents_.at(document_id).status };
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query,
+    int document_id, QueryStats& stats) const {
+    using Clock = std::chrono::steady_clock;
+    SEARCH_METRICS_SCOPE(MetricPhase::MATCH_DOCUMENT);
+    stats = QueryStats{};
+    stats.execution_policy = GetExecutionPolicyName<std::execution::sequenced_policy>();
+    auto start = Clock::now();
+    const auto query = ParseQuery(raw_query);
+    stats.parse_time = Clock::now() - start;
+    FillTermStats(query, stats);
+
+    start = Clock::now();
+    auto result = MatchParsedQuery(query, document_id, &stats.postings_scanned);
+    stats.traversal_time = Clock::now() - start;
+    const auto& matched_words = std::get<0>(result);
+    const bool has_minus_word = std::any_of(stats.terms.begin(), stats.terms.end(),
+        [this, document_id](const QueryTermStats& term) {
+            return term.is_minus && term.document_freq > 0 && FindWordPostings(term.word)->count(document_id) > 0;
+        });
+    stats.candidates_created = (!matched_words.empty() || has_minus_word) ? 1 : 0;
+    stats.rejected_by_minus_words = has_minus_word ? 1 : 0;
+    stats.documents_returned = matched_words.empty() ? 0 : 1;
+    return result;
+}
+
+BatchMatchResult SearchServer::MatchDocuments(std::string_view raw_query,
+    const std::vector<int>& document_ids) const {
+    SEARCH_METRICS_SCOPE(MetricPhase::MATCH_DOCUMENT);
+    const auto query = ParseQuery(raw_query);
+
+    BatchMatchResult result;
+    result.document_ids = document_ids;
+    result.statuses.reserve(document_ids.size());
+    for (const int document_id : document_ids) {
+        result.statuses.push_back(documents_.at(document_id).status);
+    }
+
+    // Документы обходятся по возрастанию id, чтобы идти по списку документов слова только вперёд
+    std::vector<size_t> order(document_ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+        [&document_ids](size_t lhs, size_t rhs) { return document_ids[lhs] < document_ids[rhs]; });
+
+    const auto for_each_match = [&document_ids, &order](const Postings& postings, auto&& on_match) {
+        // Короткий список выгоднее пройти целиком, длинный - искать в нём каждый документ
+        const bool merge = postings.size() <= order.size() * 8;
+        auto it = postings.begin();
+        for (const size_t index : order) {
+            const int document_id = document_ids[index];
+            if (merge) {
+                while (it != postings.end() && it->first < document_id) {
+                    ++it;
+                }
+            }
+            else {
+                it = postings.lower_bound(document_id);
+            }
+            if (it == postings.end()) {
+                if (merge) {
+                    return;
+                }
+                continue;
+            }
+            if (it->first == document_id) {
+                on_match(index);
+            }
+        }
+    };
+
+    std::vector<bool> excluded(document_ids.size(), false);
+    for (std::string_view word : query.minus_words) {
+        if (const auto* postings = FindWordPostings(word)) {
+            for_each_match(*postings, [&excluded](size_t index) { excluded[index] = true; });
+        }
+    }
+    if (!query.phrases.empty()) {
+        for (size_t index = 0; index < document_ids.size(); ++index) {
+            excluded[index] = excluded[index] || !MatchesPhrases(query, document_ids[index]);
+        }
+    }
+
+    std::vector<std::string_view> plus_words = query.plus_words;
+    std::sort(plus_words.begin(), plus_words.end());
+    plus_words.erase(std::unique(plus_words.begin(), plus_words.end()), plus_words.end());
+
+    std::vector<std::pair<size_t, std::string_view>> matches;
+    for (std::string_view word : plus_words) {
+        const auto it = word_to_document_freqs_.find(word);
+        if (it == word_to_document_freqs_.end()) {
+            continue;
+        }
+        const std::string_view dictionary_word = it->first;
+        for_each_match(it->second, [&](size_t index) {
+            if (!excluded[index]) {
+                matches.emplace_back(index, dictionary_word);
+            }
+        });
+    }
+
+    result.offsets.assign(document_ids.size() + 1, 0);
+    for (const auto& [index, _] : matches) {
+        ++result.offsets[index + 1];
+    }
+    std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+    result.words.resize(matches.size());
+    std::vector<size_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+    // matches идут в порядке слов, поэтому слова каждого документа остаются отсортированными
+    for (const auto& [index, word] : matches) {
+        result.words[positions[index]++] = word;
+    }
+    return result;
+}
+
+void SearchServer::FillTermStats(const Query& query, QueryStats& stats) const {
+    stats.truncated_expansions = query.truncated_patterns;
+    const auto add_terms = [this, &stats](std::vector<std::string_view> words, bool is_minus) {
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        for (std::string_view word : words) {
+            QueryTermStats term;
+            term.word = std::string(word);
+            term.is_minus = is_minus;
+            const auto* postings = FindWordPostings(word);
+            if (postings && !postings->empty()) {
+                term.document_freq = postings->size();
+                term.inverse_document_freq = ComputeWordInverseDocumentFreq(term.word);
+            }
+            stats.terms.push_back(std::move(term));
+        }
+    };
+    add_terms(query.plus_words, false);
+    add_terms(query.minus_words, true);
+}
+
+bool SearchServer::IsStopWord(std::string_view word)const {
+    return stop_words_.Contains(word);
+}
+
+bool SearchServer::IsValidWord(std::string_view word) {
+    return std::none_of(word.begin(), word.end(), [](char c) {
+        return c >= '\0' && c < ' ';
+        });
+}
+
+std::vector<std::string_view> SearchServer::SplitIntoWordsNoStop(std::string_view text, char* buffer)const {
+    std::vector<std::string_view> words;
+    tokenizer_.ForEachToken(text, buffer, [this, &words](const Token& token) {
+        if (!token.is_valid) {
+            throw std::invalid_argument(std::string("Word ") + std::string(token.raw) + std::string(" is invalid"));
+        }
+        if (!IsStopWord(token.normalized)) {
+            words.push_back(token.normalized);
+        }
+        });
+    return words;
+}
+
+int SearchServer::ComputeAverageRating(const std::vector<int>& ratings) {
+    if (ratings.empty()) {
+        return 0;
+    }
+    int rating_sum = 0;
+    for (const int rating : ratings) {
+        rating_sum += rating;
+    }
+    return rating_sum / static_cast<int> (ratings.size());
+}
+
+SearchServer::QueryWord SearchServer::ParseQueryWord(const Token& token) const {
+    // Минус определяется по исходному слову: при удалении пунктуации его нет в нормализованном
+    std::string_view text = token.normalized;
+    bool is_minus = false;
+    if (token.raw[0] == '-') {
+        is_minus = true;
+        if (text[0] == '-') {
+            text.remove_prefix(1);
+        }
+    }
+    if (text.empty() || text[0] == '-' || !token.is_valid) {
+        throw std::invalid_argument(std::string("Query word ") + std::string(text) + std::string(" is invalid"));
+    }
+    if (max_term_expansion_ > 0 && text.find('*') != std::string_view::npos) {
+        if (text[0] == '*') {
+            throw std::invalid_argument(std::string("Query pattern ") + std::string(text)
+                + std::string(" must not start with *"));
+        }
+        return { text, is_minus, false, true };
+    }
+
+    return { text, is_minus, IsStopWord(text), false };
+}
+
+TokenizerOptions SearchServer::GetQueryTokenizerOptions(const SearchServerOptions& options) {
+    TokenizerOptions query_options = options.tokenizer;
+    if (options.max_term_expansion > 0) {
+        auto& punctuation = query_options.punctuation;
+        punctuation.erase(std::remove(punctuation.begin(), punctuation.end(), '*'), punctuation.end());
+    }
+    return query_options;
+}
+
+void SearchServer::ExpandPattern(std::string_view pattern, bool is_minus, Query& query) const {
+    auto& words = is_minus ? query.minus_words : query.plus_words;
+    const std::string_view prefix = pattern.substr(0, pattern.find('*'));
+    const bool is_prefix_pattern = prefix.size() + 1 == pattern.size();
+    size_t expanded_count = 0;
+    // Слова с префиксом шаблона идут в словаре подряд
+    for (auto it = word_to_document_freqs_.lower_bound(prefix);
+        it != word_to_document_freqs_.end() && std::string_view(it->first).substr(0, prefix.size()) == prefix; ++it) {
+        if (it->second.empty() || (!is_prefix_pattern && !MatchesPattern(it->first, pattern))) {
+            continue;
+        }
+        // Обрезанный минус-шаблон пропускал бы документы, которые запрос исключает
+        if (!is_minus && expanded_count == max_term_expansion_) {
+            ++query.truncated_patterns;
+            break;
+        }
+        words.push_back(it->first);
+        ++expanded_count;
+    }
+}
+
+SearchServer::Query SearchServer::ParseQuery(const std::string_view& text)const {
+    SEARCH_METRICS_SCOPE(MetricPhase::QUERY_PARSE);
+    Query result;
+    if (!query_tokenizer_.IsIdentity()) {
+        result.buffer = std::make_unique<char[]>(text.size());
+    }
+    char* buffer = result.buffer.get();
+    if (!store_positions_) {
+        ParseQueryWords(text, buffer, result);
+        return result;
+    }
+
+    // Фразы: "big eyes", "big eyes"~2, -"big eyes"
+    std::string_view rest = text;
+    while (!rest.empty()) {
+        const size_t open = rest.find('"');
+        if (open == std::string_view::npos) {
+            ParseQueryWords(rest, buffer, result);
+            break;
+        }
+        const bool is_minus = open > 0 && rest[open - 1] == '-'
+            && (open == 1 || query_tokenizer_.IsDelimiter(rest[open - 2]));
+        ParseQueryWords(rest.substr(0, is_minus ? open - 1 : open), buffer, result);
+        const size_t close = rest.find('"', open + 1);
+        if (close == std::string_view::npos) {
+            throw std::invalid_argument(std::string("Query phrase is not closed"));
+        }
+        const std::string_view phrase = rest.substr(open + 1, close - open - 1);
+        rest.remove_prefix(close + 1);
+        std::optional<size_t> slop;
+        if (!rest.empty() && rest[0] == '~') {
+            size_t value = 0;
+            const auto [end, error] = std::from_chars(rest.data() + 1, rest.data() + rest.size(), value);
+            if (error != std::errc()) {
+                throw std::invalid_argument(std::string("Proximity distance after ~ is invalid"));
+            }
+            slop = value;
+            rest.remove_prefix(end - rest.data());
+        }
+        ParsePhrase(phrase, buffer, is_minus, slop, result);
+    }
+    return result;
+}
+
+void SearchServer::ParseQueryWords(std::string_view text, char*& buffer, Query& query) const {
+    buffer = query_tokenizer_.ForEachToken(text, buffer, [this, &query](const Token& token) {
+        const auto query_word = ParseQueryWord(token);
+        if (query_word.is_pattern) {
+            ExpandPattern(query_word.data, query_word.is_minus, query);
+        }
+        else if (!query_word.is_stop) {
+            if (query_word.is_minus) {
+                query.minus_words.push_back(query_word.data);
+            }
+            else {
+                query.plus_words.push_back(query_word.data);
+            }
+        }
+        });
+}
+
+void SearchServer::ParsePhrase(std::string_view text, char*& buffer, bool is_minus, std::optional<size_t> slop,
+    Query& query) const {
+    Query::Phrase phrase;
+    phrase.is_minus = is_minus;
+    buffer = query_tokenizer_.ForEachToken(text, buffer, [this, &phrase](const Token& token) {
+        if (!token.is_valid) {
+            throw std::invalid_argument(std::string("Query word ") + std::string(token.raw) + std::string(" is invalid"));
+        }
+        if (!IsStopWord(token.normalized)) {
+            phrase.words.push_back(token.normalized);
+        }
+        });
+    if (slop) {
+        // Порядок слов близости не важен, повтор слова ничего не меняет
+        std::sort(phrase.words.begin(), phrase.words.end());
+        phrase.words.erase(std::unique(phrase.words.begin(), phrase.words.end()), phrase.words.end());
+    }
+    if (phrase.words.size() == 1) {
+        (is_minus ? query.minus_words : query.plus_words).push_back(phrase.words[0]);
+    }
+    if (phrase.words.size() > 1) {
+        if (!is_minus) {
+            query.plus_words.insert(query.plus_words.end(), phrase.words.begin(), phrase.words.end());
+        }
+        phrase.window = slop ? phrase.words.size() + *slop : 0;
+        query.phrases.push_back(std::move(phrase));
+    }
+}
+
+bool SearchServer::MatchesPhrases(const Query& query, int document_id) const {
+    const auto it = document_positions_.find(document_id);
+    for (const auto& phrase : query.phrases) {
+        const bool found = it != document_positions_.end() && ContainsPhrase(it->second, phrase.words, phrase.window);
+        if (found == phrase.is_minus) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const SearchServer::WordFrequencies& SearchServer::GetWordFrequencies(int document_id) const {
+    static const WordFrequencies empty_map;
+    if (document_ids_.find(document_id) == document_ids_.end()) {
+        return empty_map;
+    } else {
+        return document_to_word_freqs_.at(document_id);
+    }
+   
+}
+
+
+void SearchServer::SelectTopDocuments(std::vector<Document>& matched_documents) {
+    SEARCH_METRICS_SCOPE(MetricPhase::TOP_K_SELECTION);
+    sort(matched_documents.begin(), matched_documents.end(), IsMoreRelevant);
+    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
+        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+    }
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(std::string_view word)const {
+    return std::log(GetDocumentCount() * 1.0 / FindWordPostings(word)->size());
+}
+
+const SearchServer::Dictionary::value_type* SearchServer::FindWord(std::string_view word)const {
+    const auto it = word_to_document_freqs_.find(word);
+    return it == word_to_document_freqs_.end() ? nullptr : &*it;
+}
+
+const SearchServer::Postings* SearchServer::FindWordPostings(std::string_view word)const {
+    const auto* entry = FindWord(word);
+    return entry ? &entry->second : nullptr;
+}
+
+void SearchServer::RemoveDocument(int document_id) {
+    SEARCH_METRICS_SCOPE(MetricPhase::REMOVE_DOCUMENT);
+    if (document_ids_.find(document_id) != document_ids_.end()) {
+        SEARCH_METRICS_ADD(MetricCounter::DOCUMENTS_REMOVED, 1);
+        UpdateHotTerms(document_id, false);
+        total_word_count_ -= documents_.at(document_id).word_count;
+        EraseFingerprint(document_id);
+        documents_.erase(document_id);
+        document_ids_.erase(document_id);
+        for (const auto& [word, _] : document_to_word_freqs_.at(document_id)) {
+            word_to_document_freqs_.find(word)->second.erase(document_id);
+        }
+        document_to_word_freqs_.erase(document_id);
+        document_positions_.erase(document_id);
+        DropImpactIndex();
+    }
+
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocuments(const SearchServer& search_server, std::string_view raw_query,int document_id) {
+    return search_server.MatchDocument(raw_query, document_id);
+}
+
+std::vector<Document> FindTopDocuments(const SearchServer& search_server, std::string_view raw_query) {
+    return search_server.FindTopDocuments(raw_query);
+}
+void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    search_server.AddDocument(document_id, document, status, ratings);
 }
\ No newline at end of file
@@ -1,245 +1,1099 @@
-#pragma once
-#include <map>
-#include <set>
-#include <vector>
-#include <string>
-#include <stdexcept>
-#include <algorithm>
-#include <iterator>
-#include <execution>
-
-
-#include "document.h"
-#include "string_processing.h"
-#include "concurrent_map.h"
-
-const int MAX_RESULT_DOCUMENT_COUNT = 5;
-const double EPSILON = 1e-6;
-
-class SearchServer {
-public:
-    template <typename StringContainer>
-    explicit SearchServer(const StringContainer& stop_words);
-    explicit SearchServer(const std::string& stop_words_text);
-    explicit SearchServer(std::string_view stop_words_text);
-    explicit SearchServer();
-    void AddDocument(int document_id, std::string_view  document, DocumentStatus status,
-        const std::vector<int>& ratings);
-
-    template <typename DocumentPredicate, typename ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
-        DocumentPredicate document_predicate)const;
-
-    template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(std::string_view  raw_query,
-        DocumentPredicate document_predicate)const;
-
-    template <typename ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status)const;
-
-    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status)const;
-
-    template <typename ExecutionPolicy>
-    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query)const;
-
-    std::vector<Document> FindTopDocuments(std::string_view raw_query)const;
-
-    int GetDocumentCount()const;
-
-    std::set<int>::iterator begin();
-    std::set<int>::iterator end();
-
-    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
-        int document_id)const;
-
-    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy&, std::string_view raw_query, int document_id) const {
-        return MatchDocument(raw_query, document_id);
-    }
-
-
-    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy&, std::string_view raw_query, int document_id) const {
-        if (document_ids_.count(document_id) == 0) {
-            throw std::out_of_range("Такой id не существует");
-        }
-        const Query query = ParseQuery(raw_query);
-
-        if (any_of(std::execution::par,
-            query.minus_words.begin(), query.minus_words.end(),
-            [&](const std::string_view& word) {
-                return word_to_document_freqs_.at(std::string(word)).count(document_id);
-            })) {
-            std::vector<std::string_view> empty;
-            return { empty, documents_.at(document_id).status };
-        }
-
-        std::vector<std::string_view> matched_words(query.plus_words.size());
-        auto words_end = copy_if(std::execution::par,
-            query.plus_words.begin(), query.plus_words.end(),
-            matched_words.begin(),
-            [&](const std::string_view& word) { return word_to_document_freqs_.at(std::string(word)).count(document_id); }
-        );
-        std::sort(std::execution::par, matched_words.begin(), words_end);
-        words_end = std::unique(std::execution::par, matched_words.begin(), words_end);
-        matched_words.erase(words_end, matched_words.end());
-        return make_tuple(matched_words, documents_.at(document_id).status);
-    }
-
-    //////////
-
-    const std::map<std::string, double>& GetWordFrequencies(int document_id) const;
-
-    void RemoveDocument(int document_id);
-
-    template<class ExecutionPolicy>
-    void RemoveDocument(ExecutionPolicy&& policy, int document_id) {
-        if (document_ids_.find(document_id) != document_ids_.end()) {
-            documents_.erase(document_id);
-            document_ids_.erase(document_id);
-            auto& items = document_to_word_freqs_.at(document_id);
-            std::vector<std::string> words(items.size());
-            std::transform(policy, items.begin(), items.end(), words.begin(), [](const auto& item) { return item.first; });
-            std::for_each(policy, words.begin(), words.end(),
-                [&](auto word) {
-                    word_to_document_freqs_.at(word).erase(document_id);
-                });
-        }
-    }
-
-
-
-private:
-    struct DocumentData {
-        int rating;
-        DocumentStatus status;
-    };
-    struct QueryWord {
-        std::string_view data;
-        bool is_minus;
-        bool is_stop;
-    };
-    struct Query {
-        std::vector<std::string_view> plus_words;
-        std::vector<std::string_view> minus_words;
-    };
-
-    const std::set<std::string, std::less<>> stop_words_;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::set<int> document_ids_;
-    std::map<int, std::map<std::string, double>> document_to_word_freqs_;
-
-    bool IsStopWord(std::string_view word)const;
-
-    static bool IsValidWord(std::string_view word);
-
-    std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text)const;
-
-    static int ComputeAverageRating(const std::vector<int>& ratings);
-
-    QueryWord ParseQueryWord(std::string_view& text) const;
-
-    Query ParseQuery(const std::string_view& text)const;
-
-    double ComputeWordInverseDocumentFreq(const std::string& word)const;
-
-    template <typename DocumentPredicate, typename ExecutionPolicy>
-    std::vector<Document> FindAllDocuments(ExecutionPolicy&& policy, const Query& query,
-        DocumentPredicate document_predicate)const;
-};
-
-template <typename StringContainer>
-SearchServer::SearchServer(const StringContainer& stop_words)
-    : stop_words_(MakeUniqueNonEmptyStrings(stop_words))  // Extract non-empty stop words
-{
-    if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
-        throw  std::invalid_argument(std::string("Some of stop words are invalid"));
-    }
-}
-
-template <typename DocumentPredicate, typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
-    DocumentPredicate document_predicate)const {
-    const auto query = ParseQuery(raw_query);
-
-    auto matched_documents = FindAllDocuments(policy, query, document_predicate);
-
-    sort(matched_documents.begin(), matched_documents.end(),
-        [](const Document& lhs, const Document& rhs) {
-            if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
-                return lhs.rating > rhs.rating;
-            }
-            else {
-                return lhs.relevance > rhs.relevance;
-            }
-        });
-    if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-        matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
-    }
-
-    return matched_documents;
-}
-
-template <typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status) const {
-    return FindTopDocuments(policy,
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
-}
-
-template <typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const {
-    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
-}
-
-template <typename DocumentPredicate>
-std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
-    DocumentPredicate document_predicate)const {
-    return FindTopDocuments(std::execution::seq, raw_query, document_predicate);
-}
-
-template <typename DocumentPredicate, typename ExecutionPolicy>
-std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy&& policy, const Query& query,
-    DocumentPredicate document_predicate) const {
-    ConcurrentMap<int, double> document_to_relevance(12);
-
-    std::vector<std::string_view> plus_words = query.plus_words;
-    std::sort(policy, plus_words.begin(), plus_words.end());
-    auto words_end = std::unique(plus_words.begin(), plus_words.end());
-    plus_words.erase(words_end, plus_words.end());
-
-    const auto plus_word_checker =
-        [this, &document_predicate, &document_to_relevance](std::string_view word) {
-        if (word_to_document_freqs_.count(std::string(word)) == 0) {
-            return;
-        }
-        const double inverse_document_freq = ComputeWordInverseDocumentFreq(std::string(word));
-        for (const auto [document_id, term_freq] : word_to_document_freqs_.at(std::string(word))) {
-            const auto& document_data = documents_.at(document_id);
-            if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                document_to_relevance[document_id].ref_to_value += term_freq * inverse_document_freq;
-            }
-        }
-    };
-    std::for_each(policy, plus_words.begin(), plus_words.end(), plus_word_checker);
-
-    const auto minus_word_checker =
-        [this, &document_predicate, &document_to_relevance](std::string_view word) {
-        if (word_to_document_freqs_.count(std::string(word)) == 0) {
-            return;
-        }
-        for (const auto [document_id, _] : word_to_document_freqs_.at(std::string(word))) {
-            document_to_relevance.Erase(document_id);
-        }
-    };
-    std::for_each(policy, query.minus_words.begin(), query.minus_words.end(), minus_word_checker);
-
-    std::vector<Document> matched_documents;
-    for (const auto& [document_id, relevance] : document_to_relevance.BuildOrdinaryMap()) {
-        matched_documents.push_back({ document_id, relevance, documents_.at(document_id).rating });
-    }
-    return matched_documents;
-}
-std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocuments(const SearchServer& search_server, std::string_view raw_query, int document_id);
-std::vector<Document> FindTopDocuments(const SearchServer& search_server, std::string_view raw_query);
-void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
\ No newline at end of file
+#pragma once
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <iterator>
+#include <execution>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <queue>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "document.h"
+#include "string_processing.h"
+#include "stop_word_set.h"
+#include "tokenizer.h"
+#include "concurrent_map.h"
+#include "search_executor.h"
+#include "query_budget.h"
+#include "concurrency_limiter.h"
+#include "metrics.h"
+#include "query_stats.h"
+#include "match_result.h"
+#include "search_cursor.h"
+#include "search_server_options.h"
+#include "memory_resources.h"
+#include "memory_usage.h"
+#include "positional_index.h"
+#include "impact_index.h"
+#include "hot_term_cache.h"
+#include "scoring.h"
+
+const int MAX_RESULT_DOCUMENT_COUNT = 5;
+
+class SearchServer {
+public:
+    // Слова документа: ключи указывают на слова словаря сервера
+    using WordFrequencies = std::pmr::map<std::string_view, double>;
+
+    template <typename StringContainer>
+    explicit SearchServer(const StringContainer& stop_words);
+    template <typename StringContainer>
+    SearchServer(const StringContainer& stop_words, const SearchServerOptions& options);
+    explicit SearchServer(const std::string& stop_words_text);
+    SearchServer(const std::string& stop_words_text, const SearchServerOptions& options);
+    explicit SearchServer(std::string_view stop_words_text);
+    SearchServer(std::string_view stop_words_text, const SearchServerOptions& options);
+    explicit SearchServer(const SearchServerOptions& options);
+    explicit SearchServer();
+    // Индекс хранится в ресурсах памяти самого сервера, поэтому сервер не копируется, а только перемещается
+    SearchServer(const SearchServer&) = delete;
+    SearchServer& operator=(const SearchServer&) = delete;
+    SearchServer(SearchServer&&) = default;
+    // Возвращает id, под которым документ сохранён: при DuplicatePolicy::SUPERSEDE это меньший из id
+    // нового документа и заменённого им дубликата
+    int AddDocument(int document_id, std::string_view  document, DocumentStatus status,
+        const std::vector<int>& ratings);
+
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate)const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view  raw_query,
+        DocumentPredicate document_predicate)const;
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status)const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status)const;
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query)const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query)const;
+
+    // Ранжирование политикой scorer: TfIdfScorer, Bm25Scorer или своей (см. scoring.h).
+    // Остальные варианты FindTopDocuments ранжируют по TF-IDF
+    template <typename DocumentPredicate, typename Scorer, typename ExecutionPolicy,
+        typename = std::enable_if_t<IS_SCORER<Scorer>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, const Scorer& scorer)const;
+
+    template <typename DocumentPredicate, typename Scorer, typename = std::enable_if_t<IS_SCORER<Scorer>>>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+        const Scorer& scorer)const;
+
+    // Поиск с ограничением по времени и числу просмотренных записей индекса.
+    // При исчерпании бюджета возвращаются лучшие из уже найденных документов с флагом truncated
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    SearchResult FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, const QueryBudget& budget)const;
+
+    template <typename DocumentPredicate>
+    SearchResult FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate, const QueryBudget& budget)const;
+
+    // Поиск со сбором статистики выполнения запроса
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, QueryStats& stats)const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+        DocumentPredicate document_predicate, QueryStats& stats)const;
+
+    // Постраничная выдача без ограничения MAX_RESULT_DOCUMENT_COUNT
+    template <typename DocumentPredicate, typename ExecutionPolicy>
+    SearchCursor OpenCursor(ExecutionPolicy&& policy, std::string_view raw_query,
+        DocumentPredicate document_predicate, size_t page_size)const;
+
+    template <typename DocumentPredicate>
+    SearchCursor OpenCursor(std::string_view raw_query, DocumentPredicate document_predicate, size_t page_size)const;
+
+    SearchCursor OpenCursor(std::string_view raw_query, DocumentStatus status, size_t page_size)const;
+
+    SearchCursor OpenCursor(std::string_view raw_query, size_t page_size)const;
+
+    // Строит списки документов слов по убыванию квантованного вклада TF-IDF, bits бит на вклад. Пока списки
+    // есть, FindTopDocuments с TF-IDF и без фраз читает их и останавливается, как только непрочитанные
+    // документы уже не могут попасть в выдачу; релевантность прочитанных документов считается точно.
+    // Любое изменение индекса удаляет списки - режим рассчитан на редко меняющиеся корпуса
+    void BuildImpactIndex(int bits = ImpactList::MAX_BITS);
+
+    bool HasImpactIndex()const;
+    // Точность списков по вкладу; 0, если их нет
+    int GetImpactIndexBits()const;
+
+    // Настройки, с которыми создан сервер
+    const SearchServerOptions& GetOptions()const;
+
+    // Документ с меньшим id и тем же набором слов, если он есть. Без SearchServerOptions::duplicate_policy
+    // всегда std::nullopt
+    std::optional<int> GetDuplicateOf(int document_id)const;
+
+    // Ограничивает число одновременно выполняемых FindTopDocuments; лишние ждут или получают std::overflow_error.
+    // Новый предел действует для запросов, начатых после вызова; выполняющиеся возвращают слоты прежнему
+    void SetConcurrencyLimit(const ConcurrencyLimit& limit);
+
+    // Асинхронный поиск выполняется на пуле потоков сервера (см. ConfigureExecutor).
+    // Индекс нельзя изменять, пока есть незавершённые асинхронные запросы.
+    // Можно вызывать одновременно с FindTopDocumentsAsync: новые запросы идут в новый пул, а прежний
+    // дорабатывает принятые задачи и останавливается, когда его не использует ни один поток.
+    // Нельзя вызывать из задачи самого пула
+    void ConfigureExecutor(const SearchExecutorConfig& config);
+
+    template <typename DocumentPredicate>
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query,
+        DocumentPredicate document_predicate)const;
+
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query, DocumentStatus status)const;
+
+    std::future<std::vector<Document>> FindTopDocumentsAsync(std::string raw_query)const;
+
+    int GetDocumentCount()const;
+
+    std::pmr::set<int>::iterator begin();
+    std::pmr::set<int>::iterator end();
+    std::pmr::set<int>::const_iterator begin()const;
+    std::pmr::set<int>::const_iterator end()const;
+
+    // Ресурс, из которого размещается индекс
+    std::pmr::memory_resource* GetMemoryResource()const;
+
+    MemoryUsage GetMemoryUsage()const;
+
+    // Попадания, вытеснения и память кеша частых слов; нули, если кеш выключен
+    HotTermCacheStats GetHotTermCacheStats()const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
+        int document_id)const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query,
+        int document_id, QueryStats& stats)const;
+
+    // Сопоставляет один запрос со многими документами: запрос разбирается один раз,
+    // а список документов каждого слова запроса просматривается один раз для всей пачки
+    BatchMatchResult MatchDocuments(std::string_view raw_query, const std::vector<int>& document_ids)const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy&, std::string_view raw_query, int document_id) const {
+        return MatchDocument(raw_query, document_id);
+    }
+
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy&, std::string_view raw_query, int document_id) const {
+        SEARCH_METRICS_SCOPE(MetricPhase::MATCH_DOCUMENT);
+        if (document_ids_.count(document_id) == 0) {
+            throw std::out_of_range("Такой id не существует");
+        }
+        const Query query = ParseQuery(raw_query);
+
+        if (any_of(std::execution::par,
+            query.minus_words.begin(), query.minus_words.end(),
+            [&](const std::string_view& word) {
+                const auto* postings = FindWordPostings(word);
+                return postings && postings->count(document_id);
+            })) {
+            std::vector<std::string_view> empty;
+            return { empty, documents_.at(document_id).status };
+        }
+        if (!query.phrases.empty() && !MatchesPhrases(query, document_id)) {
+            return { std::vector<std::string_view>(), documents_.at(document_id).status };
+        }
+
+        // Найденные слова ссылаются на словарь сервера, а не на текст запроса
+        std::vector<std::string_view> matched_words(query.plus_words.size());
+        std::transform(std::execution::par,
+            query.plus_words.begin(), query.plus_words.end(),
+            matched_words.begin(),
+            [&](const std::string_view& word) {
+                const auto* entry = FindWord(word);
+                return entry && entry->second.count(document_id) ? std::string_view(entry->first) : std::string_view();
+            }
+        );
+        auto words_end = std::remove(std::execution::par, matched_words.begin(), matched_words.end(), std::string_view());
+        std::sort(std::execution::par, matched_words.begin(), words_end);
+        words_end = std::unique(std::execution::par, matched_words.begin(), words_end);
+        matched_words.erase(words_end, matched_words.end());
+        return make_tuple(matched_words, documents_.at(document_id).status);
+    }
+
+    //////////
+
+    // Изменение API: раньше возвращался const std::map<std::string, double>&. Ключи теперь указывают на
+    // слова словаря и действительны, пока слово есть в индексе. Поиск по std::string и строковым литералам
+    // работает как прежде; код, явно объявляющий std::map<std::string, double>, должен перейти на
+    // SearchServer::WordFrequencies или скопировать слова
+    const WordFrequencies& GetWordFrequencies(int document_id) const;
+
+    void RemoveDocument(int document_id);
+
+    template<class ExecutionPolicy>
+    void RemoveDocument(ExecutionPolicy&& policy, int document_id) {
+        SEARCH_METRICS_SCOPE(MetricPhase::REMOVE_DOCUMENT);
+        if (document_ids_.find(document_id) != document_ids_.end()) {
+            SEARCH_METRICS_ADD(MetricCounter::DOCUMENTS_REMOVED, 1);
+            UpdateHotTerms(document_id, false);
+            total_word_count_ -= documents_.at(document_id).word_count;
+            EraseFingerprint(document_id);
+            documents_.erase(document_id);
+            document_ids_.erase(document_id);
+            const auto& items = document_to_word_freqs_.at(document_id);
+            std::vector<std::string_view> words(items.size());
+            std::transform(policy, items.begin(), items.end(), words.begin(), [](const auto& item) { return item.first; });
+            std::for_each(policy, words.begin(), words.end(),
+                [&](std::string_view word) {
+                    word_to_document_freqs_.find(word)->second.erase(document_id);
+                });
+            document_to_word_freqs_.erase(document_id);
+            document_positions_.erase(document_id);
+            DropImpactIndex();
+        }
+    }
+
+
+
+private:
+    friend void WriteSnapshot(const SearchServer& server, std::ostream& output, uint64_t last_sequence);
+    friend SearchServer ReadSnapshot(std::istream& input, const SearchServerOptions& options,
+        uint64_t* last_sequence);
+
+    struct DocumentData {
+        int rating;
+        DocumentStatus status;
+        // Число слов без стоп-слов
+        uint32_t word_count;
+    };
+    struct QueryWord {
+        std::string_view data;
+        bool is_minus;
+        bool is_stop;
+        bool is_pattern;
+    };
+    struct Query {
+        std::vector<std::string_view> plus_words;
+        std::vector<std::string_view> minus_words;
+        // Нормализованные слова, изменённые токенизатором; остальные ссылаются на текст запроса
+        std::unique_ptr<char[]> buffer;
+        size_t truncated_patterns = 0;
+        // Фраза "big eyes" или близость "big eyes"~N; слова плюс-фраз есть и в plus_words
+        struct Phrase {
+            std::vector<std::string_view> words;
+            // 0 - слова подряд в порядке запроса, иначе - окно из стольких позиций
+            size_t window = 0;
+            bool is_minus = false;
+        };
+        std::vector<Phrase> phrases;
+    };
+
+    // Число вхождений слова в документ
+    using Postings = std::pmr::map<int, uint32_t>;
+    using Dictionary = std::pmr::map<std::pmr::string, Postings, std::less<>>;
+
+    SearchServerOptions options_;
+    const Tokenizer tokenizer_;
+    // Как tokenizer_, но не удаляет '*' шаблонов
+    const Tokenizer query_tokenizer_;
+    // Стоп-слова нормализованы tokenizer_
+    const StopWordSet stop_words_;
+    // Буфер нормализованных слов AddDocument
+    std::string document_buffer_;
+    // Арена и ресурс объявлены раньше контейнеров индекса, чтобы пережить их
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+    std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+
+    // Счётчики запросов к resource_ по частям индекса. В unique_ptr, чтобы сервер оставался перемещаемым
+    struct IndexMemory {
+        explicit IndexMemory(std::pmr::memory_resource* upstream);
+
+        // Словарь вместе со списками документов слов
+        CountingMemoryResource dictionary;
+        CountingMemoryResource forward_index;
+        CountingMemoryResource metadata;
+        CountingMemoryResource positions;
+        CountingMemoryResource impacts;
+        // Срезы и записи кеша частых слов вместе с его пулом
+        CountingMemoryResource caches;
+        // Часть dictionary, занятая узлами и строками самих слов
+        size_t word_bytes = 0;
+    };
+    std::unique_ptr<IndexMemory> memory_ = std::make_unique<IndexMemory>(resource_);
+    size_t memory_limit_ = 0;
+    size_t max_term_expansion_ = 0;
+    bool store_positions_ = false;
+    DuplicatePolicy duplicate_policy_ = DuplicatePolicy::KEEP;
+
+    // Слова из словаря не удаляются: на них ссылаются document_to_word_freqs_ и результаты MatchDocument
+    Dictionary word_to_document_freqs_{ &memory_->dictionary };
+    std::pmr::map<int, DocumentData> documents_{ &memory_->metadata };
+    std::pmr::set<int> document_ids_{ &memory_->metadata };
+    // Сумма DocumentData::word_count
+    uint64_t total_word_count_ = 0;
+    std::pmr::map<int, WordFrequencies> document_to_word_freqs_{ &memory_->forward_index };
+    // Отпечаток набора слов -> документы с ним; пусто при DuplicatePolicy::KEEP
+    std::pmr::unordered_multimap<uint64_t, int> fingerprints_{ &memory_->metadata };
+    // Пусто без SearchServerOptions::store_positions
+    std::pmr::map<int, DocumentPositions> document_positions_{ &memory_->positions };
+    // Ключи указывают на слова словаря; списки есть только после BuildImpactIndex
+    std::pmr::map<std::string_view, ImpactList> impact_lists_{ &memory_->impacts };
+    bool has_impact_index_ = false;
+    int impact_bits_ = 0;
+    // nullptr, если SearchServerOptions::hot_terms.capacity равен 0
+    std::unique_ptr<HotTermCache> hot_terms_;
+    // Читается и заменяется через std::atomic_load и std::atomic_store: запросы держат ограничитель,
+    // пока не вернут слот
+    std::shared_ptr<ConcurrencyLimiter> limiter_;
+    // Объявлен последним: при разрушении сервера сначала дорабатывают асинхронные запросы.
+    // Читается и заменяется через std::atomic_load и std::atomic_store
+    std::shared_ptr<SearchExecutor> executor_;
+
+    bool IsStopWord(std::string_view word)const;
+
+    static bool IsValidWord(std::string_view word);
+
+    // Изменённые нормализацией слова пишутся в buffer длиной не меньше text.size()
+    std::vector<std::string_view> SplitIntoWordsNoStop(std::string_view text, char* buffer)const;
+
+    template <typename StringContainer>
+    static std::vector<std::string> NormalizeStopWords(const StringContainer& stop_words, const Tokenizer& tokenizer);
+
+    template <typename StringContainer>
+    static StopWordSet MakeStopWords(const StringContainer& stop_words, const Tokenizer& tokenizer);
+
+    // Готовые таблицы копируются, если нормализация не меняет слов
+    template <size_t N>
+    static StopWordSet MakeStopWords(const StaticStopWordSet<N>& stop_words, const Tokenizer& tokenizer);
+
+    Dictionary::iterator FindOrAddWord(std::string_view word);
+
+    // Добавляет документ с уже посчитанными числами вхождений слов (загрузка снимка). Быстрее всего, если
+    // документы идут по возрастанию id, а слова документа - по алфавиту: вставки идут в конец деревьев
+    void RestoreDocument(int document_id, DocumentStatus status, int rating, uint32_t word_count,
+        const std::vector<std::pair<Dictionary::iterator, uint32_t>>& word_counts);
+
+    // Отпечаток набора слов - сумма хешей слов, поэтому не зависит от их порядка
+    static uint64_t HashTerm(std::string_view word);
+
+    // Документ с наименьшим id и тем же набором слов; words - по возрастанию, без повторов
+    std::optional<int> FindDuplicate(uint64_t fingerprint, const std::vector<std::string_view>& words,
+        int excluded_id = -1)const;
+
+    // Отпечаток пересчитывается по прямому индексу, чтобы не хранить его в метаданных каждого документа
+    uint64_t ComputeFingerprint(int document_id)const;
+    void EraseFingerprint(int document_id);
+
+    // Бросает std::length_error, если документ из этих слов может превысить предел памяти
+    void CheckMemoryLimit(const std::vector<std::string_view>& words)const;
+
+    static int ComputeAverageRating(const std::vector<int>& ratings);
+
+    QueryWord ParseQueryWord(const Token& token) const;
+
+    static TokenizerOptions GetQueryTokenizerOptions(const SearchServerOptions& options);
+
+    // Добавляет в запрос слова словаря, подходящие под шаблон
+    void ExpandPattern(std::string_view pattern, bool is_minus, Query& query) const;
+
+    Query ParseQuery(const std::string_view& text)const;
+
+    // Слова вне фраз. buffer - свободная часть буфера запроса, сдвигается за нормализованными словами
+    void ParseQueryWords(std::string_view text, char*& buffer, Query& query)const;
+
+    // slop задан для близости "..."~slop
+    void ParsePhrase(std::string_view text, char*& buffer, bool is_minus, std::optional<size_t> slop,
+        Query& query)const;
+
+    // Документ содержит все плюс-фразы и ни одной минус-фразы
+    bool MatchesPhrases(const Query& query, int document_id)const;
+
+    double ComputeWordInverseDocumentFreq(std::string_view word)const;
+
+    // nullptr, если слова нет в индексе
+    const Dictionary::value_type* FindWord(std::string_view word)const;
+    const Postings* FindWordPostings(std::string_view word)const;
+
+    template <typename DocumentPredicate, typename Scorer, typename ExecutionPolicy>
+    std::vector<Document> FindAllDocuments(ExecutionPolicy&& policy, const Query& query,
+        DocumentPredicate document_predicate, const Scorer& scorer, QueryBudgetTracker* budget = nullptr,
+        QueryStats* stats = nullptr)const;
+
+    // Счётчики обхода индекса для QueryStats
+    struct TraversalCounters {
+        size_t postings_scanned = 0;
+        size_t rejected_by_predicate = 0;
+        size_t rejected_by_minus_words = 0;
+        size_t cached_terms = 0;
+    };
+
+    // Последовательный обход по окнам из SCORE_WINDOW_SIZE номеров документов: записи всех слов запроса,
+    // попавшие в окно, собираются в плотные массивы кандидатов окна, метаданные и предикат читаются один раз
+    // на документ окна (документы из срезов кеша частых слов предикат уже прошли), минус-слова отмечаются в маске окна.
+    // Вклады слов складываются в порядке plus_words, как в параллельном обходе
+    template <typename DocumentPredicate, typename Scorer>
+    std::vector<Document> FindWindowDocuments(const std::pmr::vector<std::string_view>& plus_words,
+        const Query& query, DocumentPredicate document_predicate, const Scorer& scorer,
+        const TermScoringContext& scoring_context, QueryBudgetTracker* budget, std::pmr::memory_resource* resource,
+        TraversalCounters& counters)const;
+
+    void FillTermStats(const Query& query, QueryStats& stats)const;
+
+    // Срез слова для документов со статусом; при первом обращении к частому слову срез строится по его списку.
+    // nullptr, если слово не кешируется
+    std::shared_ptr<const HotTermSlice> FindHotTermSlice(const Dictionary::value_type& entry,
+        DocumentStatus status)const;
+
+    // Срезы кешируются только для StatusPredicate: произвольный предикат нельзя применить заранее
+    template <typename DocumentPredicate>
+    std::shared_ptr<const HotTermSlice> FindHotTermSlice(const Dictionary::value_type& entry,
+        const DocumentPredicate& document_predicate)const;
+
+    // Вносит документ в срезы его слов или удаляет из них; вызывается, пока документ есть в индексе
+    void UpdateHotTerms(int document_id, bool is_added);
+
+    void DropImpactIndex();
+
+    bool CanUseImpactIndex(const Query& query)const;
+
+    // Алгоритм порогов (threshold algorithm) по спискам вкладов: на каждом шаге читается список с наибольшей
+    // границей вклада, новый документ оценивается точно по спискам документов слов. Чтение прекращается,
+    // когда MAX_RESULT_DOCUMENT_COUNT-й результат больше суммы границ более чем на EPSILON
+    template <typename DocumentPredicate>
+    std::vector<Document> FindImpactDocuments(const Query& query, DocumentPredicate document_predicate)const;
+
+    // postings_scanned, если задан, увеличивается на число списков документов, в которых искался документ
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchParsedQuery(const Query& query,
+        int document_id, size_t* postings_scanned = nullptr)const;
+
+    static void SelectTopDocuments(std::vector<Document>& matched_documents);
+
+    // Окно помещается в L1: на кандидата приходятся релевантность, длина и число вхождений слова
+    static constexpr int64_t SCORE_WINDOW_SIZE = 1024;
+};
+
+template <typename StringContainer>
+SearchServer::SearchServer(const StringContainer& stop_words)
+    : SearchServer(stop_words, SearchServerOptions{})
+{
+}
+
+template <typename StringContainer>
+SearchServer::SearchServer(const StringContainer& stop_words, const SearchServerOptions& options)
+    : options_(options)
+    , tokenizer_(options.tokenizer)
+    , query_tokenizer_(GetQueryTokenizerOptions(options))
+    , stop_words_(MakeStopWords(stop_words, tokenizer_))  // Нормализуются токенизатором документов
+    , arena_(options.use_arena ? std::make_unique<std::pmr::monotonic_buffer_resource>(options.arena_initial_size,
+        options.memory_resource ? options.memory_resource : std::pmr::get_default_resource()) : nullptr)
+    , resource_(arena_ ? arena_.get()
+        : options.memory_resource ? options.memory_resource : std::pmr::get_default_resource())
+    , memory_limit_(options.memory_limit)
+    , max_term_expansion_(options.max_term_expansion)
+    , store_positions_(options.store_positions)
+    , duplicate_policy_(options.duplicate_policy)
+    , hot_terms_(options.hot_terms.capacity > 0 ? std::make_unique<HotTermCache>(options.hot_terms, &memory_->caches)
+        : nullptr)
+{
+    if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
+        throw  std::invalid_argument(std::string("Some of stop words are invalid"));
+    }
+}
+
+template <typename StringContainer>
+std::vector<std::string> SearchServer::NormalizeStopWords(const StringContainer& stop_words,
+    const Tokenizer& tokenizer) {
+    std::vector<std::string> words;
+    std::string buffer;
+    for (const std::string_view word : stop_words) {
+        buffer.resize(word.size());
+        tokenizer.ForEachToken(word, buffer.data(), [&words](const Token& token) {
+            words.emplace_back(token.normalized);
+            });
+    }
+    return words;
+}
+
+template <typename StringContainer>
+StopWordSet SearchServer::MakeStopWords(const StringContainer& stop_words, const Tokenizer& tokenizer) {
+    return StopWordSet(NormalizeStopWords(stop_words, tokenizer));
+}
+
+template <size_t N>
+StopWordSet SearchServer::MakeStopWords(const StaticStopWordSet<N>& stop_words, const Tokenizer& tokenizer) {
+    const auto words = NormalizeStopWords(stop_words.GetWords(), tokenizer);
+    if (std::equal(words.begin(), words.end(), stop_words.GetWords().begin(), stop_words.GetWords().end())) {
+        return StopWordSet(stop_words);
+    }
+    return StopWordSet(words);
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate)const {
+    return FindTopDocuments(policy, raw_query, document_predicate, TfIdfScorer());
+}
+
+template <typename DocumentPredicate, typename Scorer, typename ExecutionPolicy, typename>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, const Scorer& scorer)const {
+    ConcurrencyLimiter::Permit permit(std::atomic_load(&limiter_));
+    SEARCH_METRICS_SCOPE(MetricPhase::FIND_TOP_DOCUMENTS);
+    SEARCH_METRICS_ADD(MetricCounter::QUERIES, 1);
+    const auto query = ParseQuery(raw_query);
+
+    auto matched_documents = std::is_same_v<Scorer, TfIdfScorer> && CanUseImpactIndex(query)
+        ? FindImpactDocuments(query, document_predicate)
+        : FindAllDocuments(policy, query, document_predicate, scorer);
+    SelectTopDocuments(matched_documents);
+
+    return matched_documents;
+}
+
+template <typename DocumentPredicate, typename Scorer, typename>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate, const Scorer& scorer)const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate, scorer);
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+SearchResult SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, const QueryBudget& budget)const {
+    ConcurrencyLimiter::Permit permit(std::atomic_load(&limiter_));
+    SEARCH_METRICS_SCOPE(MetricPhase::FIND_TOP_DOCUMENTS);
+    SEARCH_METRICS_ADD(MetricCounter::QUERIES, 1);
+    QueryBudgetTracker tracker(budget);
+    const auto query = ParseQuery(raw_query);
+
+    SearchResult result;
+    result.documents = FindAllDocuments(policy, query, document_predicate, TfIdfScorer(), &tracker);
+    SelectTopDocuments(result.documents);
+    result.truncated = tracker.IsExhausted();
+
+    return result;
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, QueryStats& stats)const {
+    using Clock = std::chrono::steady_clock;
+    ConcurrencyLimiter::Permit permit(std::atomic_load(&limiter_));
+    SEARCH_METRICS_SCOPE(MetricPhase::FIND_TOP_DOCUMENTS);
+    SEARCH_METRICS_ADD(MetricCounter::QUERIES, 1);
+    stats = QueryStats{};
+    stats.execution_policy = GetExecutionPolicyName<ExecutionPolicy>();
+
+    auto start = Clock::now();
+    const auto query = ParseQuery(raw_query);
+    stats.parse_time = Clock::now() - start;
+    FillTermStats(query, stats);
+
+    auto matched_documents = FindAllDocuments(policy, query, document_predicate, TfIdfScorer(), nullptr, &stats);
+    start = Clock::now();
+    SelectTopDocuments(matched_documents);
+    stats.top_k_time = Clock::now() - start;
+    stats.documents_returned = matched_documents.size();
+
+    return matched_documents;
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate, QueryStats& stats)const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate, stats);
+}
+
+template <typename DocumentPredicate>
+SearchResult SearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate, const QueryBudget& budget)const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate, budget);
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query, DocumentStatus status) const {
+    return FindTopDocuments(policy, raw_query, StatusPredicate{ status });
+}
+
+template <typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const {
+    return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query,
+    DocumentPredicate document_predicate)const {
+    return FindTopDocuments(std::execution::seq, raw_query, document_predicate);
+}
+
+template <typename DocumentPredicate, typename ExecutionPolicy>
+SearchCursor SearchServer::OpenCursor(ExecutionPolicy&& policy, std::string_view raw_query,
+    DocumentPredicate document_predicate, size_t page_size)const {
+    ConcurrencyLimiter::Permit permit(std::atomic_load(&limiter_));
+    SEARCH_METRICS_SCOPE(MetricPhase::FIND_TOP_DOCUMENTS);
+    SEARCH_METRICS_ADD(MetricCounter::QUERIES, 1);
+    const auto query = ParseQuery(raw_query);
+    return SearchCursor(FindAllDocuments(policy, query, document_predicate, TfIdfScorer()), page_size);
+}
+
+template <typename DocumentPredicate>
+SearchCursor SearchServer::OpenCursor(std::string_view raw_query, DocumentPredicate document_predicate,
+    size_t page_size)const {
+    return OpenCursor(std::execution::seq, raw_query, document_predicate, page_size);
+}
+
+template <typename DocumentPredicate>
+std::future<std::vector<Document>> SearchServer::FindTopDocumentsAsync(std::string raw_query,
+    DocumentPredicate document_predicate)const {
+    const auto executor = std::atomic_load(&executor_);
+    if (!executor) {
+        throw std::logic_error(std::string("Search executor is not configured"));
+    }
+    return executor->Submit(
+        [this, raw_query = std::move(raw_query), document_predicate]() {
+            return FindTopDocuments(std::execution::seq, raw_query, document_predicate);
+        });
+}
+
+template <typename DocumentPredicate>
+std::shared_ptr<const HotTermSlice> SearchServer::FindHotTermSlice(const Dictionary::value_type& entry,
+    const DocumentPredicate& document_predicate)const {
+    if constexpr (std::is_same_v<DocumentPredicate, StatusPredicate>) {
+        return FindHotTermSlice(entry, document_predicate.status);
+    }
+    else {
+        return nullptr;
+    }
+}
+
+template <typename DocumentPredicate, typename Scorer, typename ExecutionPolicy>
+std::vector<Document> SearchServer::FindAllDocuments(ExecutionPolicy&& policy, const Query& query,
+    DocumentPredicate document_predicate, const Scorer& scorer, QueryBudgetTracker* budget, QueryStats* stats) const {
+    using Clock = std::chrono::steady_clock;
+    QueryScratchScope scratch(!std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>);
+    std::atomic<size_t> postings_scanned = 0;
+    std::atomic<size_t> rejected_by_predicate = 0;
+    std::atomic<size_t> rejected_by_minus_words = 0;
+    std::atomic<size_t> cached_terms = 0;
+
+    std::pmr::vector<std::string_view> plus_words(query.plus_words.begin(), query.plus_words.end(),
+        scratch.GetResource());
+    std::sort(policy, plus_words.begin(), plus_words.end());
+    auto words_end = std::unique(plus_words.begin(), plus_words.end());
+    plus_words.erase(words_end, plus_words.end());
+
+    TermScoringContext scoring_context;
+    scoring_context.document_count = documents_.size();
+    scoring_context.average_document_length = documents_.empty() ? 0.0
+        : static_cast<double>(total_word_count_) / documents_.size();
+    auto start = stats ? Clock::now() : Clock::time_point();
+    std::vector<Document> matched_documents;
+    if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+        TraversalCounters counters;
+        {
+            SEARCH_METRICS_SCOPE(MetricPhase::POSTING_TRAVERSAL);
+            matched_documents = FindWindowDocuments(plus_words, query, document_predicate, scorer, scoring_context,
+                budget, scratch.GetResource(), counters);
+        }
+        SEARCH_METRICS_ADD(MetricCounter::POSTINGS_SCANNED, counters.postings_scanned);
+        postings_scanned = counters.postings_scanned;
+        rejected_by_predicate = counters.rejected_by_predicate;
+        rejected_by_minus_words = counters.rejected_by_minus_words;
+        cached_terms = counters.cached_terms;
+        if (stats) {
+            stats->traversal_time = Clock::now() - start;
+            start = Clock::now();
+        }
+    }
+    else {
+        ConcurrentMap<int, double> document_to_relevance(12, scratch.GetResource());
+        const auto plus_word_checker =
+            [this, &document_predicate, &scorer, &scoring_context, &document_to_relevance, budget, stats,
+            &postings_scanned, &rejected_by_predicate, &cached_terms](std::string_view word) {
+            const auto* entry = FindWord(word);
+            if (!entry || entry->second.empty()) {
+                return;
+            }
+            const Postings& postings = entry->second;
+            TermScoringContext context = scoring_context;
+            context.document_freq = postings.size();
+            context.inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+            const auto term = PrepareTerm(scorer, context);
+            size_t posting_count = 0;
+            size_t rejected_count = 0;
+            const auto consume = [budget, &posting_count]() {
+                if (budget && posting_count % QueryBudgetTracker::CHECK_INTERVAL == 0
+                    && !budget->Consume(QueryBudgetTracker::CHECK_INTERVAL)) {
+                    return false;
+                }
+                ++posting_count;
+                return true;
+            };
+            if (const auto slice = FindHotTermSlice(*entry, document_predicate)) {
+                // Срез уже отфильтрован по статусу, длины документов лежат в нём
+                ++cached_terms;
+                for (size_t i = 0; i < slice->GetSize() && consume(); ++i) {
+                    document_to_relevance.FetchAdd(slice->document_ids[i],
+                        ScoreTerm(scorer, term, slice->term_counts[i], slice->document_lengths[i]));
+                }
+            }
+            else {
+                for (auto it = postings.begin(); it != postings.end() && consume(); ++it) {
+                    const auto [document_id, term_count] = *it;
+                    const auto& document_data = documents_.at(document_id);
+                    if (document_predicate(document_id, document_data.status, document_data.rating)) {
+                        document_to_relevance.FetchAdd(document_id,
+                            ScoreTerm(scorer, term, term_count, document_data.word_count));
+                    }
+                    else {
+                        ++rejected_count;
+                    }
+                }
+            }
+            SEARCH_METRICS_ADD(MetricCounter::POSTINGS_SCANNED, posting_count);
+            if (stats) {
+                postings_scanned += posting_count;
+                rejected_by_predicate += rejected_count;
+            }
+        };
+        {
+            SEARCH_METRICS_SCOPE(MetricPhase::POSTING_TRAVERSAL);
+            std::for_each(policy, plus_words.begin(), plus_words.end(), plus_word_checker);
+        }
+        if (stats) {
+            stats->traversal_time = Clock::now() - start;
+            start = Clock::now();
+        }
+
+        const auto minus_word_checker =
+            [this, &document_to_relevance, stats, &rejected_by_minus_words](std::string_view word) {
+            const auto* postings = FindWordPostings(word);
+            if (!postings) {
+                return;
+            }
+            size_t erased_count = 0;
+            for (const auto [document_id, _] : *postings) {
+                erased_count += document_to_relevance.Erase(document_id);
+            }
+            if (stats) {
+                rejected_by_minus_words += erased_count;
+            }
+        };
+        {
+            SEARCH_METRICS_SCOPE(MetricPhase::MINUS_WORD_FILTER);
+            std::for_each(policy, query.minus_words.begin(), query.minus_words.end(), minus_word_checker);
+        }
+        if (stats) {
+            stats->minus_filter_time = Clock::now() - start;
+            start = Clock::now();
+        }
+
+        matched_documents = document_to_relevance.Drain(policy, [this](int document_id, double relevance) {
+            return Document{ document_id, relevance, documents_.at(document_id).rating };
+        });
+    }
+    // Позиции читаются только для кандидатов, оставшихся после минус-слов
+    size_t rejected_by_phrases = 0;
+    if (!query.phrases.empty()) {
+        SEARCH_METRICS_SCOPE(MetricPhase::PHRASE_FILTER);
+        const auto phrases_end = std::remove_if(matched_documents.begin(), matched_documents.end(),
+            [this, &query](const Document& document) { return !MatchesPhrases(query, document.id); });
+        rejected_by_phrases = static_cast<size_t>(matched_documents.end() - phrases_end);
+        matched_documents.erase(phrases_end, matched_documents.end());
+    }
+    SEARCH_METRICS_ADD(MetricCounter::DOCUMENTS_MATCHED, matched_documents.size());
+    if (stats) {
+        stats->phrase_filter_time = Clock::now() - start;
+        stats->postings_scanned = postings_scanned;
+        stats->rejected_by_predicate = rejected_by_predicate;
+        stats->rejected_by_minus_words = rejected_by_minus_words;
+        stats->rejected_by_phrases = rejected_by_phrases;
+        stats->cached_terms = cached_terms;
+        stats->candidates_created = matched_documents.size() + rejected_by_minus_words + rejected_by_phrases;
+    }
+    return matched_documents;
+}
+
+template <typename DocumentPredicate, typename Scorer>
+std::vector<Document> SearchServer::FindWindowDocuments(const std::pmr::vector<std::string_view>& plus_words,
+    const Query& query, DocumentPredicate document_predicate, const Scorer& scorer,
+    const TermScoringContext& scoring_context, QueryBudgetTracker* budget, std::pmr::memory_resource* resource,
+    TraversalCounters& counters)const {
+    // Отметки документов окна в window_slots; остальные значения - номер кандидата в плотных массивах.
+    // CACHED - документ из среза частого слова: предикат выполнен, длина и рейтинг уже в window_lengths
+    // и window_ratings
+    constexpr uint32_t NOT_SCANNED = std::numeric_limits<uint32_t>::max();
+    constexpr uint32_t SCANNED = NOT_SCANNED - 1;
+    constexpr uint32_t REJECTED = NOT_SCANNED - 2;
+    constexpr uint32_t CACHED = NOT_SCANNED - 3;
+    struct Term {
+        Postings::const_iterator next;
+        Postings::const_iterator end;
+        // Срез вместо списка документов, если слово есть в кеше частых слов
+        std::shared_ptr<const HotTermSlice> slice;
+        size_t slice_position;
+        PreparedTerm<Scorer> prepared;
+        size_t scanned;
+        // Записи окна: смещение документа от начала окна и число вхождений
+        std::pmr::vector<std::pair<uint32_t, uint32_t>> window_postings;
+
+        int64_t GetNextDocument() const {
+            if (slice) {
+                return slice_position < slice->GetSize() ? slice->document_ids[slice_position]
+                    : std::numeric_limits<int64_t>::max();
+            }
+            return next != end ? next->first : std::numeric_limits<int64_t>::max();
+        }
+    };
+    std::pmr::vector<Term> terms(resource);
+    bool has_slices = false;
+    for (const std::string_view word : plus_words) {
+        const auto* entry = FindWord(word);
+        if (!entry || entry->second.empty()) {
+            continue;
+        }
+        const Postings& postings = entry->second;
+        TermScoringContext context = scoring_context;
+        context.document_freq = postings.size();
+        context.inverse_document_freq = ComputeWordInverseDocumentFreq(word);
+        auto slice = FindHotTermSlice(*entry, document_predicate);
+        has_slices = has_slices || slice;
+        counters.cached_terms += slice ? 1 : 0;
+        terms.push_back({ postings.begin(), postings.end(), std::move(slice), 0, PrepareTerm(scorer, context), 0,
+            std::pmr::vector<std::pair<uint32_t, uint32_t>>(resource) });
+    }
+    std::pmr::vector<std::pair<Postings::const_iterator, Postings::const_iterator>> minus_terms(resource);
+    for (const std::string_view word : query.minus_words) {
+        if (const auto* postings = FindWordPostings(word)) {
+            minus_terms.emplace_back(postings->begin(), postings->end());
+        }
+    }
+
+    std::pmr::vector<uint32_t> window_slots(SCORE_WINDOW_SIZE, NOT_SCANNED, resource);
+    std::pmr::vector<uint32_t> window_lengths(has_slices ? SCORE_WINDOW_SIZE : 0, resource);
+    std::pmr::vector<int> window_ratings(has_slices ? SCORE_WINDOW_SIZE : 0, resource);
+    // Смещения документов окна, встреченных хотя бы в одном списке
+    std::pmr::vector<uint32_t> window_documents(resource);
+    std::pmr::vector<int> candidate_ids(resource);
+    std::pmr::vector<int> candidate_ratings(resource);
+    std::pmr::vector<uint32_t> candidate_lengths(resource);
+    std::pmr::vector<uint32_t> term_counts(resource);
+    std::pmr::vector<double> scores(resource);
+    std::pmr::vector<char> excluded(resource);
+    std::vector<Document> matched_documents;
+    bool exhausted = false;
+    const auto consume = [budget, &exhausted](Term& term) {
+        if (budget && term.scanned % QueryBudgetTracker::CHECK_INTERVAL == 0
+            && !budget->Consume(QueryBudgetTracker::CHECK_INTERVAL)) {
+            exhausted = true;
+            return false;
+        }
+        ++term.scanned;
+        return true;
+    };
+    while (!exhausted) {
+        // Окно начинается с наименьшего непрочитанного документа, поэтому пустые диапазоны номеров пропускаются
+        int64_t window_begin = std::numeric_limits<int64_t>::max();
+        for (const Term& term : terms) {
+            window_begin = std::min(window_begin, term.GetNextDocument());
+        }
+        if (window_begin == std::numeric_limits<int64_t>::max()) {
+            break;
+        }
+        const int64_t window_end = window_begin + SCORE_WINDOW_SIZE;
+        for (Term& term : terms) {
+            term.window_postings.clear();
+            if (term.slice) {
+                const HotTermSlice& slice = *term.slice;
+                for (; !exhausted && term.slice_position < slice.GetSize()
+                    && slice.document_ids[term.slice_position] < window_end && consume(term); ++term.slice_position) {
+                    const size_t position = term.slice_position;
+                    const auto offset = static_cast<uint32_t>(slice.document_ids[position] - window_begin);
+                    term.window_postings.emplace_back(offset, slice.term_counts[position]);
+                    uint32_t& slot = window_slots[offset];
+                    if (slot == NOT_SCANNED) {
+                        window_documents.push_back(offset);
+                    }
+                    if (slot != CACHED) {
+                        slot = CACHED;
+                        window_lengths[offset] = slice.document_lengths[position];
+                        window_ratings[offset] = slice.ratings[position];
+                    }
+                }
+                continue;
+            }
+            for (; !exhausted && term.next != term.end && term.next->first < window_end && consume(term);
+                ++term.next) {
+                const auto offset = static_cast<uint32_t>(term.next->first - window_begin);
+                term.window_postings.emplace_back(offset, term.next->second);
+                if (window_slots[offset] == NOT_SCANNED) {
+                    window_slots[offset] = SCANNED;
+                    window_documents.push_back(offset);
+                }
+            }
+        }
+
+        // Предикат вычисляется по разу на документ окна; кандидаты идут по возрастанию id
+        std::sort(window_documents.begin(), window_documents.end());
+        candidate_ids.clear();
+        candidate_ratings.clear();
+        candidate_lengths.clear();
+        for (const uint32_t offset : window_documents) {
+            const int document_id = static_cast<int>(window_begin + offset);
+            uint32_t& slot = window_slots[offset];
+            if (slot == CACHED) {
+                slot = static_cast<uint32_t>(candidate_ids.size());
+                candidate_ids.push_back(document_id);
+                candidate_ratings.push_back(window_ratings[offset]);
+                candidate_lengths.push_back(window_lengths[offset]);
+                continue;
+            }
+            const DocumentData& document_data = documents_.at(document_id);
+            if (document_predicate(document_id, document_data.status, document_data.rating)) {
+                slot = static_cast<uint32_t>(candidate_ids.size());
+                candidate_ids.push_back(document_id);
+                candidate_ratings.push_back(document_data.rating);
+                candidate_lengths.push_back(document_data.word_count);
+            }
+            else {
+                slot = REJECTED;
+            }
+        }
+
+        const size_t candidate_count = candidate_ids.size();
+        scores.assign(candidate_count, 0.0);
+        term_counts.resize(candidate_count);
+        for (const Term& term : terms) {
+            if (term.window_postings.empty()) {
+                continue;
+            }
+            std::fill(term_counts.begin(), term_counts.end(), 0);
+            for (const auto& [offset, term_count] : term.window_postings) {
+                const uint32_t slot = window_slots[offset];
+                if (slot == REJECTED) {
+                    ++counters.rejected_by_predicate;
+                }
+                else {
+                    term_counts[slot] = term_count;
+                }
+            }
+            AccumulateTermScores(scorer, term.prepared, term_counts.data(), candidate_lengths.data(), scores.data(),
+                candidate_count);
+        }
+
+        excluded.assign(candidate_count, 0);
+        for (auto& [next, end] : minus_terms) {
+            for (; next != end && next->first < window_end; ++next) {
+                if (next->first >= window_begin) {
+                    const uint32_t slot = window_slots[next->first - window_begin];
+                    if (slot < candidate_count) {
+                        excluded[slot] = 1;
+                    }
+                }
+            }
+        }
+        for (size_t i = 0; i < candidate_count; ++i) {
+            if (excluded[i]) {
+                ++counters.rejected_by_minus_words;
+            }
+            else {
+                matched_documents.push_back({ candidate_ids[i], scores[i], candidate_ratings[i] });
+            }
+        }
+
+        for (const uint32_t offset : window_documents) {
+            window_slots[offset] = NOT_SCANNED;
+        }
+        window_documents.clear();
+    }
+    for (const Term& term : terms) {
+        counters.postings_scanned += term.scanned;
+    }
+    return matched_documents;
+}
+
+template <typename DocumentPredicate>
+std::vector<Document> SearchServer::FindImpactDocuments(const Query& query,
+    DocumentPredicate document_predicate)const {
+    SEARCH_METRICS_SCOPE(MetricPhase::POSTING_TRAVERSAL);
+    struct Term {
+        const ImpactList* list;
+        size_t position;
+        const Postings* postings;
+        double inverse_document_freq;
+    };
+    std::vector<std::string_view> plus_words = query.plus_words;
+    std::sort(plus_words.begin(), plus_words.end());
+    plus_words.erase(std::unique(plus_words.begin(), plus_words.end()), plus_words.end());
+    // Слова в порядке FindAllDocuments, чтобы суммы релевантности совпадали до бита
+    std::vector<Term> terms;
+    for (const std::string_view word : plus_words) {
+        const auto* entry = FindWord(word);
+        if (entry && !entry->second.empty()) {
+            terms.push_back({ &impact_lists_.at(entry->first), 0, &entry->second,
+                ComputeWordInverseDocumentFreq(word) });
+        }
+    }
+    std::vector<const Postings*> minus_postings;
+    for (const std::string_view word : query.minus_words) {
+        if (const auto* postings = FindWordPostings(word)) {
+            minus_postings.push_back(postings);
+        }
+    }
+
+    const TfIdfScorer scorer;
+    std::vector<Document> matched_documents;
+    std::unordered_set<int> seen_documents;
+    // Наименьшая из MAX_RESULT_DOCUMENT_COUNT лучших релевантностей - на вершине
+    std::priority_queue<double, std::vector<double>, std::greater<double>> top_relevance;
+    size_t postings_scanned = 0;
+    while (true) {
+        double threshold = 0.0;
+        Term* next = nullptr;
+        for (Term& term : terms) {
+            const double bound = term.list->GetBound(term.position);
+            threshold += bound;
+            if (term.position < term.list->GetEntries().size()
+                && (!next || bound > next->list->GetBound(next->position))) {
+                next = &term;
+            }
+        }
+        if (!next || (top_relevance.size() == MAX_RESULT_DOCUMENT_COUNT && top_relevance.top() > threshold + EPSILON)) {
+            break;
+        }
+        const int document_id = next->list->GetEntries()[next->position++].document_id;
+        ++postings_scanned;
+        if (!seen_documents.insert(document_id).second) {
+            continue;
+        }
+        const auto& document_data = documents_.at(document_id);
+        if (!document_predicate(document_id, document_data.status, document_data.rating)
+            || std::any_of(minus_postings.begin(), minus_postings.end(),
+                [document_id](const Postings* postings) { return postings->count(document_id) > 0; })) {
+            continue;
+        }
+        double relevance = 0.0;
+        for (const Term& term : terms) {
+            const auto it = term.postings->find(document_id);
+            if (it != term.postings->end()) {
+                relevance += scorer.Score(term.inverse_document_freq, it->second, document_data.word_count);
+            }
+        }
+        matched_documents.push_back({ document_id, relevance, document_data.rating });
+        top_relevance.push(relevance);
+        if (top_relevance.size() > MAX_RESULT_DOCUMENT_COUNT) {
+            top_relevance.pop();
+        }
+    }
+    SEARCH_METRICS_ADD(MetricCounter::POSTINGS_SCANNED, postings_scanned);
+    return matched_documents;
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocuments(const SearchServer& search_server, std::string_view raw_query, int document_id);
+std::vector<Document> FindTopDocuments(const SearchServer& search_server, std::string_view raw_query);
+void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+#include "hot_term_cache.h"
+#include "tokenizer.h"
+
+// Что AddDocument делает с документом, набор слов которого (без стоп-слов) совпадает с набором слов
+// документа в индексе. Как и в RemoveDuplicates, из двух дубликатов оригинал - документ с меньшим id
+enum class DuplicatePolicy {
+    // Дубликаты не ищутся
+    KEEP,
+    // Дубликат не попадает в индекс: AddDocument бросает std::invalid_argument, а если дубликат -
+    // документ в индексе (id нового меньше), он удаляется
+    REJECT,
+    // В индексе остаются оба документа, GetDuplicateOf дубликата возвращает id оригинала
+    FLAG,
+    // Новый документ заменяет документ в индексе и получает меньший из двух id
+    SUPERSEDE,
+};
+
+struct SearchServerOptions {
+    // Источник памяти для словаря, списков документов и метаданных; nullptr - ресурс по умолчанию.
+    // Ресурс должен пережить сервер. Параллельный RemoveDocument освобождает память из нескольких
+    // потоков, поэтому для него ресурс должен быть потокобезопасным
+    std::pmr::memory_resource* memory_resource = nullptr;
+    // Режим однократно построенного индекса: память берётся блоками из монотонной арены поверх
+    // memory_resource и возвращается целиком при разрушении сервера.
+    // Память удалённых документов при этом не переиспользуется
+    bool use_arena = false;
+    size_t arena_initial_size = size_t(1) << 20;
+    // Предел памяти индекса (MemoryUsage::GetTotal) в байтах; 0 - без ограничения.
+    // AddDocument, который может его превысить, отклоняется с std::length_error
+    size_t memory_limit = 0;
+    // Разбиение на слова и нормализация документов, запросов и стоп-слов. По умолчанию - разделитель
+    // пробел и слова без изменений. Снимок нужно читать с теми же настройками, с которыми он записан
+    TokenizerOptions tokenizer;
+    // Слово запроса со '*' - шаблон: '*' означает любую последовательность символов (cat*, c*t).
+    // Шаблон раскрывается не более чем в столько слов словаря по алфавиту, они ищутся как обычные
+    // слова запроса; минус-шаблон раскрывается полностью. Шаблон должен начинаться с буквы.
+    // 0 (по умолчанию) - '*' не особый символ, как до появления шаблонов
+    size_t max_term_expansion = 0;
+    // Хранить позиции слов документов. Включает в запросе фразы "big eyes" (слова подряд),
+    // близость "big eyes"~N (слова в любом порядке в окне на N позиций шире фразы) и минус-фразы
+    // -"big eyes". Стоп-слова в позициях не учитываются. Без позиций кавычки - обычные символы
+    bool store_positions = false;
+    // Проверка дубликатов при добавлении по отпечатку набора слов: время пропорционально
+    // размеру документа, а не корпуса
+    DuplicatePolicy duplicate_policy = DuplicatePolicy::KEEP;
+    // Кеш срезов списков документов частых слов по статусу для запросов со StatusPredicate
+    // (FindTopDocuments(query, status)). Срезы обновляются при добавлении и удалении документов,
+    // их память входит в MemoryUsage::caches и предел memory_limit
+    HotTermCacheOptions hot_terms;
+};
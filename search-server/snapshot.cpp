@@ -0,0 +1,163 @@
+#include "snapshot.h"
+
+#include <iterator>
+#include <string>
+#include <unordered_map>
+
+#include "binary_io.h"
+
+namespace {
+
+const std::string_view SNAPSHOT_MAGIC = "SRCHSNP1";
+// Запись в поток частями, чтобы не держать весь снимок в памяти
+const size_t SNAPSHOT_CHUNK_SIZE = size_t(1) << 20;
+
+void FlushChunk(std::string& buffer, std::ostream& output, uint32_t& crc) {
+    crc = ComputeCrc32(buffer, crc);
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+}  // namespace
+
+void WriteSnapshot(const SearchServer& server, std::ostream& output, uint64_t last_sequence) {
+    std::string buffer;
+    BinaryWriter writer(buffer);
+    uint32_t crc = 0;
+
+    buffer.append(SNAPSHOT_MAGIC);
+    writer.WriteUint64(last_sequence);
+    writer.WriteUint8(server.store_positions_ ? 1 : 0);
+    writer.WriteUint32(static_cast<uint32_t>(server.stop_words_.GetSize()));
+    for (const std::string& word : server.stop_words_) {
+        writer.WriteString(word);
+    }
+
+    // Документы ссылаются на слова по номеру в словаре; слова без документов не сохраняются
+    std::unordered_map<std::string_view, std::pair<uint32_t, const SearchServer::Postings*>> word_indices;
+    uint32_t word_count = 0;
+    for (const auto& [word, postings] : server.word_to_document_freqs_) {
+        word_count += postings.empty() ? 0 : 1;
+    }
+    writer.WriteUint32(word_count);
+    for (const auto& [word, postings] : server.word_to_document_freqs_) {
+        if (!postings.empty()) {
+            word_indices.emplace(word, std::pair(static_cast<uint32_t>(word_indices.size()), &postings));
+            writer.WriteString(word);
+        }
+        if (buffer.size() >= SNAPSHOT_CHUNK_SIZE) {
+            FlushChunk(buffer, output, crc);
+        }
+    }
+
+    writer.WriteUint32(static_cast<uint32_t>(server.documents_.size()));
+    for (const auto& [document_id, data] : server.documents_) {
+        const auto& word_freqs = server.document_to_word_freqs_.at(document_id);
+        writer.WriteInt32(document_id);
+        writer.WriteUint8(static_cast<uint8_t>(data.status));
+        writer.WriteInt32(data.rating);
+        writer.WriteUint32(data.word_count);
+        writer.WriteUint32(static_cast<uint32_t>(word_freqs.size()));
+        for (const auto& [word, term_freq] : word_freqs) {
+            const auto& [word_index, postings] = word_indices.at(word);
+            writer.WriteUint32(word_index);
+            writer.WriteUint32(postings->at(document_id));
+        }
+        if (server.store_positions_) {
+            const auto& positions = server.document_positions_.at(document_id);
+            writer.WriteUint32(static_cast<uint32_t>(positions.GetOffsets().size()));
+            for (const auto& [word, offset] : positions.GetOffsets()) {
+                writer.WriteUint32(word_indices.at(word).first);
+                writer.WriteUint32(offset);
+            }
+            writer.WriteString(positions.GetData());
+        }
+        if (buffer.size() >= SNAPSHOT_CHUNK_SIZE) {
+            FlushChunk(buffer, output, crc);
+        }
+    }
+    FlushChunk(buffer, output, crc);
+    writer.WriteUint32(crc);
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!output) {
+        throw std::runtime_error(std::string("Failed to write snapshot"));
+    }
+}
+
+SearchServer ReadSnapshot(std::istream& input, const SearchServerOptions& options, uint64_t* last_sequence) {
+    const std::string data(std::istreambuf_iterator<char>(input), {});
+    if (data.size() < SNAPSHOT_MAGIC.size() + sizeof(uint32_t)
+        || std::string_view(data).substr(0, SNAPSHOT_MAGIC.size()) != SNAPSHOT_MAGIC) {
+        throw std::runtime_error(std::string("Not a search server snapshot"));
+    }
+    const std::string_view body = std::string_view(data).substr(0, data.size() - sizeof(uint32_t));
+    if (BinaryReader(std::string_view(data).substr(body.size())).ReadUint32() != ComputeCrc32(body)) {
+        throw std::runtime_error(std::string("Snapshot checksum mismatch"));
+    }
+
+    BinaryReader reader(body.substr(SNAPSHOT_MAGIC.size()));
+    const uint64_t sequence = reader.ReadUint64();
+    const bool has_positions = reader.ReadUint8() != 0;
+    std::vector<std::string_view> stop_words(reader.ReadUint32());
+    for (std::string_view& word : stop_words) {
+        word = reader.ReadString();
+    }
+    SearchServer server(stop_words, options);
+
+    // Слова сразу заносятся в словарь, документы дальше ссылаются на готовые узлы
+    std::vector<SearchServer::Dictionary::iterator> words(reader.ReadUint32());
+    for (auto& word : words) {
+        word = server.FindOrAddWord(reader.ReadString());
+    }
+    const uint32_t document_count = reader.ReadUint32();
+    if (server.store_positions_ && !has_positions && document_count > 0) {
+        throw std::runtime_error(std::string("Snapshot has no word positions"));
+    }
+    std::vector<std::pair<SearchServer::Dictionary::iterator, uint32_t>> word_counts;
+    std::vector<std::pair<std::string_view, uint32_t>> position_offsets;
+    for (uint32_t i = 0; i < document_count; ++i) {
+        const int document_id = reader.ReadInt32();
+        const auto status = static_cast<DocumentStatus>(reader.ReadUint8());
+        const int rating = reader.ReadInt32();
+        const uint32_t word_count = reader.ReadUint32();
+        word_counts.resize(reader.ReadUint32());
+        for (size_t j = 0; j < word_counts.size(); ++j) {
+            const uint32_t word_index = reader.ReadUint32();
+            if (word_index >= words.size()) {
+                throw std::runtime_error(std::string("Snapshot refers to an unknown word"));
+            }
+            word_counts[j].first = words[word_index];
+            word_counts[j].second = reader.ReadUint32();
+        }
+        server.RestoreDocument(document_id, status, rating, word_count, word_counts);
+        if (has_positions) {
+            position_offsets.resize(reader.ReadUint32());
+            for (auto& [word, offset] : position_offsets) {
+                const uint32_t word_index = reader.ReadUint32();
+                if (word_index >= words.size()) {
+                    throw std::runtime_error(std::string("Snapshot refers to an unknown word"));
+                }
+                word = words[word_index]->first;
+                offset = reader.ReadUint32();
+            }
+            const std::string_view positions = reader.ReadString();
+            for (size_t j = 0; j < position_offsets.size(); ++j) {
+                if (position_offsets[j].second > positions.size()
+                    || (j > 0 && position_offsets[j].second < position_offsets[j - 1].second)) {
+                    throw std::runtime_error(std::string("Snapshot has invalid word positions"));
+                }
+            }
+            if (server.store_positions_) {
+                server.document_positions_.emplace_hint(server.document_positions_.end(), document_id,
+                    DocumentPositions(&server.memory_->positions))->second.Assign(position_offsets, positions);
+            }
+        }
+    }
+    if (!reader.IsEnd()) {
+        throw std::runtime_error(std::string("Unexpected data at the end of snapshot"));
+    }
+    if (last_sequence) {
+        *last_sequence = sequence;
+    }
+    return server;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+
+#include "search_server.h"
+
+// Снимок индекса: стоп-слова, словарь и для каждого документа рейтинг, статус, число слов, числа
+// вхождений слов и, если сервер их хранит, позиции слов.
+// Текст документов не хранится, поэтому восстановление из снимка не разбирает документы заново.
+// last_sequence - номер последней операции журнала, вошедшей в снимок (см. write_ahead_log.h)
+void WriteSnapshot(const SearchServer& server, std::ostream& output, uint64_t last_sequence = 0);
+
+// Бросает std::runtime_error, если снимок повреждён или имеет другой формат, а также если options
+// требуют позиций слов, а в снимке их нет
+SearchServer ReadSnapshot(std::istream& input, const SearchServerOptions& options = SearchServerOptions{},
+    uint64_t* last_sequence = nullptr);
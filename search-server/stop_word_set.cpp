@@ -0,0 +1,57 @@
+#include "stop_word_set.h"
+
+#include <algorithm>
+
+namespace {
+
+// Память строки вне самого объекта: короткие строки хранятся внутри него
+size_t GetStringHeapBytes(const std::string& str) {
+    const char* data = str.data();
+    const auto* object = reinterpret_cast<const char*>(&str);
+    const bool is_local = data >= object && data < object + sizeof(str);
+    return is_local ? 0 : str.capacity() + 1;
+}
+
+}  // namespace
+
+StopWordSet::StopWordSet() {
+    Build();
+}
+
+size_t StopWordSet::GetSize() const {
+    return words_.size();
+}
+
+std::vector<std::string>::const_iterator StopWordSet::begin() const {
+    return words_.begin();
+}
+
+std::vector<std::string>::const_iterator StopWordSet::end() const {
+    return words_.end();
+}
+
+size_t StopWordSet::GetMemoryUsage() const {
+    size_t bytes = words_.capacity() * sizeof(std::string)
+        + tables_.displacements.capacity() * sizeof(uint32_t)
+        + tables_.slot_words.capacity() * sizeof(uint32_t)
+        + tables_.fingerprints.capacity() * sizeof(uint64_t);
+    for (const std::string& word : words_) {
+        bytes += GetStringHeapBytes(word);
+    }
+    return bytes;
+}
+
+void StopWordSet::Build() {
+    std::sort(words_.begin(), words_.end());
+    words_.erase(std::unique(words_.begin(), words_.end()), words_.end());
+    words_.shrink_to_fit();
+
+    const size_t word_count = words_.size();
+    tables_.displacements.assign(perfect_hash::GetBucketCount(word_count), 0);
+    tables_.slot_words.assign(perfect_hash::GetSlotCount(word_count), 0);
+    tables_.fingerprints.assign(perfect_hash::GetSlotCount(word_count), 0);
+    std::vector<uint64_t> hashes(word_count);
+    std::vector<uint32_t> bucket_heads(tables_.displacements.size());
+    std::vector<uint32_t> next_in_bucket(word_count);
+    perfect_hash::Build(words_, word_count, tables_, hashes, bucket_heads, next_in_bucket);
+}
@@ -0,0 +1,237 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Совершенный хеш стоп-слов по схеме hash-and-displace. Слово хешируется один раз; перемешанный хеш
+// выбирают корзину, смещение корзины перемешивается с хешем и даёт единственную ячейку таблицы.
+// Проверка слова - одно чтение смещения и одной ячейки; строки сравниваются, только если совпал
+// 64-битный отпечаток, то есть практически лишь для настоящих стоп-слов.
+// Построение написано на constexpr-функциях и работает и с std::vector, и с std::array
+namespace perfect_hash {
+
+// Попыток подобрать смещение для корзины; при заполнении таблицы не выше половины хватает единиц
+constexpr uint32_t MAX_DISPLACEMENT = 1u << 20;
+
+// FNV-1a
+constexpr uint64_t HashWord(std::string_view word) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : word) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Финализатор splitmix64: у FNV-1a коротких слов плохо перемешаны старшие биты
+constexpr uint64_t Mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+constexpr uint64_t MixDisplacement(uint64_t hash, uint32_t displacement) {
+    return Mix(hash ^ ((displacement + 1) * 0x9E3779B97F4A7C15ull));
+}
+
+constexpr size_t GetBucketCount(size_t word_count) {
+    return word_count == 0 ? 1 : word_count;
+}
+
+// Степень двойки не меньше удвоенного числа слов
+constexpr size_t GetSlotCount(size_t word_count) {
+    size_t slot_count = 1;
+    while (slot_count < 2 * word_count) {
+        slot_count *= 2;
+    }
+    return slot_count;
+}
+
+constexpr size_t GetBucket(uint64_t hash, size_t bucket_count) {
+    return static_cast<size_t>(((Mix(hash) >> 32) * bucket_count) >> 32);
+}
+
+// Таблицы хеша над словами words[0..word_count). Ячейка хранит номер слова + 1 (0 - пусто)
+// и полный хеш слова как отпечаток
+template <typename Displacements, typename SlotWords, typename Fingerprints>
+struct Tables {
+    Displacements displacements{};
+    SlotWords slot_words{};
+    Fingerprints fingerprints{};
+};
+
+template <typename Words, typename Tables>
+constexpr bool Contains(const Words& words, const Tables& tables, std::string_view word) {
+    const uint64_t hash = HashWord(word);
+    const size_t bucket = GetBucket(hash, tables.displacements.size());
+    const size_t slot = MixDisplacement(hash, tables.displacements[bucket]) & (tables.slot_words.size() - 1);
+    return tables.fingerprints[slot] == hash && tables.slot_words[slot] != 0
+        && std::string_view(words[tables.slot_words[slot] - 1]) == word;
+}
+
+// Буферы уже имеют размеры: displacements - GetBucketCount, slot_words и fingerprints - GetSlotCount,
+// hashes, bucket_heads и next_in_bucket - по числу слов (bucket_heads - GetBucketCount).
+// Слова должны быть различными, иначе бросается std::invalid_argument
+template <typename Words, typename Tables, typename Hashes, typename Indices>
+constexpr void Build(const Words& words, size_t word_count, Tables& tables,
+    Hashes& hashes, Indices& bucket_heads, Indices& next_in_bucket) {
+    const size_t bucket_count = tables.displacements.size();
+    const size_t slot_mask = tables.slot_words.size() - 1;
+    size_t max_bucket_size = 0;
+    for (size_t i = 0; i < word_count; ++i) {
+        hashes[i] = HashWord(words[i]);
+        const size_t bucket = GetBucket(hashes[i], bucket_count);
+        next_in_bucket[i] = bucket_heads[bucket];
+        bucket_heads[bucket] = static_cast<uint32_t>(i + 1);
+        size_t bucket_size = 0;
+        for (uint32_t word = bucket_heads[bucket]; word != 0; word = next_in_bucket[word - 1]) {
+            ++bucket_size;
+        }
+        max_bucket_size = bucket_size > max_bucket_size ? bucket_size : max_bucket_size;
+    }
+    // Сначала размещаются большие корзины, пока таблица пуста
+    for (size_t size = max_bucket_size; size > 0; --size) {
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            size_t bucket_size = 0;
+            for (uint32_t word = bucket_heads[bucket]; word != 0; word = next_in_bucket[word - 1]) {
+                ++bucket_size;
+            }
+            if (bucket_size != size) {
+                continue;
+            }
+            bool placed = false;
+            for (uint32_t displacement = 0; !placed && displacement < MAX_DISPLACEMENT; ++displacement) {
+                placed = true;
+                uint32_t word = bucket_heads[bucket];
+                for (; word != 0; word = next_in_bucket[word - 1]) {
+                    const size_t slot = MixDisplacement(hashes[word - 1], displacement) & slot_mask;
+                    if (tables.slot_words[slot] != 0) {
+                        if (tables.fingerprints[slot] == hashes[word - 1]) {
+                            throw std::invalid_argument("Stop words must be unique and have distinct hashes");
+                        }
+                        placed = false;
+                        break;
+                    }
+                    tables.slot_words[slot] = word;
+                    tables.fingerprints[slot] = hashes[word - 1];
+                }
+                if (!placed) {
+                    // Откатываем слова корзины, уже занявшие ячейки
+                    for (uint32_t undo = bucket_heads[bucket]; undo != word; undo = next_in_bucket[undo - 1]) {
+                        const size_t slot = MixDisplacement(hashes[undo - 1], displacement) & slot_mask;
+                        tables.slot_words[slot] = 0;
+                        tables.fingerprints[slot] = 0;
+                    }
+                }
+                else {
+                    tables.displacements[bucket] = displacement;
+                }
+            }
+            if (!placed) {
+                throw std::invalid_argument("Cannot build perfect hash for stop words");
+            }
+        }
+    }
+}
+
+}  // namespace perfect_hash
+
+// Стоп-слова, известные при компиляции: таблица строится constexpr-конструктором.
+// Слова не должны повторяться и быть пустыми - иначе ошибка компиляции (или исключение вне constexpr)
+template <size_t N>
+class StaticStopWordSet {
+public:
+    static constexpr size_t BUCKET_COUNT = perfect_hash::GetBucketCount(N);
+    static constexpr size_t SLOT_COUNT = perfect_hash::GetSlotCount(N);
+    using Tables = perfect_hash::Tables<std::array<uint32_t, BUCKET_COUNT>, std::array<uint32_t, SLOT_COUNT>,
+        std::array<uint64_t, SLOT_COUNT>>;
+
+    constexpr explicit StaticStopWordSet(const std::array<std::string_view, N>& words)
+        : words_(words)
+    {
+        for (const std::string_view word : words_) {
+            if (word.empty()) {
+                throw std::invalid_argument("Stop words must not be empty");
+            }
+        }
+        std::array<uint64_t, N> hashes{};
+        std::array<uint32_t, BUCKET_COUNT> bucket_heads{};
+        std::array<uint32_t, N> next_in_bucket{};
+        perfect_hash::Build(words_, N, tables_, hashes, bucket_heads, next_in_bucket);
+    }
+
+    constexpr bool Contains(std::string_view word) const {
+        return perfect_hash::Contains(words_, tables_, word);
+    }
+
+    constexpr const std::array<std::string_view, N>& GetWords() const {
+        return words_;
+    }
+
+    constexpr const Tables& GetTables() const {
+        return tables_;
+    }
+
+private:
+    std::array<std::string_view, N> words_;
+    Tables tables_;
+};
+
+template <typename... Words>
+constexpr StaticStopWordSet<sizeof...(Words)> MakeStaticStopWordSet(Words... words) {
+    return StaticStopWordSet<sizeof...(Words)>(std::array<std::string_view, sizeof...(Words)>{ words... });
+}
+
+// Стоп-слова сервера. Пустые слова отбрасываются, повторы схлопываются
+class StopWordSet {
+public:
+    StopWordSet();
+
+    template <typename StringContainer>
+    explicit StopWordSet(const StringContainer& words);
+
+    // Готовые таблицы копируются без перестроения
+    template <size_t N>
+    explicit StopWordSet(const StaticStopWordSet<N>& words);
+
+    bool Contains(std::string_view word) const {
+        return perfect_hash::Contains(words_, tables_, word);
+    }
+
+    size_t GetSize() const;
+    std::vector<std::string>::const_iterator begin() const;
+    std::vector<std::string>::const_iterator end() const;
+
+    // Байты таблиц и слов
+    size_t GetMemoryUsage() const;
+
+private:
+    using Tables = perfect_hash::Tables<std::vector<uint32_t>, std::vector<uint32_t>, std::vector<uint64_t>>;
+
+    void Build();
+
+    std::vector<std::string> words_;
+    Tables tables_;
+};
+
+template <typename StringContainer>
+StopWordSet::StopWordSet(const StringContainer& words) {
+    for (const std::string_view word : words) {
+        if (!word.empty()) {
+            words_.emplace_back(word);
+        }
+    }
+    Build();
+}
+
+template <size_t N>
+StopWordSet::StopWordSet(const StaticStopWordSet<N>& words)
+    : words_(words.GetWords().begin(), words.GetWords().end())
+{
+    const auto& tables = words.GetTables();
+    tables_.displacements.assign(tables.displacements.begin(), tables.displacements.end());
+    tables_.slot_words.assign(tables.slot_words.begin(), tables.slot_words.end());
+    tables_.fingerprints.assign(tables.fingerprints.begin(), tables.fingerprints.end());
+}
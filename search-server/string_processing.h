@@ -1,19 +1,19 @@
-#pragma once
-#include <vector>
-#include <string>
-#include <set>
-#include <string_view>
-
-std::vector<std::string_view>  SplitIntoWords(std::string_view str);
-
-
-template <typename StringContainer>
-std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
-    std::set<std::string, std::less<>> non_empty_strings;
-    for (const std::string_view& str : strings) {
-        if (!str.empty()){
-            non_empty_strings.insert(std::string(str));
-        }
-    }
-    return non_empty_strings;
+#pragma once
+#include <vector>
+#include <string>
+#include <set>
+#include <string_view>
+
+std::vector<std::string_view>  SplitIntoWords(std::string_view str);
+
+
+template <typename StringContainer>
+std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_strings;
+    for (const std::string_view& str : strings) {
+        if (!str.empty()){
+            non_empty_strings.insert(std::string(str));
+        }
+    }
+    return non_empty_strings;
 }
\ No newline at end of file
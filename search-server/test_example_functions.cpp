@@ -1,412 +1,2307 @@
-#include <numeric>
-#include <utility>
-#include <map>
-#include <set>
-#include <string>
-#include <string_view>
-#include <iostream>
-#include <cmath>
-#include "test_example_functions.h"
-#include "search_server.h"
-
-
-template <typename Key, typename Value>
-std::ostream& operator<<(std::ostream& out, const std::pair<Key, Value>& container) {
-    out << container.first << std::string(": ") << container.second;
-    return out;
-}
-
-
-template <typename Container>
-void Print(std::ostream& out, const Container& container) {
-    bool first_elem = true;
-    for (const auto& element : container) {
-        if (!first_elem) {
-            out << std::string(", ");
-        }
-        first_elem = false;
-        out << element;
-    }
-}
-
-template <typename Key, typename Value>
-std::ostream& operator<<(std::ostream& out, const std::map<Key, Value>& container) {
-    out << '{';
-    Print(out, container);
-    out << '}';
-    return out;
-}
-
-
-template <typename Element>
-std::ostream& operator<<(std::ostream& out, const std::set<Element>& container) {
-    out << '{';
-    Print(out, container);
-    out << '}';
-    return out;
-}
-
-template <typename Element>
-std::ostream& operator<<(std::ostream& out, const std::vector<Element>& container) {
-    out << '[';
-    Print(out, container);
-    out << ']';
-    return out;
-}
-
-template <typename T, typename U>
-void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
-    const std::string& func, unsigned line, const std::string& hint) {
-    if (t != u) {
-        std::cerr << std::boolalpha;
-        std::cerr << file << '(' << line << std::string(") : ") << func << std::string(" : ");
-        std::cerr << std::string("ASSERT_EQUAL(") << t_str << std::string(", ") << u_str << std::string(") failed: ");
-        std::cerr << t << " != " << u << ".";
-        if (!hint.empty()) {
-            std::cerr << std::string(" Hint: ") << hint;
-        }
-        std::cerr << std::endl;
-        abort();
-    }
-}
-
-#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, "")
-
-#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
-
-void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line,
-    const std::string& hint) {
-    if (!value) {
-        std::cerr << file << '(' << line << std::string(") : ") << func << std::string(" : ");
-        std::cerr << std::string("ASSERT(") << expr_str << std::string(") failed.");
-        if (!hint.empty()) {
-            std::cerr << std::string(" Hint: ") << hint;
-        }
-        std::cerr << std::endl;
-        abort();
-    }
-}
-
-#define ASSERT(expr) AssertImpl((expr), #expr, __FILE__, __FUNCTION__, __LINE__, "")
-
-#define ASSERT_HINT(expr, hint) AssertImpl((expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
-
-// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
-void TestExcludeStopWordsFromAddedDocumentContent() {
-    const int doc_id = 42;
-    const std::string content = std::string("cat in the city");
-    const std::vector<int> ratings = { 1, 2, 3 };
-
-    // Сначала проверим, что поиск не существующего документа вернет пустоту 
-    {
-        SearchServer server;
-        ASSERT(server.FindTopDocuments(std::string("in")).empty());
-    }
-
-    // Сначала убеждаемся, что поиск слова, не входящего в список стоп-слов,
-    // находит нужный документ
-    {
-        SearchServer server;
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        const auto found_docs = server.FindTopDocuments(std::string("in"));
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc0 = found_docs[0];
-        ASSERT_EQUAL(doc0.id, doc_id);
-    }
-
-    // Затем убеждаемся, что поиск этого же слова, входящего в список стоп-слов,
-    // возвращает пустой результат
-    {
-        SearchServer server(std::string("in the"));
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        ASSERT(server.FindTopDocuments(std::string("in")).empty());
-    }
-}
-
-// Тест проверяет, что поисковая система исключает минус-слова из поискового запроса
-void TestExcludeMinusWordsFromQuery() {
-    const int doc_id = 42;
-    const std::string content = std::string("cat in the city");
-    const std::vector<int> ratings = { 1, 2, 3 };
-    // Сначала убедимся, что слова не являющиеся минус-словами, находят нужный документ
-    {
-        SearchServer server;
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        const auto found_docs = server.FindTopDocuments(std::string("in"));
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc0 = found_docs[0];
-        ASSERT_EQUAL(doc0.id, doc_id);
-    }
-    // Затем убедимся, что поиск по минус-слову возвращает пустоту 
-    {
-        SearchServer server;
-        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-        ASSERT(server.FindTopDocuments(std::string("-in the")).empty());
-    }
-}
-
- //Тест на проверку сопоставления содержимого документа и поискового запроса
-
-void TestMatchDocuments() {
-
-    const int doc_id = 42;
-    const std::string content = std::string("cat in the city");
-    const std::vector <std::string_view> content_match_word = { std::string_view("cat"), std::string_view("in"), std::string_view("the") };
-    const std::vector<int> ratings = { 1, 2, 3 };
-
-    SearchServer server;
-    server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
-
-    // убедимся,что слова из поискового запроса вернулись
-    {
-        const auto [matched_words, status] = server.MatchDocument(std::string("in the cat"), doc_id);
-        ASSERT_EQUAL(matched_words, content_match_word);
-    }
-
-    // убедимся, что присутствие минус-слова возвращает пустой вектор
-    {
-        const auto [matched_words, status] = server.MatchDocument(std::string("in -the cat"), doc_id);
-        ASSERT(matched_words.empty());
-    }
-
-}
-
-
-// Тест на сортировку по релевантности найденых документов
-void TestSortingByRelevance() {
-    const int doc_id1 = 1; // relev = 0.650672
-    const int doc_id2 = 2; // relev = 0.067577
-    const int doc_id3 = 3; // relev = 0.135155
-    const std::string content_1 = std::string("cat in the city");
-    const std::vector<int> ratings_1 = { -1, 2, 2 };
-    const std::string content_2 = std::string("black dog was on 3rd avenue");
-    const std::vector<int> ratings_2 = {};
-    const std::string content_3 = std::string("black cat was in a park");
-    const std::vector<int> ratings_3 = { 2, 3, 4 };
-
-    SearchServer server;
-    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
-    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
-    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
-
-    // убедимся,что документы найдены
-    const auto found_docs = server.FindTopDocuments(std::string("black cat the city"));
-    ASSERT_EQUAL(found_docs.size(), 3);
-
-    const Document& doc1 = found_docs[0];
-    const Document& doc2 = found_docs[1];
-    const Document& doc3 = found_docs[2];
-
-    // проверим сортировку по релевантности
-    ASSERT_EQUAL(doc1.id, doc_id1);
-    ASSERT_EQUAL(doc2.id, doc_id3);
-    ASSERT_EQUAL(doc3.id, doc_id2);
-
-}
-// Тест на правильность вычесления релевантности
-void TestCalculatingRelevance() {
-    const double epx = 1e-6; //+-0.000001
-    const int doc_id1 = 1; // relev = 0.650672
-    const int doc_id2 = 2; // relev = 0.135155
-    const int doc_id3 = 3; // relev = 0.067577
-    const std::string content_1 = std::string("cat in the city");
-    const std::vector<int> ratings_1 = { -1, 2, 2 };
-    const std::string content_2 = std::string("black dog was on 3rd avenue");
-    const std::vector<int> ratings_2 = {};
-    const std::string content_3 = std::string("black cat was in a park");
-    const std::vector<int> ratings_3 = { 2, 3, 4 };
-
-    SearchServer server;
-    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
-    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
-    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
-
-    // убедимся,что документы найдены
-    const auto found_docs = server.FindTopDocuments(std::string("black cat the city"));
-    ASSERT_EQUAL(found_docs.size(), 3);
-
-    const Document& doc1 = found_docs[0];
-    const Document& doc2 = found_docs[1];
-    const Document& doc3 = found_docs[2];
-
-
-
-    // проверим расчет релевантности
-    double relevance_doc1 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 4) +
-        log(server.GetDocumentCount() * 1.0 / 1) * (1.0 / 4) +
-        log(server.GetDocumentCount() * 1.0 / 1) * (1.0 / 4); // слова cat, the и city
-    ASSERT(std::abs(doc1.relevance - relevance_doc1) < epx);
-    double relevance_doc3 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6) +
-        log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6); // слова black и cat
-    ASSERT(std::abs(doc2.relevance - relevance_doc3) < epx);
-    double relevance_doc2 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6); // слово black
-    ASSERT(std::abs(doc3.relevance - relevance_doc2) < epx);
-}
-
-/// <summary>
-/// вычисление среднего ариметического оценок докумета
-/// </summary>
-/// <param name="rating"> вектор оценок</param>
-/// <returns>среднего ариметического оценок докумета</returns>
-int ArithmeticMeanOfTheRating(std::vector<int> rating) {
-    if (rating.size() == 0) {
-        return 0;
-    }
-    return std::accumulate(rating.begin(), rating.end(), 0) / static_cast<int>(rating.size());
-}
-
-// Тест на правильность вычесления рейтинга 
-void TestCalculatingRating() {
-    const int doc_id1 = 1;
-    const int doc_id2 = 2;
-    const int doc_id3 = 3;
-    const std::string content_1 = std::string("cat in the city");
-    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
-    const std::string content_2 = std::string("black dog was on 3rd avenue");
-    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
-    const std::string content_3 = std::string("black cat was in a park");
-    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
-
-    SearchServer server;
-    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
-    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
-    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
-
-    // проверим рейтинг
-    const auto found_docs1 = server.FindTopDocuments(std::string("city"));
-    ASSERT_EQUAL(found_docs1.size(), 1);
-    const Document& doc1 = found_docs1[0];
-    ASSERT_EQUAL(doc1.rating, ArithmeticMeanOfTheRating(ratings_1));
-
-    const auto found_docs2 = server.FindTopDocuments(std::string("dog"));
-    ASSERT_EQUAL(found_docs2.size(), 1);
-    const Document& doc2 = found_docs2[0];
-    ASSERT_EQUAL(doc2.rating, ArithmeticMeanOfTheRating(ratings_2));
-
-    const auto found_docs3 = server.FindTopDocuments(std::string("park"));
-    ASSERT_EQUAL(found_docs3.size(), 1);
-    const Document& doc3 = found_docs3[0];
-    ASSERT_EQUAL(doc3.rating, ArithmeticMeanOfTheRating(ratings_3));
-}
-
-// Тест на фильтрацию результата с использованием предиката
-void TestFilterByPredicate() {
-    const int doc_id1 = 1;
-    const int doc_id2 = 2;
-    const int doc_id3 = 3;
-    const int doc_id4 = 5;
-    const std::string content_1 = std::string("cat in the city");
-    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
-    const std::string content_2 = std::string("black dog was on 3rd avenue");
-    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
-    const std::string content_3 = std::string("black cat was in a park");
-    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
-    const std::string content_4 = std::string("a white cat in a dark alley");
-    const std::vector<int> ratings_4 = { 1, 2, 3 }; // rating 3 relev = 0.067577
-
-    SearchServer server;
-    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
-    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
-    server.AddDocument(doc_id3, content_3, DocumentStatus::BANNED, ratings_3);
-    server.AddDocument(doc_id4, content_4, DocumentStatus::IRRELEVANT, ratings_4);
-
-    // веренем документы с четным ИД
-    {
-        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
-            [](int document_id, DocumentStatus status, int rating)
-            {
-                return document_id % 2 == 0;
-            });
-
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc1 = found_docs[0];
-        ASSERT_EQUAL(doc1.id, doc_id2);
-
-    }
-
-    // вернем документы с рейтингом и определённым статусом
-    {
-        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
-            [](int document_id, DocumentStatus status, int rating)
-            {
-                return status == DocumentStatus::ACTUAL and rating > 0;
-            });
-
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc1 = found_docs[0];
-        ASSERT_EQUAL(doc1.id, doc_id1);
-
-    }
-}
-
-// Тест на фильтрацию результата с использованием статуса
-void TestFilterByStatus() {
-    const int doc_id1 = 1;
-    const int doc_id2 = 2;
-    const int doc_id3 = 3;
-    const int doc_id4 = 4;
-    const std::string content_1 = std::string("cat in the city");
-    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
-    const std::string content_2 = std::string("black dog was on 3rd avenue");
-    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
-    const std::string content_3 = std::string("black cat was in a park");
-    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
-    const std::string content_4 = std::string("a white cat in a dark alley");
-    const std::vector<int> ratings_4 = { 1, 2, 3 }; // rating 3 relev = 0.067577
-
-    SearchServer server;
-    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
-    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
-    server.AddDocument(doc_id3, content_3, DocumentStatus::BANNED, ratings_3);
-    server.AddDocument(doc_id4, content_4, DocumentStatus::IRRELEVANT, ratings_4);
-
-    // вернем документы с статусом ACTUAL
-    {
-        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
-            DocumentStatus::ACTUAL);
-
-        ASSERT_EQUAL(found_docs.size(), 2);
-        const Document& doc1 = found_docs[0];
-        const Document& doc2 = found_docs[1];
-        ASSERT_EQUAL(doc1.id, doc_id1);
-        ASSERT_EQUAL(doc2.id, doc_id2);
-
-    }
-
-    // вернем документы с статусом BANNED
-    {
-        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
-            DocumentStatus::BANNED);
-
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc1 = found_docs[0];
-        ASSERT_EQUAL(doc1.id, doc_id3);
-
-    }
-
-    // вернем документы с статусом IRRELEVANT
-    {
-        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
-            DocumentStatus::IRRELEVANT);
-
-        ASSERT_EQUAL(found_docs.size(), 1);
-        const Document& doc1 = found_docs[0];
-        ASSERT_EQUAL(doc1.id, doc_id4);
-
-    }
-
-}
-
-
-
-// Функция TestSearchServer является точкой входа для запуска тестов
-void TestSearchServer() {
-    TestExcludeStopWordsFromAddedDocumentContent();
-    TestExcludeMinusWordsFromQuery();
-    TestMatchDocuments();
-    TestSortingByRelevance();
-    TestCalculatingRelevance();
-    TestCalculatingRating();
-    TestFilterByPredicate();
-    TestFilterByStatus();
+#include <numeric>
+#include <utility>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <thread>
+#include "test_example_functions.h"
+#include "search_server.h"
+#include "persistent_search_server.h"
+#include "binary_io.h"
+#include "concurrent_map.h"
+#include "corpus_loader.h"
+#include "near_duplicates.h"
+#include "numa_search_server.h"
+#include "daemon/query_client.h"
+#include "daemon/query_daemon.h"
+
+
+template <typename Key, typename Value>
+std::ostream& operator<<(std::ostream& out, const std::pair<Key, Value>& container) {
+    out << container.first << std::string(": ") << container.second;
+    return out;
+}
+
+
+template <typename Container>
+void Print(std::ostream& out, const Container& container) {
+    bool first_elem = true;
+    for (const auto& element : container) {
+        if (!first_elem) {
+            out << std::string(", ");
+        }
+        first_elem = false;
+        out << element;
+    }
+}
+
+template <typename Key, typename Value>
+std::ostream& operator<<(std::ostream& out, const std::map<Key, Value>& container) {
+    out << '{';
+    Print(out, container);
+    out << '}';
+    return out;
+}
+
+
+template <typename Element>
+std::ostream& operator<<(std::ostream& out, const std::set<Element>& container) {
+    out << '{';
+    Print(out, container);
+    out << '}';
+    return out;
+}
+
+template <typename Element>
+std::ostream& operator<<(std::ostream& out, const std::vector<Element>& container) {
+    out << '[';
+    Print(out, container);
+    out << ']';
+    return out;
+}
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str, const std::string& file,
+    const std::string& func, unsigned line, const std::string& hint) {
+    if (t != u) {
+        std::cerr << std::boolalpha;
+        std::cerr << file << '(' << line << std::string(") : ") << func << std::string(" : ");
+        std::cerr << std::string("ASSERT_EQUAL(") << t_str << std::string(", ") << u_str << std::string(") failed: ");
+        std::cerr << t << " != " << u << ".";
+        if (!hint.empty()) {
+            std::cerr << std::string(" Hint: ") << hint;
+        }
+        std::cerr << std::endl;
+        abort();
+    }
+}
+
+#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, "")
+
+#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func, unsigned line,
+    const std::string& hint) {
+    if (!value) {
+        std::cerr << file << '(' << line << std::string(") : ") << func << std::string(" : ");
+        std::cerr << std::string("ASSERT(") << expr_str << std::string(") failed.");
+        if (!hint.empty()) {
+            std::cerr << std::string(" Hint: ") << hint;
+        }
+        std::cerr << std::endl;
+        abort();
+    }
+}
+
+#define ASSERT(expr) AssertImpl((expr), #expr, __FILE__, __FUNCTION__, __LINE__, "")
+
+#define ASSERT_HINT(expr, hint) AssertImpl((expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
+void TestExcludeStopWordsFromAddedDocumentContent() {
+    const int doc_id = 42;
+    const std::string content = std::string("cat in the city");
+    const std::vector<int> ratings = { 1, 2, 3 };
+
+    // Сначала проверим, что поиск не существующего документа вернет пустоту 
+    {
+        SearchServer server;
+        ASSERT(server.FindTopDocuments(std::string("in")).empty());
+    }
+
+    // Сначала убеждаемся, что поиск слова, не входящего в список стоп-слов,
+    // находит нужный документ
+    {
+        SearchServer server;
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        const auto found_docs = server.FindTopDocuments(std::string("in"));
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc0 = found_docs[0];
+        ASSERT_EQUAL(doc0.id, doc_id);
+    }
+
+    // Затем убеждаемся, что поиск этого же слова, входящего в список стоп-слов,
+    // возвращает пустой результат
+    {
+        SearchServer server(std::string("in the"));
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        ASSERT(server.FindTopDocuments(std::string("in")).empty());
+    }
+}
+
+// Тест проверяет, что поисковая система исключает минус-слова из поискового запроса
+void TestExcludeMinusWordsFromQuery() {
+    const int doc_id = 42;
+    const std::string content = std::string("cat in the city");
+    const std::vector<int> ratings = { 1, 2, 3 };
+    // Сначала убедимся, что слова не являющиеся минус-словами, находят нужный документ
+    {
+        SearchServer server;
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        const auto found_docs = server.FindTopDocuments(std::string("in"));
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc0 = found_docs[0];
+        ASSERT_EQUAL(doc0.id, doc_id);
+    }
+    // Затем убедимся, что поиск по минус-слову возвращает пустоту 
+    {
+        SearchServer server;
+        server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+        ASSERT(server.FindTopDocuments(std::string("-in the")).empty());
+    }
+}
+
+ //Тест на проверку сопоставления содержимого документа и поискового запроса
+
+void TestMatchDocuments() {
+
+    const int doc_id = 42;
+    const std::string content = std::string("cat in the city");
+    const std::vector <std::string_view> content_match_word = { std::string_view("cat"), std::string_view("in"), std::string_view("the") };
+    const std::vector<int> ratings = { 1, 2, 3 };
+
+    SearchServer server;
+    server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
+
+    // убедимся,что слова из поискового запроса вернулись
+    {
+        const std::string query = std::string("in the cat");
+        const auto [matched_words, status] = server.MatchDocument(query, doc_id);
+        ASSERT_EQUAL(matched_words, content_match_word);
+    }
+
+    // убедимся, что присутствие минус-слова возвращает пустой вектор
+    {
+        const std::string query = std::string("in -the cat");
+        const auto [matched_words, status] = server.MatchDocument(query, doc_id);
+        ASSERT(matched_words.empty());
+    }
+
+}
+
+
+// Тест на сортировку по релевантности найденых документов
+void TestSortingByRelevance() {
+    const int doc_id1 = 1; // relev = 0.650672
+    const int doc_id2 = 2; // relev = 0.067577
+    const int doc_id3 = 3; // relev = 0.135155
+    const std::string content_1 = std::string("cat in the city");
+    const std::vector<int> ratings_1 = { -1, 2, 2 };
+    const std::string content_2 = std::string("black dog was on 3rd avenue");
+    const std::vector<int> ratings_2 = {};
+    const std::string content_3 = std::string("black cat was in a park");
+    const std::vector<int> ratings_3 = { 2, 3, 4 };
+
+    SearchServer server;
+    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
+    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
+    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
+
+    // убедимся,что документы найдены
+    const auto found_docs = server.FindTopDocuments(std::string("black cat the city"));
+    ASSERT_EQUAL(found_docs.size(), 3);
+
+    const Document& doc1 = found_docs[0];
+    const Document& doc2 = found_docs[1];
+    const Document& doc3 = found_docs[2];
+
+    // проверим сортировку по релевантности
+    ASSERT_EQUAL(doc1.id, doc_id1);
+    ASSERT_EQUAL(doc2.id, doc_id3);
+    ASSERT_EQUAL(doc3.id, doc_id2);
+
+}
+// Тест на правильность вычесления релевантности
+void TestCalculatingRelevance() {
+    const double epx = 1e-6; //+-0.000001
+    const int doc_id1 = 1; // relev = 0.650672
+    const int doc_id2 = 2; // relev = 0.135155
+    const int doc_id3 = 3; // relev = 0.067577
+    const std::string content_1 = std::string("cat in the city");
+    const std::vector<int> ratings_1 = { -1, 2, 2 };
+    const std::string content_2 = std::string("black dog was on 3rd avenue");
+    const std::vector<int> ratings_2 = {};
+    const std::string content_3 = std::string("black cat was in a park");
+    const std::vector<int> ratings_3 = { 2, 3, 4 };
+
+    SearchServer server;
+    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
+    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
+    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
+
+    // убедимся,что документы найдены
+    const auto found_docs = server.FindTopDocuments(std::string("black cat the city"));
+    ASSERT_EQUAL(found_docs.size(), 3);
+
+    const Document& doc1 = found_docs[0];
+    const Document& doc2 = found_docs[1];
+    const Document& doc3 = found_docs[2];
+
+
+
+    // проверим расчет релевантности
+    double relevance_doc1 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 4) +
+        log(server.GetDocumentCount() * 1.0 / 1) * (1.0 / 4) +
+        log(server.GetDocumentCount() * 1.0 / 1) * (1.0 / 4); // слова cat, the и city
+    ASSERT(std::abs(doc1.relevance - relevance_doc1) < epx);
+    double relevance_doc3 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6) +
+        log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6); // слова black и cat
+    ASSERT(std::abs(doc2.relevance - relevance_doc3) < epx);
+    double relevance_doc2 = log(server.GetDocumentCount() * 1.0 / 2) * (1.0 / 6); // слово black
+    ASSERT(std::abs(doc3.relevance - relevance_doc2) < epx);
+}
+
+/// <summary>
+/// вычисление среднего ариметического оценок докумета
+/// </summary>
+/// <param name="rating"> вектор оценок</param>
+/// <returns>среднего ариметического оценок докумета</returns>
+int ArithmeticMeanOfTheRating(std::vector<int> rating) {
+    if (rating.size() == 0) {
+        return 0;
+    }
+    return std::accumulate(rating.begin(), rating.end(), 0) / static_cast<int>(rating.size());
+}
+
+// Тест на правильность вычесления рейтинга 
+void TestCalculatingRating() {
+    const int doc_id1 = 1;
+    const int doc_id2 = 2;
+    const int doc_id3 = 3;
+    const std::string content_1 = std::string("cat in the city");
+    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
+    const std::string content_2 = std::string("black dog was on 3rd avenue");
+    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
+    const std::string content_3 = std::string("black cat was in a park");
+    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
+
+    SearchServer server;
+    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
+    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
+    server.AddDocument(doc_id3, content_3, DocumentStatus::ACTUAL, ratings_3);
+
+    // проверим рейтинг
+    const auto found_docs1 = server.FindTopDocuments(std::string("city"));
+    ASSERT_EQUAL(found_docs1.size(), 1);
+    const Document& doc1 = found_docs1[0];
+    ASSERT_EQUAL(doc1.rating, ArithmeticMeanOfTheRating(ratings_1));
+
+    const auto found_docs2 = server.FindTopDocuments(std::string("dog"));
+    ASSERT_EQUAL(found_docs2.size(), 1);
+    const Document& doc2 = found_docs2[0];
+    ASSERT_EQUAL(doc2.rating, ArithmeticMeanOfTheRating(ratings_2));
+
+    const auto found_docs3 = server.FindTopDocuments(std::string("park"));
+    ASSERT_EQUAL(found_docs3.size(), 1);
+    const Document& doc3 = found_docs3[0];
+    ASSERT_EQUAL(doc3.rating, ArithmeticMeanOfTheRating(ratings_3));
+}
+
+// Тест на фильтрацию результата с использованием предиката
+void TestFilterByPredicate() {
+    const int doc_id1 = 1;
+    const int doc_id2 = 2;
+    const int doc_id3 = 3;
+    const int doc_id4 = 5;
+    const std::string content_1 = std::string("cat in the city");
+    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
+    const std::string content_2 = std::string("black dog was on 3rd avenue");
+    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
+    const std::string content_3 = std::string("black cat was in a park");
+    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
+    const std::string content_4 = std::string("a white cat in a dark alley");
+    const std::vector<int> ratings_4 = { 1, 2, 3 }; // rating 3 relev = 0.067577
+
+    SearchServer server;
+    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
+    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
+    server.AddDocument(doc_id3, content_3, DocumentStatus::BANNED, ratings_3);
+    server.AddDocument(doc_id4, content_4, DocumentStatus::IRRELEVANT, ratings_4);
+
+    // веренем документы с четным ИД
+    {
+        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
+            [](int document_id, DocumentStatus status, int rating)
+            {
+                return document_id % 2 == 0;
+            });
+
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc1 = found_docs[0];
+        ASSERT_EQUAL(doc1.id, doc_id2);
+
+    }
+
+    // вернем документы с рейтингом и определённым статусом
+    {
+        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
+            [](int document_id, DocumentStatus status, int rating)
+            {
+                return status == DocumentStatus::ACTUAL and rating > 0;
+            });
+
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc1 = found_docs[0];
+        ASSERT_EQUAL(doc1.id, doc_id1);
+
+    }
+}
+
+// Тест на фильтрацию результата с использованием статуса
+void TestFilterByStatus() {
+    const int doc_id1 = 1;
+    const int doc_id2 = 2;
+    const int doc_id3 = 3;
+    const int doc_id4 = 4;
+    const std::string content_1 = std::string("cat in the city");
+    const std::vector<int> ratings_1 = { -1, 2, 2 }; // rating 1 relev = 0.650672
+    const std::string content_2 = std::string("black dog was on 3rd avenue");
+    const std::vector<int> ratings_2 = {}; // rating 2 relev = 0.135155
+    const std::string content_3 = std::string("black cat was in a park");
+    const std::vector<int> ratings_3 = { 2, 3, 4 }; // rating 3 relev = 0.067577
+    const std::string content_4 = std::string("a white cat in a dark alley");
+    const std::vector<int> ratings_4 = { 1, 2, 3 }; // rating 3 relev = 0.067577
+
+    SearchServer server;
+    server.AddDocument(doc_id1, content_1, DocumentStatus::ACTUAL, ratings_1);
+    server.AddDocument(doc_id2, content_2, DocumentStatus::ACTUAL, ratings_2);
+    server.AddDocument(doc_id3, content_3, DocumentStatus::BANNED, ratings_3);
+    server.AddDocument(doc_id4, content_4, DocumentStatus::IRRELEVANT, ratings_4);
+
+    // вернем документы с статусом ACTUAL
+    {
+        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
+            DocumentStatus::ACTUAL);
+
+        ASSERT_EQUAL(found_docs.size(), 2);
+        const Document& doc1 = found_docs[0];
+        const Document& doc2 = found_docs[1];
+        ASSERT_EQUAL(doc1.id, doc_id1);
+        ASSERT_EQUAL(doc2.id, doc_id2);
+
+    }
+
+    // вернем документы с статусом BANNED
+    {
+        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
+            DocumentStatus::BANNED);
+
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc1 = found_docs[0];
+        ASSERT_EQUAL(doc1.id, doc_id3);
+
+    }
+
+    // вернем документы с статусом IRRELEVANT
+    {
+        const auto found_docs = server.FindTopDocuments(std::string("black cat the city"),
+            DocumentStatus::IRRELEVANT);
+
+        ASSERT_EQUAL(found_docs.size(), 1);
+        const Document& doc1 = found_docs[0];
+        ASSERT_EQUAL(doc1.id, doc_id4);
+
+    }
+
+}
+
+
+// Тест асинхронного поиска на пуле потоков сервера
+void TestFindTopDocumentsAsync() {
+    SearchServer server(std::string("and with"));
+    server.AddDocument(1, std::string("white cat and yellow hat"), DocumentStatus::ACTUAL, { 1, 2 });
+    server.AddDocument(2, std::string("curly cat curly tail"), DocumentStatus::ACTUAL, { 1, 2 });
+    server.AddDocument(3, std::string("nasty dog with big eyes"), DocumentStatus::BANNED, { 1, 2 });
+
+    // без настроенного пула асинхронный поиск недоступен
+    {
+        bool thrown = false;
+        try {
+            server.FindTopDocumentsAsync(std::string("cat"));
+        }
+        catch (const std::logic_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+
+    server.ConfigureExecutor({ 2, 16, {} });
+
+    // результаты совпадают с синхронным поиском
+    {
+        auto actual = server.FindTopDocumentsAsync(std::string("curly cat"));
+        auto banned = server.FindTopDocumentsAsync(std::string("dog"), DocumentStatus::BANNED);
+        const auto expected = server.FindTopDocuments(std::string("curly cat"));
+        const auto found_docs = actual.get();
+        ASSERT_EQUAL(found_docs.size(), expected.size());
+        for (size_t i = 0; i < found_docs.size(); ++i) {
+            ASSERT_EQUAL(found_docs[i].id, expected[i].id);
+        }
+        const auto banned_docs = banned.get();
+        ASSERT_EQUAL(banned_docs.size(), 1);
+        ASSERT_EQUAL(banned_docs[0].id, 3);
+    }
+
+    // замена пула во время запросов: задачи прежнего пула дорабатываются, новые идут в новый пул
+    {
+        // очередь без предела: иначе отправитель может переполнить её раньше первой замены
+        server.ConfigureExecutor({ 2, 0, {} });
+        std::vector<std::future<std::vector<Document>>> pending;
+        std::atomic<bool> submitting = true;
+        std::thread submitter([&server, &pending, &submitting]() {
+            for (int i = 0; i < 200; ++i) {
+                pending.push_back(server.FindTopDocumentsAsync(std::string("cat")));
+            }
+            submitting = false;
+        });
+        while (submitting) {
+            server.ConfigureExecutor({ 2, 0, {} });
+        }
+        submitter.join();
+        for (auto& future : pending) {
+            ASSERT_EQUAL(future.get().size(), 2u);
+        }
+    }
+
+    // переполнение очереди приводит к отказу
+    {
+        SearchExecutor executor({ 1, 1, {} });
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        std::promise<void> started;
+        auto started_future = started.get_future();
+        auto blocker = executor.Submit([&started, released]() { started.set_value(); released.wait(); });
+        started_future.wait();
+        auto queued = executor.Submit([]() { return 1; });
+        bool thrown = false;
+        try {
+            executor.Submit([]() { return 2; });
+        }
+        catch (const std::overflow_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+        ASSERT_EQUAL(executor.GetRejectedCount(), 1);
+        release.set_value();
+        ASSERT_EQUAL(queued.get(), 1);
+    }
+}
+// Тест на прерывание поиска по исчерпанию бюджета запроса
+void TestQueryBudget() {
+    SearchServer server;
+    for (int id = 0; id < 500; ++id) {
+        server.AddDocument(id, std::string("cat number ") + std::to_string(id), DocumentStatus::ACTUAL, { id });
+    }
+
+    const auto actual = [](int document_id, DocumentStatus status, int rating) {
+        return status == DocumentStatus::ACTUAL;
+    };
+
+    // без ограничений результат полный и совпадает с обычным поиском
+    {
+        const auto result = server.FindTopDocuments(std::string("cat"), actual, QueryBudget{});
+        ASSERT(!result.truncated);
+        const auto expected = server.FindTopDocuments(std::string("cat"));
+        ASSERT_EQUAL(result.documents.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL(result.documents[i].id, expected[i].id);
+        }
+    }
+
+    // бюджет по числу записей индекса обрывает обход, но лучшие из просмотренных возвращаются
+    {
+        QueryBudget budget;
+        budget.max_postings = 100;
+        const auto result = server.FindTopDocuments(std::execution::par, std::string("cat"), actual, budget);
+        ASSERT(result.truncated);
+        ASSERT_EQUAL(result.documents.size(), MAX_RESULT_DOCUMENT_COUNT);
+    }
+
+    // истёкший срок выполнения
+    {
+        QueryBudget budget;
+        budget.max_time = std::chrono::steady_clock::duration::zero();
+        const auto result = server.FindTopDocuments(std::string("cat"), actual, budget);
+        ASSERT(result.truncated);
+        ASSERT(result.documents.empty());
+    }
+}
+
+// Тест на ограничение числа одновременных запросов
+void TestConcurrencyLimit() {
+    ConcurrencyLimit limit;
+    limit.max_concurrent_queries = 1;
+    limit.policy = OverloadPolicy::REJECT;
+    const auto limiter = std::make_shared<ConcurrencyLimiter>(limit);
+
+    {
+        ConcurrencyLimiter::Permit permit(limiter);
+        ASSERT_EQUAL(limiter->GetActiveCount(), 1);
+        bool thrown = false;
+        try {
+            ConcurrencyLimiter::Permit second(limiter);
+        }
+        catch (const std::overflow_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+        ASSERT_EQUAL(limiter->GetRejectedCount(), 1);
+    }
+    ASSERT_EQUAL(limiter->GetActiveCount(), 0);
+
+    // слот возвращается ограничителю, которым был получен, даже если тот уже заменён
+    {
+        std::weak_ptr<ConcurrencyLimiter> replaced;
+        {
+            auto current = std::make_shared<ConcurrencyLimiter>(limit);
+            replaced = current;
+            ConcurrencyLimiter::Permit permit(std::move(current));
+            ASSERT(!replaced.expired());
+            ASSERT_EQUAL(replaced.lock()->GetActiveCount(), 1);
+        }
+        ASSERT(replaced.expired());
+    }
+
+    // после освобождения слота запросы снова выполняются
+    SearchServer server;
+    server.AddDocument(1, std::string("cat in the city"), DocumentStatus::ACTUAL, { 1 });
+    limit.policy = OverloadPolicy::QUEUE;
+    server.SetConcurrencyLimit(limit);
+    ASSERT_EQUAL(server.FindTopDocuments(std::string("cat")).size(), 1);
+    ASSERT_EQUAL(server.FindTopDocuments(std::execution::par, std::string("city")).size(), 1);
+
+    // смена предела во время запросов
+    std::atomic<bool> searching = true;
+    std::atomic<size_t> found = 0;
+    std::thread searcher([&server, &searching, &found]() {
+        for (int i = 0; i < 2000; ++i) {
+            found += server.FindTopDocuments(std::string("cat")).size();
+        }
+        searching = false;
+    });
+    while (searching) {
+        server.SetConcurrencyLimit(limit);
+    }
+    searcher.join();
+    ASSERT_EQUAL(found.load(), 2000u);
+}
+// Тест гистограммы задержек и сбора метрик
+void TestMetrics() {
+    // нижняя граница диапазона не больше значения, а погрешность не превышает 1/32
+    for (uint64_t value : { 0ull, 31ull, 32ull, 1000ull, 123456789ull, 1ull << 40 }) {
+        const uint64_t bucket_value = LatencyHistogram::GetBucketValue(LatencyHistogram::GetBucketIndex(value));
+        ASSERT(bucket_value <= value);
+        ASSERT(value - bucket_value <= value / LatencyHistogram::SUB_BUCKET_COUNT);
+    }
+    ASSERT_EQUAL(LatencyHistogram::GetBucketIndex(~0ull), LatencyHistogram::BUCKET_COUNT - 1);
+
+    HistogramSnapshot histogram;
+    for (uint64_t value = 1; value <= 100; ++value) {
+        ++histogram.buckets[LatencyHistogram::GetBucketIndex(value * 1000)];
+        ++histogram.count;
+    }
+    const uint64_t median = histogram.GetPercentile(50);
+    ASSERT(median <= 50000 && median >= 50000 - 50000 / LatencyHistogram::SUB_BUCKET_COUNT);
+
+#ifdef SEARCH_SERVER_METRICS
+    ResetMetrics();
+    SearchServer server;
+    server.AddDocument(1, std::string("cat in the city"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("dog in the city"), DocumentStatus::ACTUAL, { 1 });
+    server.FindTopDocuments(std::string("city -dog"));
+    const MetricsSnapshot snapshot = TakeMetricsSnapshot();
+    ASSERT_EQUAL(snapshot.Get(MetricCounter::DOCUMENTS_ADDED), 2);
+    ASSERT_EQUAL(snapshot.Get(MetricCounter::QUERIES), 1);
+    ASSERT_EQUAL(snapshot.Get(MetricCounter::POSTINGS_SCANNED), 2);
+    ASSERT_EQUAL(snapshot.Get(MetricPhase::QUERY_PARSE).count, 1);
+    ASSERT_EQUAL(snapshot.Get(MetricPhase::MINUS_WORD_FILTER).count, 1);
+#else
+    ASSERT_EQUAL(TakeMetricsSnapshot().Get(MetricCounter::QUERIES), 0);
+#endif
+}
+// Тест статистики выполнения запроса
+void TestQueryStats() {
+    SearchServer server(std::string("and with"));
+    server.AddDocument(1, std::string("white cat and yellow hat"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("curly cat curly tail"), DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, std::string("nasty dog with big eyes"), DocumentStatus::BANNED, { 3 });
+    server.AddDocument(4, std::string("nasty cat tail"), DocumentStatus::ACTUAL, { 4 });
+
+    {
+        QueryStats stats;
+        const auto found_docs = server.FindTopDocuments(std::execution::par, std::string("cat nasty and parrot -tail"),
+            [](int document_id, DocumentStatus status, int rating) { return status == DocumentStatus::ACTUAL; },
+            stats);
+        ASSERT_EQUAL(stats.execution_policy, std::string("par"));
+        // стоп-слово and отброшено, слова отсортированы: сначала плюс-слова, затем минус-слова
+        ASSERT_EQUAL(stats.terms.size(), 4);
+        ASSERT_EQUAL(stats.terms[0].word, std::string("cat"));
+        ASSERT_EQUAL(stats.terms[0].document_freq, 3);
+        ASSERT(std::abs(stats.terms[0].inverse_document_freq - std::log(4.0 / 3.0)) < EPSILON);
+        ASSERT_EQUAL(stats.terms[2].word, std::string("parrot"));
+        ASSERT_EQUAL(stats.terms[2].document_freq, 0);
+        ASSERT(stats.terms[3].is_minus);
+        // cat: 1, 2, 4; nasty: 3, 4
+        ASSERT_EQUAL(stats.postings_scanned, 5);
+        ASSERT_EQUAL(stats.rejected_by_predicate, 1);
+        ASSERT_EQUAL(stats.candidates_created, 3);
+        ASSERT_EQUAL(stats.rejected_by_minus_words, 2);
+        ASSERT_EQUAL(stats.documents_returned, 1);
+        ASSERT_EQUAL(found_docs.size(), 1);
+        ASSERT_EQUAL(found_docs[0].id, 1);
+    }
+
+    {
+        QueryStats stats;
+        const std::string query = std::string("cat -tail");
+        const auto [matched_words, status] = server.MatchDocument(query, 2, stats);
+        ASSERT(matched_words.empty());
+        ASSERT_EQUAL(stats.execution_policy, std::string("seq"));
+        ASSERT_EQUAL(stats.rejected_by_minus_words, 1);
+        ASSERT_EQUAL(stats.documents_returned, 0);
+        // документ исключён по первому же списку минус-слова
+        ASSERT_EQUAL(stats.postings_scanned, 1);
+    }
+    {
+        // по списку на каждое слово запроса из индекса; слова вне индекса не читаются
+        QueryStats stats;
+        server.MatchDocument(std::string("cat hat unknown -dog"), 1, stats);
+        ASSERT_EQUAL(stats.postings_scanned, 3);
+        ASSERT_EQUAL(stats.documents_returned, 1);
+    }
+}
+// Тест пакетного сопоставления запроса со многими документами
+void TestMatchDocumentsBatch() {
+    SearchServer server(std::string("and with"));
+    server.AddDocument(1, std::string("white cat and yellow hat"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("curly cat curly tail"), DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, std::string("nasty dog with big eyes"), DocumentStatus::BANNED, { 3 });
+    server.AddDocument(4, std::string("nasty cat tail"), DocumentStatus::ACTUAL, { 4 });
+
+    const std::string query = std::string("tail cat nasty hat parrot -eyes");
+    const std::vector<int> document_ids = { 4, 1, 3, 2, 4 };
+    const BatchMatchResult result = server.MatchDocuments(query, document_ids);
+    ASSERT_EQUAL(result.GetDocumentCount(), document_ids.size());
+
+    // результат для каждого документа совпадает с поштучным MatchDocument
+    for (size_t i = 0; i < document_ids.size(); ++i) {
+        const auto [expected_words, expected_status] = server.MatchDocument(query, document_ids[i]);
+        const auto words = result.GetMatchedWords(i);
+        ASSERT_EQUAL(std::vector<std::string_view>(words.begin(), words.end()), expected_words);
+        ASSERT(result.statuses[i] == expected_status);
+    }
+    ASSERT(result.GetMatchedWords(2).begin() == result.GetMatchedWords(2).end());
+
+    // несуществующий документ
+    {
+        bool thrown = false;
+        try {
+            server.MatchDocuments(query, { 1, 100 });
+        }
+        catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+
+    // параллельная версия не падает на словах, которых нет в индексе
+    {
+        const auto [matched_words, status] = server.MatchDocument(std::execution::par, query, 4);
+        ASSERT_EQUAL(matched_words.size(), 3);
+    }
+}
+// Тест постраничной выдачи через курсор
+void TestSearchCursor() {
+    SearchServer server;
+    for (int id = 0; id < 23; ++id) {
+        std::string text = std::string("cat");
+        for (int i = 0; i < id % 7; ++i) {
+            text += std::string(" filler");
+        }
+        server.AddDocument(id, text, id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { id });
+    }
+
+    SearchCursor cursor = server.OpenCursor(std::string("cat"), 4);
+    // курсор не ограничен MAX_RESULT_DOCUMENT_COUNT
+    ASSERT_EQUAL(cursor.GetResultCount(), 18);
+    ASSERT_EQUAL(cursor.GetPageCount(), 5);
+
+    // страницы вместе дают полностью упорядоченную выдачу, даже если запрашивать их не по порядку
+    const auto last_page = cursor.GetPage(4);
+    ASSERT_EQUAL(last_page.size(), 2);
+    std::vector<Document> all_pages;
+    for (size_t page_index = 0; page_index < cursor.GetPageCount(); ++page_index) {
+        const auto page = cursor.GetPage(page_index);
+        all_pages.insert(all_pages.end(), page.begin(), page.end());
+    }
+    ASSERT_EQUAL(all_pages.size(), 18);
+    for (size_t i = 1; i < all_pages.size(); ++i) {
+        ASSERT(!IsMoreRelevant(all_pages[i], all_pages[i - 1]));
+    }
+
+    // первая страница совпадает с обычным поиском
+    const auto top = server.FindTopDocuments(std::string("cat"));
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_EQUAL(all_pages[i].id, top[i].id);
+    }
+    ASSERT_EQUAL(cursor.GetPage(5).size(), 0);
+
+    SearchCursor banned = server.OpenCursor(std::execution::par, std::string("cat"),
+        [](int document_id, DocumentStatus status, int rating) { return status == DocumentStatus::BANNED; }, 10);
+    ASSERT_EQUAL(banned.GetResultCount(), 5);
+    ASSERT_EQUAL(banned.GetPage(0).size(), 5);
+}
+
+// Тест размещения индекса в заданном ресурсе памяти
+void TestMemoryResource() {
+    const std::vector<std::string> documents = {
+        std::string("white cat and fashionable collar"), std::string("fluffy cat fluffy tail"),
+        std::string("groomed dog expressive eyes"), std::string("groomed starling eugene"),
+    };
+    SearchServer reference(std::string("and"));
+    CountingMemoryResource counting;
+    SearchServerOptions options;
+    options.memory_resource = &counting;
+    SearchServer server(std::string("and"), options);
+    ASSERT(server.GetMemoryResource() == &counting);
+    for (int id = 0; id < static_cast<int>(documents.size()); ++id) {
+        reference.AddDocument(id, documents[id], DocumentStatus::ACTUAL, { id });
+        server.AddDocument(id, documents[id], DocumentStatus::ACTUAL, { id });
+    }
+    // весь индекс размещён через переданный ресурс
+    ASSERT(counting.GetCounters().allocations > 0);
+    const auto expected = reference.FindTopDocuments(std::string("fluffy groomed cat"));
+    const auto found = server.FindTopDocuments(std::execution::par, std::string("fluffy groomed cat"));
+    ASSERT_EQUAL(found.size(), expected.size());
+    for (size_t i = 0; i < found.size(); ++i) {
+        ASSERT_EQUAL(found[i].id, expected[i].id);
+        ASSERT(std::abs(found[i].relevance - expected[i].relevance) < EPSILON);
+    }
+    ASSERT_EQUAL(server.GetWordFrequencies(1).size(), 3);
+    ASSERT(server.GetWordFrequencies(1).count(std::string_view("fluffy")));
+
+    // параллельное удаление освобождает и прямой индекс документа
+    const size_t in_use = counting.GetCounters().bytes_in_use;
+    server.RemoveDocument(std::execution::par, 1);
+    ASSERT(counting.GetCounters().bytes_in_use < in_use);
+    ASSERT(server.GetWordFrequencies(1).empty());
+
+    // в режиме арены вышестоящий ресурс видит только крупные блоки
+    CountingMemoryResource arena_upstream;
+    options.memory_resource = &arena_upstream;
+    options.use_arena = true;
+    options.arena_initial_size = 4096;
+    {
+        SearchServer arena_server(std::string("and"), options);
+        for (int id = 0; id < 200; ++id) {
+            arena_server.AddDocument(id, documents[id % documents.size()], DocumentStatus::ACTUAL, { id });
+        }
+        ASSERT(arena_upstream.GetCounters().allocations < 20);
+        arena_server.RemoveDocument(0);
+        ASSERT_EQUAL(arena_server.GetDocumentCount(), 199);
+        ASSERT_EQUAL(arena_server.FindTopDocuments(std::string("starling")).size(), 5);
+    }
+    ASSERT_EQUAL(arena_upstream.GetCounters().bytes_in_use, 0);
+
+    // повторный запрос берёт временную память из пула потока, не обращаясь к куче
+    reference.FindTopDocuments(std::string("fluffy groomed cat -collar"));
+    const size_t scratch_allocations = QueryScratchScope::GetThreadCounters().allocations;
+    reference.FindTopDocuments(std::string("fluffy groomed cat -collar"));
+    ASSERT_EQUAL(QueryScratchScope::GetThreadCounters().allocations, scratch_allocations);
+}
+
+// Тест учёта памяти индекса и предела памяти
+void TestMemoryUsage() {
+    CountingMemoryResource counting;
+    SearchServerOptions options;
+    options.memory_resource = &counting;
+    SearchServer server(std::string("and with"), options);
+    const MemoryUsage empty = server.GetMemoryUsage();
+    ASSERT(empty.stop_words > 0);
+    ASSERT_EQUAL(empty.dictionary + empty.inverted_index + empty.forward_index + empty.document_metadata, 0);
+
+    server.AddDocument(1, std::string("white cat and fashionable collar"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("fluffy cat fluffy tail"), DocumentStatus::ACTUAL, { 2 });
+    const MemoryUsage usage = server.GetMemoryUsage();
+    ASSERT(usage.dictionary > 0);
+    ASSERT(usage.inverted_index > 0);
+    ASSERT(usage.forward_index > 0);
+    ASSERT(usage.document_metadata > 0);
+    // части индекса в сумме дают всё, что сервер взял у ресурса
+    ASSERT_EQUAL(usage.GetTotal() - usage.stop_words, counting.GetCounters().bytes_in_use);
+
+    // удаление освобождает всё, кроме слов словаря
+    server.RemoveDocument(2);
+    const MemoryUsage after_remove = server.GetMemoryUsage();
+    ASSERT_EQUAL(after_remove.dictionary, usage.dictionary);
+    ASSERT(after_remove.inverted_index < usage.inverted_index);
+    ASSERT(after_remove.forward_index < usage.forward_index);
+    ASSERT(after_remove.document_metadata < usage.document_metadata);
+
+    // при пределе памяти документы добавляются, пока не упрутся в него, и предел не превышается
+    options.memory_limit = 4096;
+    SearchServer limited(std::string("and with"), options);
+    int added = 0;
+    try {
+        for (int id = 0; id < 1000; ++id) {
+            limited.AddDocument(id, std::string("word") + std::to_string(id) + std::string(" cat with collar"),
+                DocumentStatus::ACTUAL, { id });
+            ++added;
+        }
+        ASSERT_HINT(false, "memory limit must refuse AddDocument");
+    }
+    catch (const std::length_error&) {
+    }
+    ASSERT(added > 0);
+    ASSERT_EQUAL(limited.GetDocumentCount(), added);
+    ASSERT(limited.GetMemoryUsage().GetTotal() <= options.memory_limit);
+    // после удаления документа место снова появляется
+    limited.RemoveDocument(0);
+    limited.AddDocument(0, std::string("cat"), DocumentStatus::ACTUAL, { 0 });
+    ASSERT_EQUAL(limited.GetDocumentCount(), added);
+}
+
+// Тест снимка индекса и журнала изменений
+void TestPersistence() {
+    const auto directory = std::filesystem::temp_directory_path() / (std::string("search_server_test_")
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    const auto same_results = [](const SearchServer& lhs, const SearchServer& rhs, const std::string& query) {
+        const auto lhs_documents = lhs.FindTopDocuments(query);
+        const auto rhs_documents = rhs.FindTopDocuments(query);
+        ASSERT_EQUAL(lhs_documents.size(), rhs_documents.size());
+        for (size_t i = 0; i < lhs_documents.size(); ++i) {
+            ASSERT_EQUAL(lhs_documents[i].id, rhs_documents[i].id);
+            ASSERT_EQUAL(lhs_documents[i].relevance, rhs_documents[i].relevance);
+            ASSERT_EQUAL(lhs_documents[i].rating, rhs_documents[i].rating);
+        }
+    };
+    const std::string query = std::string("fluffy groomed cat -collar");
+
+    SearchServer expected(std::string("and with"));
+    {
+        PersistenceOptions options;
+        options.log.group_commit_records = 3;
+        options.log.group_commit_interval = std::chrono::hours(1);
+        PersistentSearchServer server(directory, std::string("and with"), options);
+        server.AddDocument(1, std::string("white cat and fashionable collar"), DocumentStatus::ACTUAL, { 8, -3 });
+        server.AddDocument(2, std::string("fluffy cat fluffy tail"), DocumentStatus::ACTUAL, { 7, 2, 7 });
+        server.AddDocument(3, std::string("groomed dog expressive eyes"), DocumentStatus::ACTUAL, { 5, -12, 2, 1 });
+        server.RemoveDocument(3);
+        server.AddDocument(4, std::string("groomed starling eugene"), DocumentStatus::BANNED, { 9 });
+        // групповая фиксация: записи уходят на диск пачками по три
+        ASSERT_EQUAL(server.GetLog().GetSyncCount(), 1);
+        ASSERT_EQUAL(server.GetLog().GetPendingRecords(), 2);
+        // неверный документ не попадает в журнал
+        try {
+            server.AddDocument(1, std::string("duplicate"), DocumentStatus::ACTUAL, {});
+            ASSERT_HINT(false, "duplicate id must be rejected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+    expected.AddDocument(1, std::string("white cat and fashionable collar"), DocumentStatus::ACTUAL, { 8, -3 });
+    expected.AddDocument(2, std::string("fluffy cat fluffy tail"), DocumentStatus::ACTUAL, { 7, 2, 7 });
+    expected.AddDocument(4, std::string("groomed starling eugene"), DocumentStatus::BANNED, { 9 });
+
+    {
+        // восстановление проигрывает журнал поверх пустого снимка; оборванная запись в конце отбрасывается
+        std::ofstream(directory / "wal", std::ios::binary | std::ios::app) << std::string("\x10\x00\x00", 3);
+        PersistentSearchServer server(directory, std::string("ignored"));
+        ASSERT_EQUAL(server.GetRecoveryStats().replayed_records, 5);
+        ASSERT_EQUAL(server.GetRecoveryStats().discarded_log_bytes, 3);
+        ASSERT_EQUAL(server.GetServer().GetDocumentCount(), 3);
+        same_results(server.GetServer(), expected, query);
+        same_results(server.GetServer(), expected, std::string("with cat"));
+
+        server.Checkpoint();
+        server.AddDocument(5, std::string("fluffy fluffy fluffy"), DocumentStatus::ACTUAL, { 1 });
+    }
+    expected.AddDocument(5, std::string("fluffy fluffy fluffy"), DocumentStatus::ACTUAL, { 1 });
+
+    {
+        // после контрольной точки проигрываются только новые операции
+        PersistentSearchServer server(directory, std::string());
+        ASSERT_EQUAL(server.GetRecoveryStats().snapshot_documents, 3);
+        ASSERT_EQUAL(server.GetRecoveryStats().replayed_records, 1);
+        same_results(server.GetServer(), expected, query);
+
+        // журнал, не очищенный после контрольной точки, не применяется повторно
+        const auto log_copy = directory / "wal.copy";
+        std::filesystem::copy_file(directory / "wal", log_copy);
+        server.Checkpoint();
+        std::filesystem::rename(log_copy, directory / "wal");
+    }
+    {
+        PersistentSearchServer server(directory, std::string());
+        ASSERT_EQUAL(server.GetRecoveryStats().snapshot_documents, 4);
+        ASSERT_EQUAL(server.GetRecoveryStats().replayed_records, 0);
+        same_results(server.GetServer(), expected, query);
+        server.AddDocument(6, std::string("cat"), DocumentStatus::ACTUAL, { 1 });
+        ASSERT_EQUAL(server.GetLog().GetLastSequence(), 7);
+    }
+
+    // снимок в поток и обратно даёт те же результаты; повреждённый снимок отвергается
+    std::stringstream stream;
+    WriteSnapshot(expected, stream, 42);
+    uint64_t last_sequence = 0;
+    const SearchServer restored = ReadSnapshot(stream, SearchServerOptions{}, &last_sequence);
+    ASSERT_EQUAL(last_sequence, 42);
+    same_results(restored, expected, query);
+    ASSERT_EQUAL(restored.GetWordFrequencies(2).size(), expected.GetWordFrequencies(2).size());
+    std::string corrupted = stream.str();
+    corrupted[corrupted.size() / 2] ^= 1;
+    std::istringstream corrupted_stream(corrupted);
+    try {
+        ReadSnapshot(corrupted_stream);
+        ASSERT_HINT(false, "corrupted snapshot must be rejected");
+    }
+    catch (const std::runtime_error&) {
+    }
+
+    {
+        // замена дубликата повторяется при проигрывании журнала под тем же id
+        const auto superseding = directory / "superseding";
+        PersistenceOptions options;
+        options.server.duplicate_policy = DuplicatePolicy::SUPERSEDE;
+        {
+            PersistentSearchServer server(superseding, std::string(), options);
+            ASSERT_EQUAL(server.AddDocument(1, std::string("cat dog"), DocumentStatus::ACTUAL, { 1 }), 1);
+            ASSERT_EQUAL(server.AddDocument(5, std::string("dog cat"), DocumentStatus::ACTUAL, { 9 }), 1);
+        }
+        PersistentSearchServer server(superseding, std::string(), options);
+        ASSERT_EQUAL(server.GetServer().GetDocumentCount(), 1);
+        ASSERT_EQUAL(server.GetServer().FindTopDocuments(std::string("cat"))[0].rating, 9);
+    }
+    {
+        // запись журнала, которую индекс не принимает, останавливает восстановление с её номером
+        const auto broken = directory / "broken";
+        PersistentSearchServer(broken, std::string());
+        {
+            WriteAheadLog log((broken / "wal").string(), 1);
+            log.AppendAddDocument(1, std::string("cat"), DocumentStatus::ACTUAL, { 1 });
+            log.AppendAddDocument(1, std::string("dog"), DocumentStatus::ACTUAL, { 1 });
+        }
+        try {
+            PersistentSearchServer server(broken, std::string());
+            ASSERT_HINT(false, "log record rejected by the index must fail recovery");
+        }
+        catch (const std::runtime_error& e) {
+            ASSERT(std::string(e.what()).find("log record 2:") != std::string::npos);
+        }
+    }
+    if (std::filesystem::exists("/dev/full")) {
+        // ошибка групповой фиксации не отменяет запись: она остаётся в буфере до следующего Sync
+        WriteAheadLogOptions options;
+        options.group_commit_records = 1;
+        options.sync_to_disk = false;
+        WriteAheadLog log(std::string("/dev/full"), 1, options);
+        try {
+            log.AppendRemoveDocument(1);
+            ASSERT_HINT(false, "write to a full device must fail");
+        }
+        catch (const std::runtime_error&) {
+        }
+        ASSERT_EQUAL(log.GetLastSequence(), 1);
+        ASSERT_EQUAL(log.GetPendingRecords(), 1);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+// Тест совершенного хеша стоп-слов
+void TestStopWordSet() {
+    std::vector<std::string> words;
+    for (int i = 0; i < 500; ++i) {
+        words.push_back(std::string("stop") + std::to_string(i));
+    }
+    words.push_back(std::string("stop7"));
+    words.push_back(std::string());
+    const StopWordSet stop_words(words);
+    ASSERT_EQUAL(stop_words.GetSize(), 500);
+    for (int i = 0; i < 500; ++i) {
+        ASSERT(stop_words.Contains(std::string("stop") + std::to_string(i)));
+        ASSERT(!stop_words.Contains(std::string("word") + std::to_string(i)));
+    }
+    ASSERT(!stop_words.Contains(std::string("stop")));
+    ASSERT(!stop_words.Contains(std::string("stop5000")));
+    ASSERT(!stop_words.Contains(std::string()));
+    ASSERT(!StopWordSet().Contains(std::string("in")));
+
+    // список, известный при компиляции, строится constexpr
+    static constexpr auto static_stop_words = MakeStaticStopWordSet("in", "the", "on", "and");
+    static_assert(static_stop_words.Contains("the"));
+    static_assert(!static_stop_words.Contains("cat"));
+    static_assert(!static_stop_words.Contains("o"));
+
+    SearchServer server(static_stop_words);
+    server.AddDocument(1, std::string("cat in the city"), DocumentStatus::ACTUAL, { 1 });
+    ASSERT(server.FindTopDocuments(std::string("in")).empty());
+    ASSERT_EQUAL(server.FindTopDocuments(std::string("the cat")).size(), 1);
+    ASSERT_EQUAL(server.GetWordFrequencies(1).size(), 2);
+
+    try {
+        SearchServer invalid(std::vector<std::string>{ std::string("in"), std::string("bad\x12") });
+        ASSERT_HINT(false, "invalid stop words must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+}
+
+void TestTokenizer() {
+    const auto tokenize = [](const Tokenizer& tokenizer, std::string_view text) {
+        std::string buffer(text.size(), ' ');
+        std::vector<std::string> words;
+        tokenizer.ForEachToken(text, buffer.data(), [&words](const Token& token) {
+            words.emplace_back(token.normalized);
+            });
+        return words;
+    };
+    using Words = std::vector<std::string>;
+
+    // по умолчанию - разбиение по пробелам без изменений, как SplitIntoWords
+    const Tokenizer legacy;
+    ASSERT(legacy.IsIdentity());
+    ASSERT_EQUAL(tokenize(legacy, std::string("  Cat,  dog-fish ")), (Words{ std::string("Cat,"), std::string("dog-fish") }));
+
+    TokenizerOptions options;
+    options.fold_case = true;
+    options.strip_punctuation = true;
+    options.delimiters = std::string(" \t\n");
+    const Tokenizer tokenizer(options);
+    ASSERT(!tokenizer.IsIdentity());
+    ASSERT_EQUAL(tokenize(tokenizer, std::string("The CAT,\tsat -- on\n\"Mat\"!")),
+        (Words{ std::string("the"), std::string("cat"), std::string("sat"), std::string("on"), std::string("mat") }));
+    ASSERT_EQUAL(tokenize(tokenizer, std::string("Ёжик ВЕСЕЛЫЙ, «Ёлка» — Щука… Über ÉTÉ ×")),
+        (Words{ std::string("ёжик"), std::string("веселый"), std::string("ёлка"), std::string("щука"),
+        std::string("über"), std::string("été"), std::string("×") }));
+
+    // неизменённое слово ссылается на исходный текст, изменённое - на буфер
+    const std::string text("cat Dog");
+    std::string buffer(text.size(), ' ');
+    std::vector<Token> tokens;
+    tokenizer.ForEachToken(text, buffer.data(), [&tokens](const Token& token) {
+        tokens.push_back(token);
+        });
+    ASSERT_EQUAL(tokens.size(), 2);
+    ASSERT(tokens[0].normalized.data() == text.data());
+    ASSERT(tokens[1].normalized.data() == buffer.data());
+    ASSERT_EQUAL(tokens[1].raw, std::string("Dog"));
+    tokenizer.ForEachToken(std::string("ca\x01t"), buffer.data(), [](const Token& token) {
+        ASSERT(!token.is_valid);
+        });
+
+    // сервер нормализует документы, запросы и стоп-слова одним токенизатором
+    SearchServerOptions server_options;
+    server_options.tokenizer = options;
+    SearchServer server(std::string("And THE"), server_options);
+    server.AddDocument(1, std::string("The Cat, and the HAT!"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("Кот и «Собака»"), DocumentStatus::ACTUAL, { 2 });
+    ASSERT_EQUAL(server.GetWordFrequencies(1).size(), 2);
+    ASSERT_EQUAL(server.FindTopDocuments(std::string("cat")).size(), 1);
+    ASSERT_EQUAL(server.FindTopDocuments(std::string("HAT?")).size(), 1);
+    ASSERT_EQUAL(server.FindTopDocuments(std::string("КОТ")).at(0).id, 2);
+    ASSERT(server.FindTopDocuments(std::string("cat -Hat,")).empty());
+    ASSERT(server.FindTopDocuments(std::string("the")).empty());
+
+    // найденные слова ссылаются на словарь и переживают запрос
+    std::vector<std::string_view> matched;
+    {
+        const std::string query("CAT hat -dog");
+        matched = std::get<0>(server.MatchDocument(query, 1));
+    }
+    ASSERT_EQUAL(matched, (std::vector<std::string_view>{ std::string_view("cat"), std::string_view("hat") }));
+    ASSERT_EQUAL(std::get<0>(server.MatchDocument(std::execution::par, std::string("СОБАКА"), 2)),
+        (std::vector<std::string_view>{ std::string_view("собака") }));
+
+    try {
+        TokenizerOptions invalid;
+        invalid.delimiters = std::string("—");
+        Tokenizer tokenizer_with_invalid_delimiters(invalid);
+        ASSERT_HINT(false, "non-ASCII delimiters must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+}
+
+void TestWildcardQuery() {
+    SearchServerOptions options;
+    options.max_term_expansion = 3;
+    SearchServer server(std::string("and"), options);
+    server.AddDocument(1, std::string("cat and cats"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("catalog of coats"), DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, std::string("dog cart"), DocumentStatus::ACTUAL, { 3 });
+    server.AddDocument(4, std::string("cattle"), DocumentStatus::ACTUAL, { 4 });
+    const auto ids = [](const std::vector<Document>& documents) {
+        std::set<int> result;
+        for (const Document& document : documents) {
+            result.insert(document.id);
+        }
+        return result;
+    };
+
+    // раскрытие оценивается как обычные слова запроса
+    const auto by_pattern = server.FindTopDocuments(std::string("cats*"));
+    const auto by_words = server.FindTopDocuments(std::string("cats"));
+    ASSERT_EQUAL(by_pattern.size(), 1);
+    ASSERT(std::abs(by_pattern[0].relevance - by_words[0].relevance) < EPSILON);
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("c*ts"))), (std::set<int>{ 1, 2 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("ca*t"))), (std::set<int>{ 1, 3 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("c*t* -catt*"))), (std::set<int>{ 1, 2, 3 }));
+    ASSERT(server.FindTopDocuments(std::string("bird*")).empty());
+    ASSERT_EQUAL(std::get<0>(server.MatchDocument(std::string("cat*"), 1)),
+        (std::vector<std::string_view>{ std::string_view("cat"), std::string_view("cats") }));
+
+    // cat, catalog, cats, cattle, cart: раскрытие ограничено тремя первыми по алфавиту
+    QueryStats stats;
+    const auto found = server.FindTopDocuments(std::string("ca*"),
+        [](int, DocumentStatus, int) { return true; }, stats);
+    ASSERT_EQUAL(stats.truncated_expansions, 1);
+    ASSERT_EQUAL(stats.terms.size(), 3);
+    ASSERT_EQUAL(stats.terms[0].word, std::string("cart"));
+    ASSERT_EQUAL(ids(found), (std::set<int>{ 1, 2, 3 }));
+
+    try {
+        server.FindTopDocuments(std::string("*at"));
+        ASSERT_HINT(false, "patterns starting with * must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+
+    // минус-шаблон не обрезается: иначе часть исключённых документов попала бы в результат
+    SearchServerOptions narrow_options;
+    narrow_options.max_term_expansion = 2;
+    SearchServer narrow(std::string(), narrow_options);
+    narrow.AddDocument(1, std::string("dog ca"), DocumentStatus::ACTUAL, { 1 });
+    narrow.AddDocument(2, std::string("dog cb"), DocumentStatus::ACTUAL, { 2 });
+    narrow.AddDocument(3, std::string("dog cc"), DocumentStatus::ACTUAL, { 3 });
+    QueryStats narrow_stats;
+    ASSERT(narrow.FindTopDocuments(std::string("dog -c*"), [](int, DocumentStatus, int) { return true; },
+        narrow_stats).empty());
+    ASSERT_EQUAL(narrow_stats.truncated_expansions, 0);
+    ASSERT(narrow.FindTopDocuments(std::execution::par, std::string("dog -c*")).empty());
+
+    // '*' сохраняется при удалении пунктуации; без раскрытия это обычный символ пунктуации
+    options.tokenizer.strip_punctuation = true;
+    SearchServer stripping(std::string(), options);
+    stripping.AddDocument(1, std::string("cats, dogs!"), DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(stripping.FindTopDocuments(std::string("cat*!")).size(), 1);
+    options.max_term_expansion = 0;
+    SearchServer literal(std::string(), options);
+    literal.AddDocument(1, std::string("cat"), DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(literal.FindTopDocuments(std::string("cat*")).size(), 1);
+    // по умолчанию шаблоны выключены: '*' - часть слова, как до их появления
+    SearchServer legacy_literal(std::string("and"));
+    legacy_literal.AddDocument(1, std::string("a*b"), DocumentStatus::ACTUAL, { 1 });
+    legacy_literal.AddDocument(2, std::string("* note"), DocumentStatus::ACTUAL, { 2 });
+    ASSERT_EQUAL(legacy_literal.FindTopDocuments(std::string("a*b")).size(), 1);
+    ASSERT(legacy_literal.FindTopDocuments(std::string("a*")).empty());
+    ASSERT_EQUAL(legacy_literal.FindTopDocuments(std::string("*")).size(), 1);
+}
+
+void TestPhraseQuery() {
+    SearchServerOptions options;
+    options.store_positions = true;
+    SearchServer server(std::string("and with"), options);
+    server.AddDocument(1, std::string("nasty dog with big eyes"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("big dog and small eyes"), DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, std::string("eyes big and bright"), DocumentStatus::ACTUAL, { 3 });
+    server.AddDocument(4, std::string("big cat"), DocumentStatus::ACTUAL, { 4 });
+    const auto ids = [](const std::vector<Document>& documents) {
+        std::set<int> result;
+        for (const Document& document : documents) {
+            result.insert(document.id);
+        }
+        return result;
+    };
+
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("big eyes"))), (std::set<int>{ 1, 2, 3, 4 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("\"big eyes\""))), (std::set<int>{ 1 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::execution::par, std::string("\"big eyes\""),
+        DocumentStatus::ACTUAL)), (std::set<int>{ 1 }));
+    // стоп-слова в позициях не учитываются: nasty dog big eyes
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("\"dog with big\""))), (std::set<int>{ 1 }));
+    // близость: слова в любом порядке в окне на slop позиций шире фразы
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("\"big eyes\"~0"))), (std::set<int>{ 1, 3 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("\"eyes big\"~2"))), (std::set<int>{ 1, 2, 3 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("big -\"big eyes\""))), (std::set<int>{ 2, 3, 4 }));
+    ASSERT_EQUAL(ids(server.FindTopDocuments(std::string("\"big eyes\" -nasty"))), (std::set<int>()));
+    ASSERT(server.FindTopDocuments(std::string("\"big parrot\"")).empty());
+
+    // релевантность фразы - TF-IDF её слов
+    ASSERT(std::abs(server.FindTopDocuments(std::string("\"big eyes\""))[0].relevance
+        - server.FindTopDocuments(std::string("big eyes -bright -small -cat"))[0].relevance) < EPSILON);
+
+    QueryStats stats;
+    server.FindTopDocuments(std::string("\"big eyes\""), [](int, DocumentStatus, int) { return true; }, stats);
+    ASSERT_EQUAL(stats.rejected_by_phrases, 3);
+    ASSERT_EQUAL(stats.documents_returned, 1);
+
+    using Words = std::vector<std::string_view>;
+    ASSERT_EQUAL(std::get<0>(server.MatchDocument(std::string("\"big eyes\""), 1)),
+        (Words{ std::string_view("big"), std::string_view("eyes") }));
+    ASSERT(std::get<0>(server.MatchDocument(std::string("\"big eyes\""), 2)).empty());
+    ASSERT(std::get<0>(server.MatchDocument(std::execution::par, std::string("\"big eyes\""), 3)).empty());
+    const auto batch = server.MatchDocuments(std::string("\"big eyes\""), { 1, 2, 3 });
+    ASSERT_EQUAL(batch.GetMatchedWords(0).size(), 2);
+    ASSERT_EQUAL(batch.GetMatchedWords(1).size(), 0);
+
+    try {
+        server.FindTopDocuments(std::string("\"big eyes"));
+        ASSERT_HINT(false, "unclosed phrases must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+
+    // позиции сохраняются в снимке и освобождаются при удалении документа
+    std::stringstream stream;
+    WriteSnapshot(server, stream);
+    const SearchServer restored = ReadSnapshot(stream, options);
+    ASSERT_EQUAL(ids(restored.FindTopDocuments(std::string("\"big eyes\""))), (std::set<int>{ 1 }));
+    const size_t positions_bytes = server.GetMemoryUsage().positions;
+    ASSERT(positions_bytes > 0);
+    server.RemoveDocument(1);
+    ASSERT(server.GetMemoryUsage().positions < positions_bytes);
+    ASSERT(server.FindTopDocuments(std::string("\"big eyes\"")).empty());
+
+    // без позиций кавычки - обычные символы
+    SearchServer plain(std::string("and with"));
+    plain.AddDocument(1, std::string("big eyes"), DocumentStatus::ACTUAL, { 1 });
+    ASSERT(plain.FindTopDocuments(std::string("\"big eyes\"")).empty());
+    std::stringstream plain_stream;
+    WriteSnapshot(plain, plain_stream);
+    try {
+        ReadSnapshot(plain_stream, options);
+        ASSERT_HINT(false, "snapshot without positions must be rejected");
+    }
+    catch (const std::runtime_error&) {
+    }
+}
+
+// Тест политик ранжирования
+void TestScoringPolicies() {
+    SearchServer server(std::string("and"));
+    server.AddDocument(1, std::string("white cat"), DocumentStatus::ACTUAL, { 1 });
+    server.AddDocument(2, std::string("cat and cat dog"), DocumentStatus::ACTUAL, { 2 });
+    server.AddDocument(3, std::string("bird"), DocumentStatus::ACTUAL, { 3 });
+    const auto all = [](int, DocumentStatus, int) { return true; };
+    const auto relevance_of = [](const std::vector<Document>& documents, int id) {
+        for (const Document& document : documents) {
+            if (document.id == id) {
+                return document.relevance;
+            }
+        }
+        return -1.0;
+    };
+
+    // TF-IDF по умолчанию
+    const auto tf_idf = server.FindTopDocuments(std::string("cat dog"), all, TfIdfScorer());
+    const auto by_default = server.FindTopDocuments(std::string("cat dog"));
+    ASSERT_EQUAL(tf_idf.size(), by_default.size());
+    for (size_t i = 0; i < tf_idf.size(); ++i) {
+        ASSERT_EQUAL(tf_idf[i].id, by_default[i].id);
+        ASSERT(std::abs(tf_idf[i].relevance - by_default[i].relevance) < EPSILON);
+    }
+    ASSERT(std::abs(relevance_of(tf_idf, 2) - (2.0 / 3 * std::log(1.5) + 1.0 / 3 * std::log(3.0))) < EPSILON);
+
+    // BM25: стоп-слова не входят в длину документа, средняя длина 2
+    const Bm25Scorer bm25;
+    const double idf = std::log(1.0 + (3 - 2 + 0.5) / (2 + 0.5));
+    const auto saturation = [&bm25](double count, double length) {
+        return count * (bm25.k1 + 1) / (count + bm25.k1 * (1 - bm25.b + bm25.b * length / 2.0));
+    };
+    const auto ranked = server.FindTopDocuments(std::string("cat"), all, bm25);
+    ASSERT_EQUAL(ranked.size(), 2);
+    ASSERT_EQUAL(ranked[0].id, 2);
+    ASSERT(std::abs(ranked[0].relevance - idf * saturation(2, 3)) < EPSILON);
+    ASSERT(std::abs(ranked[1].relevance - idf * saturation(1, 2)) < EPSILON);
+    const auto parallel = server.FindTopDocuments(std::execution::par, std::string("cat"), all, bm25);
+    ASSERT_EQUAL(parallel.size(), 2);
+    ASSERT(std::abs(parallel[0].relevance - ranked[0].relevance) < EPSILON);
+
+    // без насыщения по числу вхождений BM25 не отличает документы по tf
+    Bm25Scorer flat;
+    flat.k1 = 0;
+    const auto flat_ranked = server.FindTopDocuments(std::string("cat"), all, flat);
+    ASSERT(std::abs(flat_ranked[0].relevance - flat_ranked[1].relevance) < EPSILON);
+
+    // своя политика без Prepare и функция
+    struct CountScorer {
+        double Score(const TermScoringContext&, uint32_t term_count, uint32_t) const {
+            return term_count;
+        }
+    };
+    ASSERT(std::abs(relevance_of(server.FindTopDocuments(std::string("cat dog"), all, CountScorer()), 2) - 3.0) < EPSILON);
+    const auto by_length = [](const TermScoringContext& context, uint32_t, uint32_t document_length) {
+        return static_cast<double>(document_length) / context.document_freq;
+    };
+    const auto lengths = server.FindTopDocuments(std::string("cat"), all, by_length);
+    ASSERT(std::abs(relevance_of(lengths, 1) - 1.0) < EPSILON);
+    ASSERT(std::abs(relevance_of(lengths, 2) - 1.5) < EPSILON);
+    static_assert(!IS_SCORER<int>);
+
+    // числа вхождений и длины документов переживают снимок и удаление
+    std::stringstream stream;
+    WriteSnapshot(server, stream);
+    const SearchServer restored = ReadSnapshot(stream);
+    ASSERT(std::abs(restored.FindTopDocuments(std::string("cat"), all, bm25)[0].relevance - ranked[0].relevance) < EPSILON);
+    ASSERT(std::abs(restored.GetWordFrequencies(2).at("cat") - 2.0 / 3) < EPSILON);
+    server.RemoveDocument(3);
+    const double idf_after = std::log(1.0 + (2 - 2 + 0.5) / (2 + 0.5));
+    const double length_after = 2.5;
+    ASSERT(std::abs(server.FindTopDocuments(std::string("cat"), all, bm25)[0].relevance
+        - idf_after * 2 * (bm25.k1 + 1) / (2 + bm25.k1 * (1 - bm25.b + bm25.b * 3 / length_after))) < EPSILON);
+}
+
+// Тест поиска по спискам вкладов и качества квантования
+void TestImpactIndex() {
+    std::mt19937 generator(42);
+    const auto random_word = [&generator]() {
+        // Частоты слов убывают с номером, как в естественном языке
+        const int index = static_cast<int>(std::pow(std::uniform_real_distribution<double>(0.0, 1.0)(generator), 2) * 60);
+        return std::string("w") + std::to_string(index);
+    };
+    SearchServer server(std::string("w0"));
+    for (int id = 0; id < 400; ++id) {
+        std::string text;
+        const int length = std::uniform_int_distribution<int>(1, 12)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += random_word() + ' ';
+        }
+        server.AddDocument(id, text, id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { id % 10 });
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 200; ++i) {
+        std::string query = random_word() + ' ' + random_word();
+        if (i % 2 == 0) {
+            query += ' ' + random_word();
+        }
+        if (i % 5 == 0) {
+            query += " -" + random_word();
+        }
+        queries.push_back(query);
+    }
+    const auto search_all = [&server, &queries]() {
+        std::vector<std::vector<Document>> results;
+        for (const std::string& query : queries) {
+            results.push_back(server.FindTopDocuments(query));
+            results.push_back(server.FindTopDocuments(std::execution::par, query, DocumentStatus::BANNED));
+        }
+        return results;
+    };
+    const auto exact = search_all();
+
+    // Релевантности совпадают с точностью до EPSILON, документы могут поменяться местами
+    // только при такой же разнице релевантностей. Последний документ выдачи может смениться
+    // документом за её пределами с той же релевантностью и рейтингом
+    const auto check_quality = [&exact](const std::vector<std::vector<Document>>& results) {
+        ASSERT_EQUAL(results.size(), exact.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            ASSERT_EQUAL(results[i].size(), exact[i].size());
+            for (size_t j = 0; j < results[i].size(); ++j) {
+                ASSERT(std::abs(results[i][j].relevance - exact[i][j].relevance) < EPSILON);
+                const bool is_tied = (j > 0 && exact[i][j - 1].relevance - exact[i][j].relevance < EPSILON)
+                    || (j + 1 < exact[i].size() && exact[i][j].relevance - exact[i][j + 1].relevance < EPSILON)
+                    || (j + 1 == MAX_RESULT_DOCUMENT_COUNT && results[i][j].rating == exact[i][j].rating);
+                ASSERT(is_tied || results[i][j].id == exact[i][j].id);
+            }
+        }
+    };
+    for (const int bits : { 16, 8, 2 }) {
+        server.BuildImpactIndex(bits);
+        ASSERT(server.HasImpactIndex());
+        ASSERT(server.GetMemoryUsage().impacts > 0);
+        check_quality(search_all());
+    }
+
+    // фразы и другие политики ранжирования читают обычный индекс
+    ASSERT(!server.FindTopDocuments(std::string("w1 w2"), [](int, DocumentStatus, int) { return true; },
+        Bm25Scorer()).empty());
+
+    // изменения индекса удаляют списки
+    server.AddDocument(1000, std::string("w1 w2"), DocumentStatus::ACTUAL, { 1 });
+    ASSERT(!server.HasImpactIndex());
+    ASSERT_EQUAL(server.GetMemoryUsage().impacts, 0);
+    server.BuildImpactIndex();
+    server.RemoveDocument(std::execution::par, 1000);
+    ASSERT(!server.HasImpactIndex());
+
+    try {
+        server.BuildImpactIndex(17);
+        ASSERT_HINT(false, "bits must be validated");
+    }
+    catch (const std::invalid_argument&) {
+    }
+    ASSERT(!server.HasImpactIndex());
+}
+
+// Тест потокобезопасной хеш-таблицы
+void TestConcurrentMap() {
+    // вставки и удаления сверяются с std::map, в том числе при длинных цепочках пробирования
+    {
+        ConcurrentMap<int, int> map(3);
+        std::map<int, int> expected;
+        std::mt19937 generator(7);
+        for (int i = 0; i < 20000; ++i) {
+            const int key = std::uniform_int_distribution<int>(0, 500)(generator);
+            if (generator() % 3 == 0) {
+                ASSERT_EQUAL(map.Erase(key), expected.erase(key));
+            }
+            else {
+                map[key].ref_to_value += i;
+                expected[key] += i;
+            }
+        }
+        ASSERT_EQUAL(map.GetSize(), expected.size());
+        ASSERT_EQUAL(map.BuildOrdinaryMap(), expected);
+        for (int key = 0; key <= 500; ++key) {
+            ASSERT_EQUAL(map.Contains(key), expected.count(key) > 0);
+        }
+    }
+
+    // строковые ключи, одновременные FetchAdd и разделяемые чтения
+    {
+        ConcurrentMap<std::string, long long, std::hash<std::string>, SharedLocking> map(8);
+        const int thread_count = 8;
+        const int iterations = 5000;
+        std::vector<std::future<void>> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.push_back(std::async(std::launch::async, [&map, t]() {
+                for (int i = 0; i < iterations; ++i) {
+                    map.FetchAdd("key" + std::to_string(i % 100), 1);
+                    map.Find("key" + std::to_string((i + t) % 100));
+                }
+            }));
+        }
+        for (auto& thread : threads) {
+            thread.get();
+        }
+        ASSERT_EQUAL(map.GetSize(), 100);
+        ASSERT_EQUAL(*map.Find("key7"), thread_count * iterations / 100);
+        ASSERT(!map.Find("missing"));
+        ASSERT_EQUAL(map.FetchAdd("key7", 5), thread_count * iterations / 100);
+        map.Update("key8", [](long long& value) { value = -1; });
+        ASSERT_EQUAL(*map.Find("key8"), -1);
+
+        std::atomic<long long> total = 0;
+        map.ForEach(std::execution::par, [&total](const std::string&, long long& value) { total += value; });
+        ASSERT_EQUAL(total.load(), thread_count * iterations + 5 - thread_count * iterations / 100 - 1);
+    }
+
+    // выгрузка без копии: порядок не зависит от политики, таблица пустеет
+    {
+        ConcurrentMap<int, double> sequential(5);
+        ConcurrentMap<int, double> parallel(5);
+        for (int key = 0; key < 1000; ++key) {
+            sequential[key].ref_to_value = key * 0.5;
+            parallel.FetchAdd(key, key * 0.5);
+        }
+        const auto to_pair = [](int key, double value) { return std::pair(key, value); };
+        const auto drained = sequential.Drain(std::execution::seq, to_pair);
+        ASSERT_EQUAL(drained.size(), 1000);
+        ASSERT(drained == parallel.Drain(std::execution::par, to_pair));
+        ASSERT_EQUAL(sequential.GetSize(), 0);
+        ASSERT(!parallel.Contains(10));
+        parallel[10].ref_to_value = 1.0;
+        ASSERT_EQUAL(parallel.GetSize(), 1);
+    }
+}
+
+// Тест поиска дубликатов при добавлении документа
+void TestDuplicatePolicies() {
+    const auto make_server = [](DuplicatePolicy policy) {
+        SearchServerOptions options;
+        options.duplicate_policy = policy;
+        return SearchServer(std::string("and"), options);
+    };
+    const auto ids = [](SearchServer& server) {
+        return std::set<int>(server.begin(), server.end());
+    };
+
+    // дубликат с большим id отклоняется, с меньшим - вытесняет документ из индекса
+    {
+        SearchServer server = make_server(DuplicatePolicy::REJECT);
+        server.AddDocument(1, std::string("cat dog"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(2, std::string("cat parrot"), DocumentStatus::ACTUAL, { 1 });
+        try {
+            server.AddDocument(3, std::string("dog and cat cat"), DocumentStatus::ACTUAL, { 1 });
+            ASSERT_HINT(false, "duplicates must be rejected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 1, 2 }));
+        server.AddDocument(0, std::string("dog cat"), DocumentStatus::ACTUAL, { 1 });
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 0, 2 }));
+        // удалённый документ больше не считается оригиналом
+        server.RemoveDocument(0);
+        server.AddDocument(4, std::string("dog cat"), DocumentStatus::ACTUAL, { 1 });
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 2, 4 }));
+    }
+
+    // помеченные дубликаты остаются в поиске
+    {
+        SearchServer server = make_server(DuplicatePolicy::FLAG);
+        server.AddDocument(1, std::string("cat dog"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(2, std::string("dog cat"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(3, std::string("cat dog dog"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(4, std::string("cat"), DocumentStatus::ACTUAL, { 1 });
+        ASSERT_EQUAL(server.FindTopDocuments(std::string("cat")).size(), 4);
+        ASSERT(!server.GetDuplicateOf(1));
+        ASSERT_EQUAL(*server.GetDuplicateOf(2), 1);
+        ASSERT_EQUAL(*server.GetDuplicateOf(3), 1);
+        ASSERT(!server.GetDuplicateOf(4));
+        server.RemoveDocument(std::execution::par, 1);
+        ASSERT(!server.GetDuplicateOf(2));
+        ASSERT_EQUAL(*server.GetDuplicateOf(3), 2);
+
+        // отпечатки восстанавливаются из снимка
+        std::stringstream stream;
+        WriteSnapshot(server, stream);
+        SearchServerOptions options;
+        options.duplicate_policy = DuplicatePolicy::FLAG;
+        const SearchServer restored = ReadSnapshot(stream, options);
+        ASSERT_EQUAL(*restored.GetDuplicateOf(3), 2);
+    }
+
+    // новый документ заменяет старый под меньшим id
+    {
+        SearchServer server = make_server(DuplicatePolicy::SUPERSEDE);
+        ASSERT_EQUAL(server.AddDocument(1, std::string("cat dog"), DocumentStatus::ACTUAL, { 1 }), 1);
+        // id, под которым сохранён документ, возвращается вызывающему
+        ASSERT_EQUAL(server.AddDocument(5, std::string("dog cat"), DocumentStatus::ACTUAL, { 9 }), 1);
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 1 }));
+        ASSERT_EQUAL(server.FindTopDocuments(std::string("cat"))[0].rating, 9);
+        ASSERT_EQUAL(server.AddDocument(0, std::string("cat dog"), DocumentStatus::BANNED, { 3 }), 0);
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 0 }));
+        ASSERT_EQUAL(server.FindTopDocuments(std::string("cat"), DocumentStatus::BANNED)[0].rating, 3);
+        ASSERT(!server.GetDuplicateOf(0));
+    }
+
+    // при любом порядке добавления в индексе остаётся документ с наименьшим id, как после RemoveDuplicates
+    {
+        std::mt19937 generator(3);
+        std::vector<int> order(300);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), generator);
+        std::vector<std::string> texts(order.size());
+        std::map<std::set<std::string>, int> originals;
+        for (size_t id = 0; id < texts.size(); ++id) {
+            std::set<std::string> words;
+            for (int i = 0; i < 3; ++i) {
+                const std::string word = std::string("w") + std::to_string(generator() % 6);
+                texts[id] += word + ' ';
+                words.insert(word);
+            }
+            originals.emplace(words, static_cast<int>(id));
+        }
+        std::set<int> expected;
+        for (const auto& [words, id] : originals) {
+            expected.insert(id);
+        }
+        SearchServer rejecting = make_server(DuplicatePolicy::REJECT);
+        SearchServer superseding = make_server(DuplicatePolicy::SUPERSEDE);
+        for (const int id : order) {
+            try {
+                rejecting.AddDocument(id, texts[id], DocumentStatus::ACTUAL, { 1 });
+            }
+            catch (const std::invalid_argument&) {
+            }
+            superseding.AddDocument(id, texts[id], DocumentStatus::ACTUAL, { 1 });
+        }
+        ASSERT_EQUAL(ids(rejecting), expected);
+        ASSERT_EQUAL(ids(superseding), expected);
+    }
+}
+
+// Тест поиска близких дубликатов: найденные пары проверены точным сходством
+void TestNearDuplicates() {
+    const auto ids = [](SearchServer& server) {
+        return std::set<int>(server.begin(), server.end());
+    };
+    const auto pairs = [](const std::vector<NearDuplicatePair>& found) {
+        std::vector<std::pair<int, int>> result;
+        for (const auto& pair : found) {
+            result.emplace_back(pair.first_id, pair.second_id);
+        }
+        return result;
+    };
+
+    {
+        SearchServer server(std::string("and"));
+        server.AddDocument(1, std::string("a b c d e f g h i j"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(2, std::string("a b c d e f g h i k and"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(3, std::string("p q r s t u v w x y"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(5, std::string("a b c d e f g h k l"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(7, std::string("and"), DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(8, std::string("and and"), DocumentStatus::ACTUAL, { 1 });
+
+        const auto found = FindNearDuplicates(server);
+        // пустые наборы слов совпадают, как в RemoveDuplicates
+        ASSERT_EQUAL(pairs(found), (std::vector<std::pair<int, int>>{ { 1, 2 }, { 2, 5 }, { 7, 8 } }));
+        ASSERT(std::abs(found[0].similarity - 9.0 / 11.0) < EPSILON);
+        ASSERT_EQUAL(found[2].similarity, 1.0);
+
+        NearDuplicateOptions options;
+        options.threshold = 0.9;
+        ASSERT_EQUAL(pairs(FindNearDuplicates(server, options)), (std::vector<std::pair<int, int>>{ { 7, 8 } }));
+        options.threshold = 0.6;
+        ASSERT_EQUAL(pairs(FindNearDuplicates(std::execution::par, server, options)),
+            (std::vector<std::pair<int, int>>{ { 1, 2 }, { 1, 5 }, { 2, 5 }, { 7, 8 } }));
+        options.threshold = 0.0;
+        try {
+            FindNearDuplicates(server, options);
+            ASSERT_HINT(false, "threshold must be positive");
+        }
+        catch (const std::invalid_argument&) {
+        }
+
+        // 5 близок только к удаляемому 2, поэтому остаётся
+        RemoveNearDuplicates(server);
+        ASSERT_EQUAL(ids(server), (std::set<int>{ 1, 3, 5, 7 }));
+    }
+
+    // копии с одним заменённым словом (сходство 19/21) находятся почти все, лишних пар нет
+    {
+        std::mt19937 generator(11);
+        const auto random_word = [&generator] {
+            return std::string("w") + std::to_string(generator() % 5000);
+        };
+        SearchServer server(std::string("and"));
+        std::set<std::pair<int, int>> planted;
+        for (int id = 0; id < 400; id += 2) {
+            std::vector<std::string> words;
+            while (words.size() < 20) {
+                const std::string word = random_word();
+                if (std::find(words.begin(), words.end(), word) == words.end()) {
+                    words.push_back(word);
+                }
+            }
+            std::string text;
+            for (const auto& word : words) {
+                text += word + ' ';
+            }
+            server.AddDocument(id, text, DocumentStatus::ACTUAL, { 1 });
+            words[generator() % words.size()] = std::string("x") + std::to_string(id);
+            text.clear();
+            for (const auto& word : words) {
+                text += word + ' ';
+            }
+            server.AddDocument(id + 1, text, DocumentStatus::ACTUAL, { 1 });
+            planted.emplace(id, id + 1);
+        }
+
+        NearDuplicateStats stats;
+        const auto found = FindNearDuplicates(std::execution::seq, server, {}, &stats);
+        ASSERT_EQUAL(pairs(found), pairs(FindNearDuplicates(std::execution::par, server)));
+        ASSERT(stats.bands * stats.rows <= NearDuplicateOptions().hash_count);
+        ASSERT(stats.candidate_pairs >= found.size());
+        size_t recalled = 0;
+        for (const auto& pair : found) {
+            ASSERT(pair.first_id < pair.second_id);
+            ASSERT(pair.similarity >= NearDuplicateOptions().threshold);
+            recalled += planted.count({ pair.first_id, pair.second_id });
+        }
+        ASSERT_EQUAL(recalled, found.size());
+        ASSERT(recalled * 100 >= planted.size() * 95);
+    }
+}
+
+// Тест демона: ответы конвейера приходят по порядку и совпадают с FindTopDocuments
+void TestQueryDaemon() {
+    SearchServer server(std::string("and in"));
+    server.AddDocument(1, std::string("white cat and fancy collar"), DocumentStatus::ACTUAL, { 8, -3 });
+    server.AddDocument(2, std::string("fluffy cat fluffy tail"), DocumentStatus::ACTUAL, { 7, 2, 7 });
+    server.AddDocument(3, std::string("groomed dog expressive eyes"), DocumentStatus::BANNED, { 5, -12, 2, 1 });
+    const auto same = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        ASSERT_EQUAL(lhs.size(), rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            ASSERT_EQUAL(lhs[i].id, rhs[i].id);
+            ASSERT_EQUAL(lhs[i].relevance, rhs[i].relevance);
+            ASSERT_EQUAL(lhs[i].rating, rhs[i].rating);
+        }
+    };
+
+    const std::vector<std::pair<std::string, DocumentStatus>> queries = {
+        { std::string("fluffy cat"), DocumentStatus::ACTUAL },
+        { std::string("cat -collar"), DocumentStatus::ACTUAL },
+        { std::string("dog"), DocumentStatus::BANNED },
+        { std::string("cat --collar"), DocumentStatus::ACTUAL },
+        { std::string("parrot"), DocumentStatus::ACTUAL },
+    };
+    const auto check_pipeline = [&](QueryClient& client, uint32_t first_id) {
+        for (uint32_t i = 0; i < 20; ++i) {
+            DaemonRequest request;
+            request.request_id = first_id + i;
+            request.query = queries[i % queries.size()].first;
+            request.status = queries[i % queries.size()].second;
+            client.Send(request);
+        }
+        for (uint32_t i = 0; i < 20; ++i) {
+            const DaemonResponse response = client.Receive();
+            ASSERT_EQUAL(response.request_id, first_id + i);
+            const auto& [query, status] = queries[i % queries.size()];
+            if (query == std::string("cat --collar")) {
+                ASSERT(response.code == DaemonResponseCode::INVALID_QUERY);
+                ASSERT(!response.message.empty());
+            }
+            else {
+                ASSERT(response.code == DaemonResponseCode::OK);
+                same(response.documents, server.FindTopDocuments(query, status));
+            }
+        }
+    };
+
+    const auto socket_path = std::filesystem::temp_directory_path() / (std::string("search_server_test_")
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + std::string(".sock"));
+    const std::string endpoint = std::string("unix:") + socket_path.string();
+    QueryDaemonOptions options;
+    options.max_batch_size = 8;
+    options.batch_delay = std::chrono::milliseconds(1);
+    {
+        QueryDaemon daemon(server, endpoint, options);
+        std::thread runner([&daemon] { daemon.Run(); });
+
+        // несколько соединений с конвейером запросов
+        std::vector<std::thread> clients;
+        std::atomic<int> finished = 0;
+        for (uint32_t c = 0; c < 3; ++c) {
+            clients.emplace_back([&, c] {
+                QueryClient client(endpoint);
+                check_pipeline(client, c * 1000);
+                check_pipeline(client, c * 1000 + 100);
+                ++finished;
+            });
+        }
+        for (std::thread& client : clients) {
+            client.join();
+        }
+        ASSERT_EQUAL(finished.load(), 3);
+
+        // неразобранный кадр получает ответ BAD_REQUEST, соединение продолжает работать
+        {
+            Socket socket = ConnectTo(endpoint);
+            std::string frame;
+            BinaryWriter writer(frame);
+            writer.WriteUint32(6);
+            writer.WriteUint32(77);
+            writer.WriteUint8(42);
+            writer.WriteUint8(0);
+            socket.SendAll(frame);
+            FrameReader reader(socket, DEFAULT_MAX_FRAME_SIZE);
+            std::string_view payload;
+            ASSERT(reader.ReadFrame(payload));
+            const DaemonResponse response = ParseDaemonResponse(payload);
+            ASSERT_EQUAL(response.request_id, 77u);
+            ASSERT(response.code == DaemonResponseCode::BAD_REQUEST);
+
+            std::string request;
+            AppendRequestFrame(request, DaemonRequest{ 78, DaemonRequestType::FIND_TOP_DOCUMENTS,
+                DocumentStatus::ACTUAL, std::string("cat") });
+            socket.SendAll(request);
+            ASSERT(reader.ReadFrame(payload));
+            same(ParseDaemonResponse(payload).documents, server.FindTopDocuments(std::string("cat")));
+        }
+
+        daemon.Stop();
+        runner.join();
+        const QueryDaemonStats stats = daemon.GetStats();
+        ASSERT_EQUAL(stats.connections, 4u);
+        ASSERT_EQUAL(stats.requests, 3u * 40u + 2u);
+        ASSERT_EQUAL(stats.failed_requests, 3u * 8u + 1u);
+        ASSERT(stats.batches > 0 && stats.batches <= stats.requests);
+    }
+    ASSERT(!std::filesystem::exists(socket_path));
+
+    // клиент, который шлёт запросы и не читает ответы, не задерживает остальных: его соединение закрывается
+    {
+        QueryDaemonOptions stalled_options = options;
+        stalled_options.max_output_bytes = 4096;
+        QueryDaemon daemon(server, endpoint, stalled_options);
+        std::thread runner([&daemon] { daemon.Run(); });
+        Socket stalled = ConnectTo(endpoint);
+        std::string requests;
+        for (uint32_t i = 0; i < 20000; ++i) {
+            AppendRequestFrame(requests, DaemonRequest{ i, DaemonRequestType::FIND_TOP_DOCUMENTS,
+                DocumentStatus::ACTUAL, std::string("cat") });
+        }
+        try {
+            stalled.SendAll(requests);
+        }
+        catch (const std::runtime_error&) {
+            // демон закрыл соединение, не дочитав запросы
+        }
+        QueryClient client(endpoint);
+        check_pipeline(client, 0);
+        for (int i = 0; i < 1000 && daemon.GetStats().dropped_connections == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ASSERT_EQUAL(daemon.GetStats().dropped_connections, 1u);
+        daemon.Stop();
+        runner.join();
+    }
+
+    // TCP с портом, выбранным системой
+    {
+        QueryDaemon daemon(server, std::string("tcp:127.0.0.1:0"), options);
+        ASSERT(daemon.GetPort() != 0);
+        std::thread runner([&daemon] { daemon.Run(); });
+        {
+            QueryClient client(std::string("tcp:127.0.0.1:") + std::to_string(daemon.GetPort()));
+            check_pipeline(client, 0);
+        }
+        daemon.Stop();
+        runner.join();
+    }
+
+    try {
+        QueryDaemon daemon(server, std::string("pipe:/tmp/x"));
+        ASSERT_HINT(false, "unknown endpoint scheme must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+}
+
+// Тест загрузки корпуса: части разбираются параллельно, документы добавляются в порядке строк
+void TestCorpusLoader() {
+    const std::vector<std::string> texts = {
+        std::string("white cat and fancy collar"),
+        std::string("fluffy cat fluffy tail"),
+        std::string("groomed dog expressive eyes"),
+        std::string("groomed starling evgeny"),
+    };
+    const std::vector<DocumentStatus> statuses = { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT,
+        DocumentStatus::BANNED, DocumentStatus::ACTUAL };
+    const std::vector<std::vector<int>> ratings = { { 8, -3 }, { 7, 2, 7 }, {}, { 9 } };
+    SearchServer expected(std::string("and in"));
+    std::string corpus = std::string("# id, status, ratings, text\n\n");
+    for (size_t i = 0; i < texts.size(); ++i) {
+        expected.AddDocument(static_cast<int>(i) * 10, texts[i], statuses[i], ratings[i]);
+        AppendCorpusLine(corpus, static_cast<int>(i) * 10, statuses[i], ratings[i], texts[i]);
+    }
+    // строка Windows
+    corpus += std::string("40\tREMOVED\t-1  2\tcat tail\r\n");
+    expected.AddDocument(40, std::string("cat tail"), DocumentStatus::REMOVED, { -1, 2 });
+
+    const auto same_index = [&expected](SearchServer& server) {
+        ASSERT_EQUAL(server.GetDocumentCount(), expected.GetDocumentCount());
+        for (const std::string& query : { std::string("cat"), std::string("groomed tail"), std::string("eyes") }) {
+            for (const auto status : { DocumentStatus::ACTUAL, DocumentStatus::IRRELEVANT, DocumentStatus::BANNED,
+                DocumentStatus::REMOVED }) {
+                const auto lhs = server.FindTopDocuments(query, status);
+                const auto rhs = expected.FindTopDocuments(query, status);
+                ASSERT_EQUAL(lhs.size(), rhs.size());
+                for (size_t i = 0; i < lhs.size(); ++i) {
+                    ASSERT_EQUAL(lhs[i].id, rhs[i].id);
+                    ASSERT_EQUAL(lhs[i].rating, rhs[i].rating);
+                    ASSERT(std::abs(lhs[i].relevance - rhs[i].relevance) < EPSILON);
+                }
+            }
+        }
+    };
+
+    // части из одной строки и по несколько строк
+    for (const size_t chunk_size : { size_t(1), size_t(40), size_t(1) << 20 }) {
+        CorpusLoadOptions options;
+        options.chunk_size = chunk_size;
+        options.parallel_chunks = 2;
+        SearchServer server(std::string("and in"));
+        const CorpusLoadStats stats = LoadCorpus(server, corpus, options);
+        ASSERT_EQUAL(stats.documents, 5u);
+        ASSERT_EQUAL(stats.skipped, 0u);
+        ASSERT_EQUAL(stats.bytes, corpus.size());
+        same_index(server);
+    }
+
+    // ошибка указывает номер строки, предыдущие документы остаются
+    const std::string broken = corpus.substr(0, corpus.find(std::string("20\t"))) + std::string("25\tDELETED\t1\tcat\n")
+        + std::string("10\tACTUAL\t1\tduplicate id\n") + std::string("30\tACTUAL\t1\tparrot\n");
+    {
+        SearchServer server(std::string("and in"));
+        CorpusLoadOptions options;
+        options.chunk_size = 1;
+        try {
+            LoadCorpus(server, broken, options);
+            ASSERT_HINT(false, "unknown status must be rejected");
+        }
+        catch (const std::invalid_argument& e) {
+            ASSERT(std::string(e.what()).find(std::string("line 5")) != std::string::npos);
+        }
+        ASSERT_EQUAL(server.GetDocumentCount(), 2);
+    }
+    {
+        SearchServer server(std::string("and in"));
+        CorpusLoadOptions options;
+        options.skip_invalid_documents = true;
+        const CorpusLoadStats stats = LoadCorpus(server, broken, options);
+        ASSERT_EQUAL(stats.documents, 3u);
+        ASSERT_EQUAL(stats.skipped, 2u);
+    }
+
+    const auto path = std::filesystem::temp_directory_path() / (std::string("search_server_test_")
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + std::string(".tsv"));
+    {
+        std::ofstream(path, std::ios::binary) << corpus;
+        SearchServer server(std::string("and in"));
+        ASSERT_EQUAL(LoadCorpusFile(server, path.string()).documents, 5u);
+        same_index(server);
+        std::ofstream(path, std::ios::binary | std::ios::trunc);
+        ASSERT_EQUAL(LoadCorpusFile(server, path.string()).documents, 0u);
+    }
+    std::filesystem::remove(path);
+    try {
+        SearchServer server(std::string("and in"));
+        LoadCorpusFile(server, path.string());
+        ASSERT_HINT(false, "missing file must be reported");
+    }
+    catch (const std::runtime_error&) {
+    }
+    try {
+        std::string line;
+        AppendCorpusLine(line, 1, DocumentStatus::ACTUAL, {}, std::string("two\nlines"));
+        ASSERT_HINT(false, "line breaks must be rejected");
+    }
+    catch (const std::invalid_argument&) {
+    }
+}
+
+// Тест топологии NUMA: узлы читаются из поддельного sysfs, копии индекса отвечают как исходный сервер
+void TestNumaSearchServer() {
+    ASSERT_EQUAL(ParseCpuList(std::string("0-3,8,10-11\n")), (std::vector<int>{ 0, 1, 2, 3, 8, 10, 11 }));
+    ASSERT_EQUAL(ParseCpuList(std::string("")), std::vector<int>{});
+    for (const std::string& invalid : { std::string("3-1"), std::string("1,,2"), std::string("a") }) {
+        try {
+            ParseCpuList(invalid);
+            ASSERT_HINT(false, "invalid CPU list must be rejected");
+        }
+        catch (const std::invalid_argument&) {
+        }
+    }
+
+    // без sysfs - один узел со всеми доступными процессорами
+    const auto fallback = ReadNumaTopology(std::string("/nonexistent"));
+    ASSERT_EQUAL(fallback.size(), 1u);
+    ASSERT(!fallback[0].cpus.empty());
+    const int cpu = fallback[0].cpus[0];
+
+    const auto root = std::filesystem::temp_directory_path() / (std::string("search_server_test_")
+        + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    const auto write_node = [&root](const std::string& name, const std::string& cpulist) {
+        std::filesystem::create_directories(root / name);
+        std::ofstream(root / name / "cpulist") << cpulist << '\n';
+    };
+    write_node(std::string("node1"), std::to_string(cpu));
+    write_node(std::string("node0"), std::to_string(cpu));
+    // узел только с памятью и узел вне маски процесса пропускаются
+    write_node(std::string("node2"), std::string(""));
+    write_node(std::string("node3"), std::string("100000"));
+    std::ofstream(root / "possible") << "0-3\n";
+    const auto topology = ReadNumaTopology(root.string());
+    std::filesystem::remove_all(root);
+    ASSERT_EQUAL(topology.size(), 2u);
+    ASSERT_EQUAL(topology[0].id, 0);
+    ASSERT_EQUAL(topology[1].id, 1);
+    ASSERT_EQUAL(topology[1].cpus, std::vector<int>{ cpu });
+
+    // копии получают настройки исходного сервера: без позиций и шаблонов они отвергли бы часть запросов
+    SearchServerOptions server_options;
+    server_options.store_positions = true;
+    server_options.max_term_expansion = 4;
+    SearchServer server(std::string("and in"), server_options);
+    for (int id = 0; id < 50; ++id) {
+        server.AddDocument(id, std::string("cat w") + std::to_string(id % 7) + std::string(" dog w")
+            + std::to_string(id % 3), DocumentStatus::ACTUAL, { id });
+    }
+    server.BuildImpactIndex(8);
+    ASSERT_EQUAL(server.GetOptions().max_term_expansion, 4u);
+    ASSERT_EQUAL(server.GetImpactIndexBits(), 8);
+    std::vector<std::string> queries;
+    for (int i = 0; i < 30; ++i) {
+        queries.push_back(std::string("w") + std::to_string(i % 7) + std::string(" -w") + std::to_string(i % 3));
+    }
+    queries.push_back(std::string("\"cat w1\" dog"));
+    queries.push_back(std::string("w* -w2"));
+    const auto same = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        ASSERT_EQUAL(lhs.size(), rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            ASSERT_EQUAL(lhs[i].id, rhs[i].id);
+            ASSERT(std::abs(lhs[i].relevance - rhs[i].relevance) < EPSILON);
+        }
+    };
+    for (const bool replicate : { true, false }) {
+        NumaSearchOptions options;
+        options.replicate = replicate;
+        options.topology = topology;
+        options.threads_per_node = 2;
+        const NumaSearchServer numa(server, options);
+        ASSERT_EQUAL(numa.GetNodeCount(), 2u);
+        ASSERT_EQUAL(numa.GetReplicaCount(), replicate ? 2u : 0u);
+        const auto results = numa.ProcessQueries(queries);
+        ASSERT_EQUAL(results.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            same(results[i], server.FindTopDocuments(queries[i]));
+        }
+        same(numa.FindTopDocuments(queries[0]).get(), server.FindTopDocuments(queries[0]));
+        same(numa.FindTopDocuments(queries[1]).get(), server.FindTopDocuments(queries[1]));
+    }
+
+    // один узел - копия не нужна
+    NumaSearchOptions options;
+    options.topology = fallback;
+    options.max_nodes = 1;
+    const NumaSearchServer single(server, options);
+    ASSERT_EQUAL(single.GetReplicaCount(), 0u);
+    same(single.ProcessQueries(queries)[5], server.FindTopDocuments(queries[5]));
+}
+
+// Тест последовательного поиска по окнам документов: выдача совпадает с параллельным поиском
+void TestWindowScoring() {
+    SearchServer server(std::string("and with"));
+    const std::vector<std::string> words = { "cat", "dog", "bird", "fox", "and", "with", "owl", "eel" };
+    std::mt19937 generator(7);
+    // идентификаторы с разрывами больше окна: окна начинаются с наименьшего непрочитанного документа
+    int id = 0;
+    for (int i = 0; i < 600; ++i) {
+        id += i % 97 == 0 ? 5000 : 1 + static_cast<int>(generator() % 7);
+        std::string text;
+        const int length = 1 + static_cast<int>(generator() % 6);
+        for (int j = 0; j < length; ++j) {
+            text += words[generator() % words.size()] + " ";
+        }
+        const DocumentStatus status = i % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        server.AddDocument(id, text, status, { static_cast<int>(generator() % 10) - 3 });
+    }
+    // порядок документов с равными релевантностью и рейтингом не определён: сравниваются позиции выдачи
+    const auto same = [](const std::vector<Document>& lhs, const std::vector<Document>& rhs) {
+        ASSERT_EQUAL(lhs.size(), rhs.size());
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            ASSERT_EQUAL(lhs[i].rating, rhs[i].rating);
+            ASSERT(std::abs(lhs[i].relevance - rhs[i].relevance) < EPSILON);
+        }
+    };
+    const auto by_id = [](SearchCursor& cursor) {
+        std::map<int, double> relevance;
+        for (const Document& document : cursor.GetPage(0)) {
+            relevance[document.id] = document.relevance;
+        }
+        return relevance;
+    };
+    const auto positive = [](int, DocumentStatus status, int rating) {
+        return status == DocumentStatus::ACTUAL && rating > 0;
+    };
+    const std::vector<std::string> queries = { "cat", "cat dog -fox", "owl eel bird -cat -dog", "fox with", "-cat" };
+    for (const std::string& query : queries) {
+        // все совпадения, а не только первые MAX_RESULT_DOCUMENT_COUNT
+        auto sequential = server.OpenCursor(std::execution::seq, query, positive, 1000);
+        auto parallel = server.OpenCursor(std::execution::par, query, positive, 1000);
+        ASSERT_EQUAL(sequential.GetResultCount(), parallel.GetResultCount());
+        const auto sequential_matches = by_id(sequential);
+        const auto parallel_matches = by_id(parallel);
+        ASSERT_EQUAL(sequential_matches.size(), parallel_matches.size());
+        for (const auto& [document_id, relevance] : sequential_matches) {
+            ASSERT(parallel_matches.count(document_id));
+            ASSERT(std::abs(parallel_matches.at(document_id) - relevance) < EPSILON);
+        }
+
+        QueryStats sequential_stats;
+        QueryStats parallel_stats;
+        same(server.FindTopDocuments(std::execution::seq, query, positive, sequential_stats),
+            server.FindTopDocuments(std::execution::par, query, positive, parallel_stats));
+        ASSERT_EQUAL(sequential_stats.postings_scanned, parallel_stats.postings_scanned);
+        ASSERT_EQUAL(sequential_stats.candidates_created, parallel_stats.candidates_created);
+        ASSERT_EQUAL(sequential_stats.rejected_by_predicate, parallel_stats.rejected_by_predicate);
+        ASSERT_EQUAL(sequential_stats.rejected_by_minus_words, parallel_stats.rejected_by_minus_words);
+        ASSERT_EQUAL(sequential_stats.documents_returned, parallel_stats.documents_returned);
+    }
+    ASSERT_EQUAL(server.OpenCursor(std::execution::seq, std::string("-cat"), positive, 10).GetResultCount(), 0u);
+
+    // BM25 и своя политика ранжирования, которая не обнуляет отсутствующие слова
+    const Bm25Scorer bm25;
+    same(server.FindTopDocuments(std::execution::seq, std::string("cat owl -dog"), positive, bm25),
+        server.FindTopDocuments(std::execution::par, std::string("cat owl -dog"), positive, bm25));
+    struct LengthScorer {
+        double Score(const TermScoringContext&, uint32_t term_count, uint32_t document_length) const {
+            return term_count + 1.0 / document_length;
+        }
+    };
+    same(server.FindTopDocuments(std::execution::seq, std::string("bird eel"), positive, LengthScorer()),
+        server.FindTopDocuments(std::execution::par, std::string("bird eel"), positive, LengthScorer()));
+
+    // удалённые документы не попадают в окна
+    const auto before = server.FindTopDocuments(std::string("cat"), positive);
+    ASSERT(!before.empty());
+    server.RemoveDocument(before[0].id);
+    for (const Document& document : server.FindTopDocuments(std::string("cat"), positive)) {
+        ASSERT(document.id != before[0].id);
+    }
+}
+
+// Тест кеша частых слов: срезы дают ту же выдачу, что и списки документов, и обновляются вместе с индексом
+void TestHotTermCache() {
+    SearchServerOptions options;
+    options.hot_terms.capacity = 1 << 20;
+    options.hot_terms.min_postings = 4;
+    options.hot_terms.admission_count = 2;
+    SearchServer cached(std::string("and"), options);
+    SearchServer plain(std::string("and"));
+    const std::vector<std::string> words = { "cat", "dog", "bird", "and", "fox" };
+    std::mt19937 generator(11);
+    const auto add = [&](int document_id, const std::string& text, DocumentStatus status, int rating) {
+        cached.AddDocument(document_id, text, status, { rating });
+        plain.AddDocument(document_id, text, status, { rating });
+    };
+    for (int id = 0; id < 3000; id += 1 + static_cast<int>(generator() % 3)) {
+        std::string text;
+        for (size_t j = 0; j < 1 + generator() % 4; ++j) {
+            text += words[generator() % words.size()] + " ";
+        }
+        add(id, text, id % 4 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, static_cast<int>(generator() % 9));
+    }
+    const auto same = [&](const std::string& query, DocumentStatus status) {
+        for (const bool parallel : { false, true }) {
+            auto expected = parallel ? plain.OpenCursor(std::execution::par, query, StatusPredicate{ status }, 10000)
+                : plain.OpenCursor(query, status, 10000);
+            auto actual = parallel ? cached.OpenCursor(std::execution::par, query, StatusPredicate{ status }, 10000)
+                : cached.OpenCursor(query, status, 10000);
+            std::map<int, std::pair<double, int>> expected_documents;
+            for (const Document& document : expected.GetPage(0)) {
+                expected_documents[document.id] = { document.relevance, document.rating };
+            }
+            ASSERT_EQUAL(actual.GetResultCount(), expected_documents.size());
+            for (const Document& document : actual.GetPage(0)) {
+                ASSERT(expected_documents.count(document.id));
+                ASSERT(std::abs(expected_documents.at(document.id).first - document.relevance) < EPSILON);
+                ASSERT_EQUAL(expected_documents.at(document.id).second, document.rating);
+            }
+        }
+    };
+
+    // первый запрос только считается, второй строит срезы, дальше срезы читаются
+    same("cat dog -fox", DocumentStatus::ACTUAL);
+    ASSERT_EQUAL(cached.GetHotTermCacheStats().admissions, 2u);
+    QueryStats stats;
+    cached.FindTopDocuments(std::string("cat dog -fox"), StatusPredicate{ DocumentStatus::ACTUAL }, stats);
+    ASSERT_EQUAL(stats.cached_terms, 2u);
+    ASSERT_EQUAL(stats.rejected_by_predicate, 0u);
+    same("cat bird", DocumentStatus::ACTUAL);
+    same("cat", DocumentStatus::BANNED);
+    HotTermCacheStats cache_stats = cached.GetHotTermCacheStats();
+    ASSERT(cache_stats.hits > 0);
+    ASSERT(cache_stats.GetHitRate() > 0.0);
+    // срезы берут память из ресурса сервера; пул удерживает не меньше, чем занимают срезы
+    ASSERT(cached.GetMemoryUsage().caches >= cache_stats.memory);
+
+    // запросы из нескольких потоков одновременно читают и строят срезы разных слов
+    {
+        const std::vector<std::string> concurrent_queries = { "cat dog", "bird", "fox -owl", "cat" };
+        std::vector<std::vector<Document>> expected_results;
+        for (const std::string& query : concurrent_queries) {
+            expected_results.push_back(plain.FindTopDocuments(query, DocumentStatus::BANNED));
+        }
+        std::atomic<int> mismatches = 0;
+        std::vector<std::thread> searchers;
+        for (int t = 0; t < 4; ++t) {
+            searchers.emplace_back([&, t] {
+                for (int i = 0; i < 100; ++i) {
+                    const size_t query = static_cast<size_t>(t + i) % concurrent_queries.size();
+                    const auto found = cached.FindTopDocuments(concurrent_queries[query], DocumentStatus::BANNED);
+                    if (found.size() != expected_results[query].size()) {
+                        ++mismatches;
+                    }
+                }
+            });
+        }
+        for (std::thread& searcher : searchers) {
+            searcher.join();
+        }
+        ASSERT_EQUAL(mismatches.load(), 0);
+        cache_stats = cached.GetHotTermCacheStats();
+    }
+
+    // произвольный предикат кеш не читает
+    const auto actual_only = [](int, DocumentStatus status, int) { return status == DocumentStatus::ACTUAL; };
+    cached.FindTopDocuments(std::string("cat"), actual_only, stats);
+    ASSERT_EQUAL(stats.cached_terms, 0u);
+    ASSERT_EQUAL(cached.GetHotTermCacheStats().hits, cache_stats.hits);
+
+    // срезы меняются вместе с индексом: документы добавляются в конец и в середину срезов и удаляются
+    add(5000, "cat cat dog", DocumentStatus::ACTUAL, 100);
+    add(3001, "cat fox", DocumentStatus::ACTUAL, 7);
+    add(3002, "cat", DocumentStatus::BANNED, 7);
+    const int removed_id = *std::next(cached.begin(), 5);
+    cached.RemoveDocument(0);
+    plain.RemoveDocument(0);
+    cached.RemoveDocument(std::execution::par, removed_id);
+    plain.RemoveDocument(std::execution::par, removed_id);
+    ASSERT(cached.GetHotTermCacheStats().updates > cache_stats.updates);
+    ASSERT_EQUAL(cached.GetHotTermCacheStats().admissions, cache_stats.admissions);
+    same("cat dog -fox", DocumentStatus::ACTUAL);
+    same("cat bird", DocumentStatus::ACTUAL);
+    same("cat", DocumentStatus::BANNED);
+    auto with_new = cached.OpenCursor(std::string("cat dog"), 10000);
+    const auto new_page = with_new.GetPage(0);
+    ASSERT(std::any_of(new_page.begin(), new_page.end(), [](const Document& document) { return document.id == 5000; }));
+
+    // при нехватке памяти вытесняются срезы слов с меньшим числом запросов
+    options.hot_terms.capacity = 24 * 1024;
+    SearchServer small(std::string("and"), options);
+    for (int id = 0; id < 1000; ++id) {
+        small.AddDocument(id, words[id % words.size()] + " " + words[(id / 2) % words.size()],
+            DocumentStatus::ACTUAL, { 1 });
+    }
+    for (int i = 0; i < 3; ++i) {
+        small.FindTopDocuments(std::string("cat"));
+        small.FindTopDocuments(std::string("dog"));
+        small.FindTopDocuments(std::string("bird fox"));
+    }
+    cache_stats = small.GetHotTermCacheStats();
+    ASSERT(cache_stats.evictions > 0);
+    ASSERT(cache_stats.memory <= options.hot_terms.capacity);
+    ASSERT(small.GetMemoryUsage().caches >= cache_stats.memory);
+    ASSERT_EQUAL(SearchServer(std::string("and")).GetHotTermCacheStats().slices, 0u);
+}
+
+// Функция TestSearchServer является точкой входа для запуска тестов
+void TestSearchServer() {
+    TestExcludeStopWordsFromAddedDocumentContent();
+    TestExcludeMinusWordsFromQuery();
+    TestMatchDocuments();
+    TestSortingByRelevance();
+    TestCalculatingRelevance();
+    TestCalculatingRating();
+    TestFilterByPredicate();
+    TestFilterByStatus();
+    TestFindTopDocumentsAsync();
+    TestQueryBudget();
+    TestConcurrencyLimit();
+    TestMetrics();
+    TestQueryStats();
+    TestMatchDocumentsBatch();
+    TestSearchCursor();
+    TestMemoryResource();
+    TestMemoryUsage();
+    TestPersistence();
+    TestStopWordSet();
+    TestTokenizer();
+    TestWildcardQuery();
+    TestPhraseQuery();
+    TestScoringPolicies();
+    TestImpactIndex();
+    TestConcurrentMap();
+    TestDuplicatePolicies();
+    TestNearDuplicates();
+    TestQueryDaemon();
+    TestCorpusLoader();
+    TestNumaSearchServer();
+    TestWindowScoring();
+    TestHotTermCache();
 }
\ No newline at end of file
@@ -1,38 +1,109 @@
-#pragma once
-#include <vector>
-
-
-// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
-void TestExcludeStopWordsFromAddedDocumentContent();
-
-// Тест проверяет, что поисковая система исключает минус-слова из поискового запроса
-void TestExcludeMinusWordsFromQuery();
-
-// Тест на проверку сопоставления содержимого документа и поискового запроса
-
-void TestMatchDocuments();
-
-
-// Тест на сортировку по релевантности найденых документов
-void TestSortingByRelevance();
-// Тест на правильность вычесления релевантности
-void TestCalculatingRelevance();
-
-/// <summary>
-/// вычисление среднего ариметического оценок докумета
-/// </summary>
-/// <param name="rating"> вектор оценок</param>
-/// <returns>среднего ариметического оценок докумета</returns>
-int ArithmeticMeanOfTheRating(std::vector<int> rating);
-
-// Тест на правильность вычесления рейтинга 
-void TestCalculatingRating();
-
-// Тест на фильтрацию результата с использованием предиката
-void TestFilterByPredicate();
-
-// Тест на фильтрацию результата с использованием статуса
-void TestFilterByStatus();
-
-// Функция TestSearchServer является точкой входа для запуска тестов
+#pragma once
+#include <vector>
+
+
+// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
+void TestExcludeStopWordsFromAddedDocumentContent();
+
+// Тест проверяет, что поисковая система исключает минус-слова из поискового запроса
+void TestExcludeMinusWordsFromQuery();
+
+// Тест на проверку сопоставления содержимого документа и поискового запроса
+
+void TestMatchDocuments();
+
+
+// Тест на сортировку по релевантности найденых документов
+void TestSortingByRelevance();
+// Тест на правильность вычесления релевантности
+void TestCalculatingRelevance();
+
+/// <summary>
+/// вычисление среднего ариметического оценок докумета
+/// </summary>
+/// <param name="rating"> вектор оценок</param>
+/// <returns>среднего ариметического оценок докумета</returns>
+int ArithmeticMeanOfTheRating(std::vector<int> rating);
+
+// Тест на правильность вычесления рейтинга 
+void TestCalculatingRating();
+
+// Тест на фильтрацию результата с использованием предиката
+void TestFilterByPredicate();
+
+// Тест на фильтрацию результата с использованием статуса
+void TestFilterByStatus();
+
+// Тест асинхронного поиска на пуле потоков сервера
+void TestFindTopDocumentsAsync();
+
+// Тест на прерывание поиска по исчерпанию бюджета запроса
+void TestQueryBudget();
+
+// Тест на ограничение числа одновременных запросов
+void TestConcurrencyLimit();
+
+// Тест гистограммы задержек и сбора метрик
+void TestMetrics();
+
+// Тест статистики выполнения запроса
+void TestQueryStats();
+
+// Тест пакетного сопоставления запроса со многими документами
+void TestMatchDocumentsBatch();
+
+// Тест постраничной выдачи через курсор
+void TestSearchCursor();
+// Тест размещения индекса в заданном ресурсе памяти
+void TestMemoryResource();
+
+// Тест учёта памяти индекса и предела памяти
+void TestMemoryUsage();
+
+// Тест снимка индекса и журнала изменений
+void TestPersistence();
+
+// Тест совершенного хеша стоп-слов
+void TestStopWordSet();
+
+// Тест нормализующего токенизатора
+void TestTokenizer();
+
+// Тест шаблонов слов запроса
+void TestWildcardQuery();
+
+// Тест фраз и близости слов по позиционному индексу
+void TestPhraseQuery();
+
+// Тест политик ранжирования
+void TestScoringPolicies();
+
+// Тест поиска по спискам вкладов и качества квантования
+void TestImpactIndex();
+
+// Тест потокобезопасной хеш-таблицы
+void TestConcurrentMap();
+
+// Тест поиска дубликатов при добавлении документа
+void TestDuplicatePolicies();
+
+// Тест поиска близких дубликатов MinHash
+void TestNearDuplicates();
+
+// Тест демона запросов и клиента
+void TestQueryDaemon();
+
+// Тест загрузки корпуса из файла
+void TestCorpusLoader();
+
+// Тест топологии NUMA и копий индекса по узлам
+void TestNumaSearchServer();
+
+// Тест последовательного поиска по окнам документов
+void TestWindowScoring();
+
+// Тест кеша срезов частых слов
+void TestHotTermCache();
+
+// Функция TestSearchServer является точкой входа для запуска тестов
 void TestSearchServer();
\ No newline at end of file
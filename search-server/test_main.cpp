@@ -0,0 +1,9 @@
+#include <iostream>
+
+#include "test_example_functions.h"
+
+int main() {
+    TestSearchServer();
+    std::cout << "Search server testing finished" << std::endl;
+    return 0;
+}
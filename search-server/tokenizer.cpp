@@ -0,0 +1,100 @@
+#include "tokenizer.h"
+
+#include <stdexcept>
+
+using namespace std::string_literals;
+
+namespace {
+
+bool IsAscii(std::string_view chars) {
+    for (const char c : chars) {
+        if (static_cast<uint8_t>(c) >= 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+Tokenizer::Tokenizer(const TokenizerOptions& options)
+    : fold_case_(options.fold_case)
+    , strip_punctuation_(options.strip_punctuation)
+{
+    if (!IsAscii(options.delimiters) || !IsAscii(options.punctuation)) {
+        throw std::invalid_argument("Delimiters and punctuation must be ASCII characters"s);
+    }
+    for (int c = 0; c < ' '; ++c) {
+        classes_[c] = CONTROL;
+    }
+    if (fold_case_) {
+        for (int c = 'A'; c <= 'Z'; ++c) {
+            classes_[c] = UPPER_ASCII;
+        }
+        classes_[0xC3] = UTF8_LEAD;
+        classes_[0xD0] = UTF8_LEAD;
+    }
+    if (strip_punctuation_) {
+        for (const char c : options.punctuation) {
+            classes_[static_cast<uint8_t>(c)] = PUNCTUATION;
+        }
+        classes_[0xC2] = UTF8_LEAD;
+        classes_[0xE2] = UTF8_LEAD;
+    }
+    for (const char c : options.delimiters) {
+        classes_[static_cast<uint8_t>(c)] = DELIMITER;
+    }
+}
+
+bool Tokenizer::IsIdentity() const {
+    return !fold_case_ && !strip_punctuation_;
+}
+
+int Tokenizer::NormalizeUtf8(std::string_view text, char* out, size_t& consumed) const {
+    consumed = 1;
+    if (text.size() < 2) {
+        return -1;
+    }
+    const auto lead = static_cast<uint8_t>(text[0]);
+    const auto next = static_cast<uint8_t>(text[1]);
+    switch (lead) {
+    case 0xC3:
+        // À-Þ, кроме ×
+        if (next >= 0x80 && next <= 0x9E && next != 0x97) {
+            out[0] = text[0];
+            out[1] = static_cast<char>(next + 0x20);
+            consumed = 2;
+            return 2;
+        }
+        return -1;
+    case 0xD0:
+        // Ѐ-Џ -> ѐ-џ, А-П -> а-п, Р-Я -> р-я
+        if (next >= 0x80 && next <= 0xAF) {
+            out[0] = static_cast<char>(next < 0x90 || next >= 0xA0 ? 0xD1 : 0xD0);
+            out[1] = static_cast<char>(next < 0x90 ? next + 0x10 : next < 0xA0 ? next + 0x20 : next - 0x20);
+            consumed = 2;
+            return 2;
+        }
+        return -1;
+    case 0xC2:
+        // ¡ « · » ¿
+        if (next == 0xA1 || next == 0xAB || next == 0xB7 || next == 0xBB || next == 0xBF) {
+            consumed = 2;
+            return 0;
+        }
+        return -1;
+    case 0xE2:
+        // – — ‘ ’ “ ” …
+        if (text.size() >= 3 && next == 0x80) {
+            const auto last = static_cast<uint8_t>(text[2]);
+            if (last == 0x93 || last == 0x94 || last == 0x98 || last == 0x99
+                || last == 0x9C || last == 0x9D || last == 0xA6) {
+                consumed = 3;
+                return 0;
+            }
+        }
+        return -1;
+    default:
+        return -1;
+    }
+}
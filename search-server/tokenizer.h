@@ -0,0 +1,151 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+struct TokenizerOptions {
+    // Разделители слов, только ASCII
+    std::string delimiters = " ";
+    // Приведение к нижнему регистру: ASCII, Latin-1 (À-Þ) и кириллица (А-Я, Ѐ-Џ) в UTF-8
+    bool fold_case = false;
+    // Удаление пунктуации внутри слов: символы punctuation, а также «» ¡¿ · – — ‘’ “” … в UTF-8.
+    // Слово из одной пунктуации пропускается. Минус-слово запроса определяется до нормализации
+    bool strip_punctuation = false;
+    std::string punctuation = "!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+};
+
+struct Token {
+    // Слово как в тексте и после нормализации
+    std::string_view raw;
+    std::string_view normalized;
+    // false, если в слове есть управляющие символы
+    bool is_valid = true;
+};
+
+// Разбиение на слова и нормализация за один проход по тексту. Классы ASCII-байтов берутся из таблицы;
+// байт без особого класса просто копируется. Слово, которое нормализация не меняет, возвращается
+// как ссылка на исходный текст, изменённое - пишется в буфер вызывающего. Нормализация не удлиняет
+// слова, поэтому буфера длиной text.size() всегда хватает. Сам токенизатор память не выделяет
+class Tokenizer {
+public:
+    explicit Tokenizer(const TokenizerOptions& options = TokenizerOptions{});
+
+    // Нормализация ничего не меняет: буфер не нужен, можно передать nullptr
+    bool IsIdentity() const;
+
+    bool IsDelimiter(char c) const {
+        return classes_[static_cast<uint8_t>(c)] & DELIMITER;
+    }
+
+    // callback(const Token&) для каждого слова. Возвращает конец занятой части буфера
+    template <typename Callback>
+    char* ForEachToken(std::string_view text, char* buffer, Callback&& callback) const;
+
+private:
+    enum ByteClass : uint8_t {
+        DELIMITER = 1,
+        CONTROL = 2,
+        UPPER_ASCII = 4,
+        PUNCTUATION = 8,
+        // Ведущий байт двухбайтовой (C2, C3, D0) или трёхбайтовой (E2) последовательности UTF-8,
+        // которую нужно разобрать
+        UTF8_LEAD = 16,
+    };
+
+    // Число байт последовательности UTF-8 с ведущим байтом text[0], записанных в out (0 - слово
+    // лишается символа), и число прочитанных байт; -1, если символ не меняется
+    int NormalizeUtf8(std::string_view text, char* out, size_t& consumed) const;
+
+    std::array<uint8_t, 256> classes_{};
+    bool fold_case_;
+    bool strip_punctuation_;
+};
+
+template <typename Callback>
+char* Tokenizer::ForEachToken(std::string_view text, char* buffer, Callback&& callback) const {
+    const size_t size = text.size();
+    const char* const data = text.data();
+    const uint8_t* const classes = classes_.data();
+    size_t pos = 0;
+    while (pos < size) {
+        while (pos < size && (classes[static_cast<uint8_t>(data[pos])] & DELIMITER)) {
+            ++pos;
+        }
+        if (pos == size) {
+            break;
+        }
+        const size_t start = pos;
+        // nullptr, пока слово совпадает с исходным текстом
+        char* out = nullptr;
+        size_t out_size = 0;
+        bool is_valid = true;
+        const auto start_copy = [&]() {
+            if (!out) {
+                out = buffer;
+                out_size = pos - start;
+                std::memcpy(out, data + start, out_size);
+            }
+        };
+        while (pos < size) {
+            // Отрезок обычных байтов копируется целиком
+            const size_t run_start = pos;
+            while (pos < size && classes[static_cast<uint8_t>(data[pos])] == 0) {
+                ++pos;
+            }
+            if (out) {
+                std::memcpy(out + out_size, data + run_start, pos - run_start);
+                out_size += pos - run_start;
+            }
+            if (pos == size) {
+                break;
+            }
+            const char c = data[pos];
+            const uint8_t byte_class = classes[static_cast<uint8_t>(c)];
+            if (byte_class & DELIMITER) {
+                break;
+            }
+            if (byte_class & UPPER_ASCII) {
+                start_copy();
+                out[out_size++] = static_cast<char>(c + ('a' - 'A'));
+                ++pos;
+            }
+            else if (byte_class & PUNCTUATION) {
+                start_copy();
+                ++pos;
+            }
+            else if (byte_class & UTF8_LEAD) {
+                char normalized[3];
+                size_t consumed = 1;
+                const int written = NormalizeUtf8(text.substr(pos), normalized, consumed);
+                if (written >= 0) {
+                    start_copy();
+                    std::memcpy(out + out_size, normalized, written);
+                    out_size += written;
+                }
+                else if (out) {
+                    std::memcpy(out + out_size, data + pos, consumed);
+                    out_size += consumed;
+                }
+                pos += consumed;
+            }
+            else {
+                is_valid = is_valid && !(byte_class & CONTROL);
+                if (out) {
+                    out[out_size++] = c;
+                }
+                ++pos;
+            }
+        }
+        const std::string_view raw = text.substr(start, pos - start);
+        if (!out) {
+            callback(Token{ raw, raw, is_valid });
+        }
+        else if (out_size > 0) {
+            buffer += out_size;
+            callback(Token{ raw, std::string_view(out, out_size), is_valid });
+        }
+    }
+    return buffer;
+}
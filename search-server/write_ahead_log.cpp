@@ -0,0 +1,201 @@
+#include "write_ahead_log.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "binary_io.h"
+
+namespace {
+
+// Длина тела и его CRC-32
+const size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+std::runtime_error MakeSystemError(const std::string& action, const std::string& path) {
+    return std::runtime_error(action + std::string(" ") + path + std::string(": ") + std::strerror(errno));
+}
+
+LogRecord ParseRecord(std::string_view body) {
+    BinaryReader reader(body);
+    LogRecord record;
+    record.sequence = reader.ReadUint64();
+    record.type = static_cast<LogRecordType>(reader.ReadUint8());
+    record.document_id = reader.ReadInt32();
+    if (record.type == LogRecordType::ADD_DOCUMENT) {
+        record.status = static_cast<DocumentStatus>(reader.ReadUint8());
+        record.ratings.resize(reader.ReadUint32());
+        for (int& rating : record.ratings) {
+            rating = reader.ReadInt32();
+        }
+        record.text = std::string(reader.ReadString());
+    }
+    else if (record.type != LogRecordType::REMOVE_DOCUMENT) {
+        throw std::runtime_error(std::string("Unknown log record type"));
+    }
+    if (!reader.IsEnd()) {
+        throw std::runtime_error(std::string("Unexpected data at the end of log record"));
+    }
+    return record;
+}
+
+}  // namespace
+
+WriteAheadLog::WriteAheadLog(std::string path, uint64_t next_sequence, const WriteAheadLogOptions& options)
+    : path_(std::move(path))
+    , options_(options)
+    , next_sequence_(next_sequence)
+    , last_sync_(std::chrono::steady_clock::now())
+{
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw MakeSystemError(std::string("Cannot open log"), path_);
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    try {
+        Sync();
+    }
+    catch (const std::exception&) {
+        // Деструктор не может сообщить об ошибке; вызовите Sync(), чтобы узнать о ней
+    }
+    ::close(fd_);
+}
+
+uint64_t WriteAheadLog::AppendAddDocument(int document_id, std::string_view document, DocumentStatus status,
+    const std::vector<int>& ratings) {
+    std::string body;
+    BinaryWriter writer(body);
+    writer.WriteUint64(next_sequence_);
+    writer.WriteUint8(static_cast<uint8_t>(LogRecordType::ADD_DOCUMENT));
+    writer.WriteInt32(document_id);
+    writer.WriteUint8(static_cast<uint8_t>(status));
+    writer.WriteUint32(static_cast<uint32_t>(ratings.size()));
+    for (const int rating : ratings) {
+        writer.WriteInt32(rating);
+    }
+    writer.WriteString(document);
+    return AppendRecord(body);
+}
+
+uint64_t WriteAheadLog::AppendRemoveDocument(int document_id) {
+    std::string body;
+    BinaryWriter writer(body);
+    writer.WriteUint64(next_sequence_);
+    writer.WriteUint8(static_cast<uint8_t>(LogRecordType::REMOVE_DOCUMENT));
+    writer.WriteInt32(document_id);
+    return AppendRecord(body);
+}
+
+uint64_t WriteAheadLog::AppendRecord(const std::string& body) {
+    BinaryWriter writer(pending_);
+    writer.WriteUint32(static_cast<uint32_t>(body.size()));
+    writer.WriteUint32(ComputeCrc32(body));
+    pending_ += body;
+    ++pending_records_;
+    const uint64_t sequence = next_sequence_++;
+    if (pending_records_ >= options_.group_commit_records
+        || std::chrono::steady_clock::now() - last_sync_ >= options_.group_commit_interval) {
+        Sync();
+    }
+    return sequence;
+}
+
+void WriteAheadLog::Sync() {
+    if (pending_.empty()) {
+        return;
+    }
+    size_t written = 0;
+    while (written < pending_.size()) {
+        const ssize_t result = ::write(fd_, pending_.data() + written, pending_.size() - written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Записанное начало буфера уже в файле: следующий Sync продолжит с места ошибки
+            const auto error = MakeSystemError(std::string("Cannot write log"), path_);
+            pending_.erase(0, written);
+            throw error;
+        }
+        written += static_cast<size_t>(result);
+    }
+    // Буфер целиком в файле; повторная запись после ошибки fdatasync задвоила бы записи журнала
+    pending_.clear();
+    pending_records_ = 0;
+    if (options_.sync_to_disk && ::fdatasync(fd_) != 0) {
+        throw MakeSystemError(std::string("Cannot sync log"), path_);
+    }
+    ++sync_count_;
+    last_sync_ = std::chrono::steady_clock::now();
+}
+
+void WriteAheadLog::Reset() {
+    pending_.clear();
+    pending_records_ = 0;
+    if (::ftruncate(fd_, 0) != 0 || (options_.sync_to_disk && ::fdatasync(fd_) != 0)) {
+        throw MakeSystemError(std::string("Cannot truncate log"), path_);
+    }
+}
+
+uint64_t WriteAheadLog::GetLastSequence() const {
+    return next_sequence_ - 1;
+}
+
+size_t WriteAheadLog::GetPendingRecords() const {
+    return pending_records_;
+}
+
+size_t WriteAheadLog::GetSyncCount() const {
+    return sync_count_;
+}
+
+LogReadResult ReadLog(const std::string& path, const std::function<void(const LogRecord&)>& on_record) {
+    LogReadResult result;
+    std::ifstream input(path, std::ios::binary);
+    if (!input) {
+        return result;
+    }
+    const std::string data(std::istreambuf_iterator<char>(input), {});
+    BinaryReader reader(data);
+    while (data.size() - reader.GetPosition() >= RECORD_HEADER_SIZE) {
+        const uint32_t size = reader.ReadUint32();
+        const uint32_t crc = reader.ReadUint32();
+        if (size > data.size() - reader.GetPosition()) {
+            break;
+        }
+        const std::string_view body = reader.ReadBytes(size);
+        if (ComputeCrc32(body) != crc) {
+            break;
+        }
+        LogRecord record;
+        try {
+            record = ParseRecord(body);
+        }
+        catch (const std::runtime_error&) {
+            break;
+        }
+        on_record(record);
+        ++result.records;
+        result.last_sequence = record.sequence;
+        result.valid_bytes = reader.GetPosition();
+    }
+    result.discarded_bytes = data.size() - result.valid_bytes;
+    return result;
+}
+
+void TruncateFile(const std::string& path, size_t length) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw MakeSystemError(std::string("Cannot open"), path);
+    }
+    const bool ok = ::ftruncate(fd, static_cast<off_t>(length)) == 0 && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok) {
+        throw MakeSystemError(std::string("Cannot truncate"), path);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "document.h"
+
+enum class LogRecordType : uint8_t {
+    ADD_DOCUMENT = 1,
+    REMOVE_DOCUMENT = 2,
+};
+
+struct LogRecord {
+    // Номера операций возрастают на единицу и не сбрасываются при контрольной точке
+    uint64_t sequence = 0;
+    LogRecordType type = LogRecordType::ADD_DOCUMENT;
+    int document_id = 0;
+    // Только для ADD_DOCUMENT
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::string text;
+};
+
+struct WriteAheadLogOptions {
+    // Групповая фиксация: записи копятся в буфере и сбрасываются на диск одним write + fdatasync,
+    // когда их набирается group_commit_records или с прошлой фиксации прошло group_commit_interval.
+    // Незафиксированные записи теряются при падении процесса; Sync() фиксирует их немедленно
+    size_t group_commit_records = 64;
+    std::chrono::milliseconds group_commit_interval{ 10 };
+    // false - только write без fdatasync: данные переживут падение процесса, но не отключение питания
+    bool sync_to_disk = true;
+};
+
+struct LogReadResult {
+    size_t records = 0;
+    uint64_t last_sequence = 0;
+    // Длина целой части журнала; всё дальше - оборванная или повреждённая запись
+    size_t valid_bytes = 0;
+    size_t discarded_bytes = 0;
+};
+
+// Журнал изменений индекса: каждая запись - длина, CRC-32 и тело операции.
+// Пишет один поток; журнал не синхронизирован для одновременной записи
+class WriteAheadLog {
+public:
+    // Открывает файл на дозапись, создавая его при необходимости. Бросает std::runtime_error
+    WriteAheadLog(std::string path, uint64_t next_sequence,
+        const WriteAheadLogOptions& options = WriteAheadLogOptions{});
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Возвращают номер записанной операции. Если бросает групповая фиксация, запись уже принята
+    // (GetLastSequence() её учитывает) и остаётся в буфере до следующего успешного Sync
+    uint64_t AppendAddDocument(int document_id, std::string_view document, DocumentStatus status,
+        const std::vector<int>& ratings);
+    uint64_t AppendRemoveDocument(int document_id);
+
+    void Sync();
+
+    // Очищает журнал после того, как его записи вошли в снимок
+    void Reset();
+
+    uint64_t GetLastSequence() const;
+    size_t GetPendingRecords() const;
+    size_t GetSyncCount() const;
+
+private:
+    uint64_t AppendRecord(const std::string& body);
+
+    std::string path_;
+    int fd_ = -1;
+    WriteAheadLogOptions options_;
+    uint64_t next_sequence_;
+    std::string pending_;
+    size_t pending_records_ = 0;
+    size_t sync_count_ = 0;
+    std::chrono::steady_clock::time_point last_sync_;
+};
+
+// Читает записи журнала по порядку и останавливается на первой оборванной или повреждённой
+LogReadResult ReadLog(const std::string& path, const std::function<void(const LogRecord&)>& on_record);
+
+// Обрезает файл до length байт и сбрасывает на диск
+void TruncateFile(const std::string& path, size_t length);